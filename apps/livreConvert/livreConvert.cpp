@@ -0,0 +1,145 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/data/DataSource.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <iostream>
+#include <stdlib.h>
+
+namespace po = boost::program_options;
+
+namespace
+{
+livre::Vector2ui parseFrames(const std::string& frames)
+{
+    const size_t comma = frames.find(',');
+    if (comma == std::string::npos)
+        throw po::error("frames have to be given as <start>,<end>");
+    return livre::Vector2ui(std::stoul(frames.substr(0, comma)),
+                            std::stoul(frames.substr(comma + 1)));
+}
+
+// Written as an absolute URI, a relative path would be parsed as the host
+std::string getOutputURI(const std::string& filename, const bool compress)
+{
+    return "lvb://" + boost::filesystem::absolute(filename).string() +
+           (compress ? "?compress=1" : "");
+}
+}
+
+int main(const int argc, char** argv)
+{
+    po::options_description options(
+        "livreConvert: converts a volume to the Livre bricked volume format");
+    options.add_options()("help,h", "Show this help")(
+        "input,i", po::value<std::string>(), "URI of the input volume")(
+        "output,o", po::value<std::string>(), "Output file (*.lvb)")(
+        "compress,c", "Compress the bricks")(
+        "frames,f", po::value<std::string>(),
+        "Frames <start>,<end> to convert, all frames of the input by default");
+    po::positional_options_description positionals;
+    positionals.add("input", 1).add("output", 1);
+
+    po::variables_map variables;
+    try
+    {
+        po::store(po::command_line_parser(argc, argv)
+                      .options(options)
+                      .positional(positionals)
+                      .run(),
+                  variables);
+        po::notify(variables);
+    }
+    catch (const po::error& error)
+    {
+        std::cerr << error.what() << std::endl << options << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    livre::DataSource::loadPlugins();
+    if (variables.count("help") || !variables.count("input") ||
+        !variables.count("output"))
+    {
+        std::cout << options << std::endl
+                  << "Input volumes:" << std::endl
+                  << livre::DataSource::getDescriptions() << std::endl;
+        return variables.count("help") ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    try
+    {
+        const livre::DataSource input(
+            servus::URI(variables["input"].as<std::string>()));
+        livre::VolumeInformation info = input.getVolumeInfo();
+
+        livre::Vector2ui& frames = info.frameRange;
+        if (variables.count("frames"))
+            frames = parseFrames(variables["frames"].as<std::string>());
+        else if (frames[1] <= frames[0])
+            frames = livre::Vector2ui(0, 1);
+        else if (frames[1] == livre::INVALID_TIMESTEP)
+        {
+            std::cout << "Converting only the first frame of an unbounded "
+                         "volume, see --frames"
+                      << std::endl;
+            frames[1] = frames[0] + 1;
+        }
+
+        livre::DataSource output(
+            servus::URI(getOutputURI(variables["output"].as<std::string>(),
+                                     variables.count("compress") > 0)),
+            livre::MODE_WRITE);
+        output.setVolumeInfo(info);
+
+        for (uint32_t frame = frames[0]; frame < frames[1]; ++frame)
+        {
+            for (uint32_t level = 0; level < info.rootNode.getDepth(); ++level)
+            {
+                const livre::Vector3ui blocks =
+                    info.rootNode.getBlockSize(level);
+                size_t nBricks = 0;
+                for (uint32_t z = 0; z < blocks.z(); ++z)
+                    for (uint32_t y = 0; y < blocks.y(); ++y)
+                        for (uint32_t x = 0; x < blocks.x(); ++x)
+                        {
+                            const livre::NodeId nodeId(
+                                level, livre::Vector3ui(x, y, z), frame);
+                            const livre::ConstMemoryUnitPtr data =
+                                input.getData(nodeId);
+                            if (!data)
+                                continue;
+                            output.setData(nodeId, *data);
+                            ++nBricks;
+                        }
+                std::cout << "Frame " << frame << " level " << level << ": "
+                          << nBricks << " bricks" << std::endl;
+            }
+        }
+        output.finish();
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "Conversion failed: " << error.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,255 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/core/cache/ARCCachePolicy.h>
+#include <livre/core/cache/CacheObject.h>
+
+namespace livre
+{
+namespace
+{
+enum Queue
+{
+    RECENT = 0,        // T1: resident, seen once
+    FREQUENT = 1,      // T2: resident, seen at least twice
+    RECENT_GHOST = 2,  // B1: evicted from T1
+    FREQUENT_GHOST = 3 // B2: evicted from T2
+};
+const size_t nQueues = 4;
+
+// max(1, a / b), the adaptation step of the paper
+size_t ratio(const size_t a, const size_t b)
+{
+    return std::max(size_t(1), a / std::max(size_t(1), b));
+}
+}
+
+struct ARCCachePolicy::Impl
+{
+    typedef std::list<CacheId> CacheIdList;
+
+    struct Entry
+    {
+        Queue queue;
+        CacheIdList::iterator position;
+        size_t size;
+    };
+
+    typedef std::unordered_map<CacheId, Entry> Index;
+
+    explicit Impl(const size_t maxMemBytes)
+        : _maxMemBytes(maxMemBytes)
+        , _target(0)
+        , _evictRecentFirst(true)
+    {
+        std::fill(_bytes, _bytes + nQueues, 0);
+    }
+
+    void insert(const CacheId& cacheId, const size_t size)
+    {
+        Index::iterator it = _index.find(cacheId);
+        if (it == _index.end())
+        {
+            _queues[RECENT].push_back(cacheId);
+            const Entry entry = {RECENT, --_queues[RECENT].end(), size};
+            _index.emplace(cacheId, entry);
+            _bytes[RECENT] += size;
+            return;
+        }
+
+        Entry& entry = it->second;
+        // A ghost hit means the corresponding list was too small: grow its
+        // share of the budget proportionally to the size of the other ghost
+        // list.
+        if (entry.queue == RECENT_GHOST)
+        {
+            const size_t delta =
+                size * ratio(_bytes[FREQUENT_GHOST], _bytes[RECENT_GHOST]);
+            _target = std::min(_maxMemBytes, _target + delta);
+        }
+        else if (entry.queue == FREQUENT_GHOST)
+        {
+            const size_t delta =
+                size * ratio(_bytes[RECENT_GHOST], _bytes[FREQUENT_GHOST]);
+            _target -= std::min(_target, delta);
+        }
+
+        move(entry, FREQUENT);
+        _bytes[FREQUENT] += size - entry.size;
+        entry.size = size;
+    }
+
+    void touch(const CacheId& cacheId)
+    {
+        Index::iterator it = _index.find(cacheId);
+        if (it == _index.end() || isGhost(it->second.queue))
+            return;
+        move(it->second, FREQUENT);
+    }
+
+    void remove(const CacheId& cacheId)
+    {
+        Index::iterator it = _index.find(cacheId);
+        if (it == _index.end() || isGhost(it->second.queue))
+            return;
+
+        Entry& entry = it->second;
+        move(entry, entry.queue == RECENT ? RECENT_GHOST : FREQUENT_GHOST);
+        trimGhosts();
+    }
+
+    void clear()
+    {
+        for (CacheIdList& queue : _queues)
+            queue.clear();
+        std::fill(_bytes, _bytes + nQueues, 0);
+        _index.clear();
+        _target = 0;
+    }
+
+    CacheId getFirst() const
+    {
+        const CacheIdList& recent = _queues[RECENT];
+        const CacheIdList& frequent = _queues[FREQUENT];
+        _evictRecentFirst = !recent.empty() &&
+                            (_bytes[RECENT] > _target || frequent.empty());
+
+        if (_evictRecentFirst)
+            return recent.front();
+        return frequent.empty() ? INVALID_CACHE_ID : frequent.front();
+    }
+
+    CacheId getNext(const CacheId& cacheId) const
+    {
+        Index::const_iterator it = _index.find(cacheId);
+        if (it == _index.end() || isGhost(it->second.queue))
+            return INVALID_CACHE_ID;
+
+        const Entry& entry = it->second;
+        CacheIdList::const_iterator next = entry.position;
+        if (++next != _queues[entry.queue].end())
+            return *next;
+
+        // Continue with the other resident list once the preferred one is
+        // exhausted
+        const Queue first = _evictRecentFirst ? RECENT : FREQUENT;
+        const Queue second = _evictRecentFirst ? FREQUENT : RECENT;
+        if (entry.queue != first || _queues[second].empty())
+            return INVALID_CACHE_ID;
+        return _queues[second].front();
+    }
+
+    static bool isGhost(const Queue queue)
+    {
+        return queue == RECENT_GHOST || queue == FREQUENT_GHOST;
+    }
+
+    void move(Entry& entry, const Queue queue)
+    {
+        CacheIdList& to = _queues[queue];
+        to.splice(to.end(), _queues[entry.queue], entry.position);
+        _bytes[entry.queue] -= entry.size;
+        _bytes[queue] += entry.size;
+        entry.queue = queue;
+    }
+
+    void dropFront(const Queue queue)
+    {
+        const CacheId cacheId = _queues[queue].front();
+        Index::iterator it = _index.find(cacheId);
+        _bytes[queue] -= it->second.size;
+        _queues[queue].pop_front();
+        _index.erase(it);
+    }
+
+    // Bounds the history to the budget for T1+B1 and to twice the budget
+    // overall, as in the original algorithm.
+    void trimGhosts()
+    {
+        while (!_queues[RECENT_GHOST].empty() &&
+               _bytes[RECENT] + _bytes[RECENT_GHOST] > _maxMemBytes)
+        {
+            dropFront(RECENT_GHOST);
+        }
+
+        const size_t total = _bytes[RECENT] + _bytes[FREQUENT] +
+                             _bytes[RECENT_GHOST] + _bytes[FREQUENT_GHOST];
+        size_t excess = total > 2 * _maxMemBytes ? total - 2 * _maxMemBytes : 0;
+        while (excess > 0 && !_queues[FREQUENT_GHOST].empty())
+        {
+            const size_t before = _bytes[FREQUENT_GHOST];
+            dropFront(FREQUENT_GHOST);
+            excess -= std::min(excess, before - _bytes[FREQUENT_GHOST]);
+        }
+    }
+
+    size_t _maxMemBytes;
+    size_t _target; // bytes targeted for the recent list, 'p' in the paper
+    mutable bool _evictRecentFirst;
+    CacheIdList _queues[nQueues];
+    size_t _bytes[nQueues];
+    Index _index;
+};
+
+ARCCachePolicy::ARCCachePolicy(const size_t maxMemBytes)
+    : _impl(new ARCCachePolicy::Impl(maxMemBytes))
+{
+}
+
+ARCCachePolicy::~ARCCachePolicy()
+{
+}
+
+void ARCCachePolicy::insert(const CacheObject& cacheObject, float)
+{
+    _impl->insert(cacheObject.getId(), cacheObject.getSize());
+}
+
+void ARCCachePolicy::touch(const CacheId& cacheId)
+{
+    _impl->touch(cacheId);
+}
+
+void ARCCachePolicy::remove(const CacheId& cacheId)
+{
+    _impl->remove(cacheId);
+}
+
+void ARCCachePolicy::clear()
+{
+    _impl->clear();
+}
+
+CacheId ARCCachePolicy::getFirst() const
+{
+    return _impl->getFirst();
+}
+
+CacheId ARCCachePolicy::getNext(const CacheId& cacheId) const
+{
+    return _impl->getNext(cacheId);
+}
+
+void ARCCachePolicy::setMaximumMemory(const size_t maxMemBytes)
+{
+    _impl->_maxMemBytes = maxMemBytes;
+    _impl->_target = std::min(_impl->_target, maxMemBytes);
+    _impl->trimGhosts();
+}
+}
@@ -0,0 +1,73 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _ARCCachePolicy_h_
+#define _ARCCachePolicy_h_
+
+#include <livre/core/api.h>
+#include <livre/core/cache/CachePolicy.h> // base class
+
+namespace livre
+{
+/**
+ * The ARCCachePolicy class implements the adaptive replacement cache policy
+ * (Megiddo and Modha, 2003) with byte instead of entry accounting.
+ *
+ * Objects seen once and objects seen repeatedly are kept in separate recency
+ * lists, and the ids of recently evicted objects are remembered in ghost
+ * lists. Hits on the ghost lists adapt the share of the memory budget given to
+ * each list, so that a scan over many new objects (e.g. a camera orbit or a
+ * time series playback) does not flush the frequently used ones.
+ */
+class ARCCachePolicy : public CachePolicy
+{
+public:
+    /** @param maxMemBytes the memory budget of the cache. */
+    LIVRECORE_API explicit ARCCachePolicy(size_t maxMemBytes);
+    LIVRECORE_API ~ARCCachePolicy();
+
+    /** @copydoc CachePolicy::insert */
+    LIVRECORE_API void insert(const CacheObject& cacheObject,
+                              float loadTime) final;
+
+    /** @copydoc CachePolicy::touch */
+    LIVRECORE_API void touch(const CacheId& cacheId) final;
+
+    /** @copydoc CachePolicy::remove */
+    LIVRECORE_API void remove(const CacheId& cacheId) final;
+
+    /** @copydoc CachePolicy::clear */
+    LIVRECORE_API void clear() final;
+
+    /** @copydoc CachePolicy::getFirst */
+    LIVRECORE_API CacheId getFirst() const final;
+
+    /** @copydoc CachePolicy::getNext */
+    LIVRECORE_API CacheId getNext(const CacheId& cacheId) const final;
+
+    /** @copydoc CachePolicy::setMaximumMemory */
+    LIVRECORE_API void setMaximumMemory(size_t maxMemBytes) final;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> _impl;
+};
+}
+
+#endif // _ARCCachePolicy_h_
@@ -19,9 +19,14 @@
 
 #include <livre/core/cache/Cache.h>
 #include <livre/core/cache/CacheObject.h>
+#include <livre/core/cache/CachePolicy.h>
 #include <livre/core/cache/CacheStatistics.h>
+#include <livre/core/cache/ShardedCacheMap.h>
 #include <livre/core/defines.h>
 
+#include <boost/thread/future.hpp>
+#include <lunchbox/clock.h>
+
 namespace livre
 {
 CacheLoadException::CacheLoadException(const Identifier& id,
@@ -38,179 +43,341 @@ const char* CacheLoadException::what() const throw()
     return message.str().c_str();
 }
 
-struct LRUCachePolicy
+struct Cache::Impl
 {
-    typedef std::deque<CacheId> LRUQueue;
-
-    LRUCachePolicy(const size_t maxMemBytes)
-        : _maxMemBytes(maxMemBytes)
+    Impl(const std::string& name, const size_t maxMemBytes,
+         const std::type_index& cacheObjectType, CachePolicyPtr policy)
+        : _policy(std::move(policy))
+        , _maxMemBytes(maxMemBytes)
         , _cleanUpRatio(1.0f)
+        , _statistics(name, maxMemBytes)
+        , _pinnedMemBytes(0)
+        , _cacheObjectType(cacheObjectType)
     {
     }
 
-    bool isFull(const Cache& cache) const
+    ~Impl() {}
+    bool isFull() const
     {
-        const size_t usedMemBytes = cache.getStatistics().getUsedMemory();
-        return usedMemBytes >= _maxMemBytes;
+        return _statistics.getUsedMemory() >= _maxMemBytes;
     }
 
-    bool hasSpace(const Cache& cache) const
+    bool hasSpace() const
     {
-        const size_t usedMemBytes = cache.getStatistics().getUsedMemory();
-        return usedMemBytes < _cleanUpRatio * _maxMemBytes;
+        return _statistics.getUsedMemory() < _cleanUpRatio * _maxMemBytes;
     }
 
-    void insert(const CacheId& cacheId)
+    // Reports the hits recorded by the lock-free lookups to the policy
+    void updatePolicy()
     {
-        remove(cacheId);
-        _lruQueue.push_back(cacheId);
+        _cacheMap.drainAccesses(
+            [this](const CacheId& cacheId) { _policy->touch(cacheId); });
     }
 
-    void remove(const CacheId& cacheId)
+    void applyPolicy()
     {
-        typename LRUQueue::iterator it = _lruQueue.begin();
-        while (it != _lruQueue.end())
+        if (_cacheMap.getSize() == 0 || !isFull())
+            return;
+
+        // Walk the candidates in eviction order, skipping the pinned and
+        // referenced objects which cannot be unloaded
+        CacheId cacheId = _policy->getFirst();
+        while (cacheId != INVALID_CACHE_ID)
         {
-            if (*it == cacheId)
+            const CacheId next = _policy->getNext(cacheId);
+            if (unloadFromCache(cacheId, true))
             {
-                _lruQueue.erase(it);
-                return;
+                _statistics.notifyEviction();
+                if (hasSpace())
+                    return;
             }
-            else
-                ++it;
+            cacheId = next;
         }
     }
 
-    CacheIds getObjects() const
+    struct Pin
     {
-        CacheIds ids;
-        ids.reserve(_lruQueue.size());
-        ids.insert(ids.begin(), _lruQueue.begin(), _lruQueue.end());
-        return ids;
+        Pin()
+            : count(0)
+            , rejected(false)
+        {
+        }
+
+        size_t count;
+        bool rejected; // the last load exceeded the memory for pinned objects
+    };
+    typedef std::unordered_map<CacheId, Pin> Pins;
+
+    typedef boost::shared_future<ConstCacheObjectPtr> PendingLoad;
+    typedef std::unordered_map<CacheId, PendingLoad> PendingLoads;
+
+    // Single flight: the first caller constructs the object, concurrent
+    // callers for the same id wait for its result instead of loading it again
+    ConstCacheObjectPtr load(const CacheId& cacheId,
+                             const std::function<ConstCacheObjectPtr()>& create)
+    {
+        boost::promise<ConstCacheObjectPtr> promise;
+        {
+            ScopedLock lock(_mutex);
+            const ConstCacheObjectPtr* obj = _cacheMap.lookup(cacheId);
+            if (obj)
+                return *obj;
+
+            // Do not construct objects which would be rejected anyway
+            Pins::iterator pin = _pins.find(cacheId);
+            if (pin != _pins.end() && _pinnedMemBytes >= _maxMemBytes)
+            {
+                rejectPin(pin->second);
+                return ConstCacheObjectPtr();
+            }
+
+            PendingLoads::const_iterator pending = _pendingLoads.find(cacheId);
+            if (pending != _pendingLoads.end())
+            {
+                const PendingLoad pendingLoad = pending->second;
+                _statistics.notifySavedLoad();
+                lock.unlock();
+                return pendingLoad.get();
+            }
+
+            _pendingLoads.emplace(cacheId, promise.get_future().share());
+        }
+
+        ConstCacheObjectPtr obj;
+        try
+        {
+            const lunchbox::Clock clock;
+            const ConstCacheObjectPtr created = create();
+            const float time = clock.getTimef();
+            obj = finishLoad(cacheId, created, time);
+        }
+        catch (const CacheLoadException&)
+        {
+            finishLoad(cacheId, ConstCacheObjectPtr(), 0.f);
+        }
+        catch (...)
+        {
+            // Waiters get an empty object, the loading thread gets the error
+            finishLoad(cacheId, ConstCacheObjectPtr(), 0.f);
+            promise.set_value(ConstCacheObjectPtr());
+            throw;
+        }
+
+        promise.set_value(obj);
+        return obj;
     }
 
-    void clear() { _lruQueue.clear(); }
-    const size_t _maxMemBytes;
-    const float _cleanUpRatio;
-    LRUQueue _lruQueue;
-};
+    // @return the object, or an empty pointer if it was rejected
+    ConstCacheObjectPtr finishLoad(const CacheId& cacheId,
+                                   const ConstCacheObjectPtr& obj,
+                                   const float loadTime)
+    {
+        ScopedLock lock(_mutex);
+        _pendingLoads.erase(cacheId);
+        if (!obj)
+            return obj;
 
-struct Cache::Impl
-{
-    Impl(Cache& cache, const std::string& name, const size_t maxMemBytes,
-         const std::type_index& cacheObjectType)
-        : _policy(maxMemBytes)
-        , _cache(cache)
-        , _statistics(name, maxMemBytes)
-        , _cacheMap(128)
-        , _cacheObjectType(cacheObjectType)
+        Pins::iterator pin = _pins.find(cacheId);
+        if (pin != _pins.end())
+        {
+            const size_t size = obj->getSize();
+            if (_pinnedMemBytes + size > _maxMemBytes)
+            {
+                rejectPin(pin->second);
+                return ConstCacheObjectPtr();
+            }
+            pin->second.rejected = false;
+            _pinnedMemBytes += size;
+        }
+
+        updatePolicy();
+        _cacheMap.insert(obj);
+        _statistics.notifyLoaded(*obj, loadTime);
+        _policy->insert(*obj, loadTime);
+        applyPolicy();
+        _cacheMap.reclaim();
+        return obj;
+    }
+
+    void rejectPin(Pin& pin)
     {
+        pin.rejected = true;
+        _statistics.notifyRejectedPin();
     }
 
-    ~Impl() {}
-    void applyPolicy()
+    void unpinMemory(const CacheId& cacheId, const CacheObject& obj)
     {
-        if (_cacheMap.empty() || !_policy.isFull(_cache))
-            return;
+        if (_pins.count(cacheId))
+            _pinnedMemBytes -= obj.getSize();
+    }
 
-        // Objects are returned in delete order
-        for (const CacheId& cacheId : _policy.getObjects())
+    void pin(const CacheIds& cacheIds)
+    {
+        ScopedLock lock(_mutex);
+        for (const CacheId& cacheId : cacheIds)
         {
-            unloadFromCache(cacheId);
-            if (_policy.hasSpace(_cache))
-                return;
+            Pin& pin = _pins[cacheId];
+            if (pin.count++ > 0)
+                continue;
+
+            const ConstCacheObjectPtr* obj = _cacheMap.lookup(cacheId);
+            if (obj)
+                _pinnedMemBytes += (*obj)->getSize();
         }
     }
 
-    ConstCacheObjectPtr load(ConstCacheObjectPtr obj)
+    void unpin(const CacheIds& cacheIds)
     {
-        WriteLock writeLock(_mutex);
-        const CacheId& cacheId = obj->getId();
-        ConstCacheMap::const_iterator it = _cacheMap.find(cacheId);
-        if (it != _cacheMap.end())
-            return it->second;
-
-        _cacheMap[cacheId] = obj;
-        _statistics.notifyMiss();
-        _statistics.notifyLoaded(*obj);
-        _policy.insert(cacheId);
+        ScopedLock lock(_mutex);
+        for (const CacheId& cacheId : cacheIds)
+        {
+            Pins::iterator pin = _pins.find(cacheId);
+            if (pin == _pins.end() || --pin->second.count > 0)
+                continue;
+
+            const ConstCacheObjectPtr* obj = _cacheMap.lookup(cacheId);
+            if (obj)
+                _pinnedMemBytes -= (*obj)->getSize();
+            _pins.erase(pin);
+        }
+
+        // The released objects may have kept the cache above its maximum
+        updatePolicy();
         applyPolicy();
-        return obj;
+        _cacheMap.reclaim();
+    }
+
+    CacheIds getRejected(const CacheIds& cacheIds) const
+    {
+        ScopedLock lock(_mutex);
+        CacheIds rejected;
+        for (const CacheId& cacheId : cacheIds)
+        {
+            Pins::const_iterator pin = _pins.find(cacheId);
+            if (pin != _pins.end() && pin->second.rejected)
+                rejected.push_back(cacheId);
+        }
+        return rejected;
     }
 
-    bool unloadFromCache(const CacheId& cacheId)
+    // A lookup running concurrently may still obtain the object while it is
+    // unloaded, the object then lives on outside of the memory accounting
+    // until the last reference is released.
+    bool unloadFromCache(const CacheId& cacheId, const bool evict)
     {
-        ConstCacheMap::iterator it = _cacheMap.find(cacheId);
-        if (it == _cacheMap.end())
+        const ConstCacheObjectPtr* obj = _cacheMap.lookup(cacheId);
+        if (!obj || _pins.count(cacheId))
             return false;
 
-        ConstCacheObjectPtr& obj = it->second;
-        if (obj.use_count() > 1)
+        if (obj->use_count() > 1)
+        {
+            _statistics.notifyRejectedEviction();
             return false;
+        }
 
-        _statistics.notifyUnloaded(*obj);
-        obj.reset();
-        _policy.remove(cacheId);
+        _statistics.notifyUnloaded(**obj);
+        if (evict)
+        {
+            (*obj)->evicted(_statistics);
+            _policy->evict(cacheId);
+        }
+        else
+            _policy->remove(cacheId);
         _cacheMap.erase(cacheId);
         return true;
     }
 
-    ConstCacheObjectPtr getFromMap(const CacheId& cacheId) const
+    bool unload(const CacheId& cacheId)
     {
-        ReadLock readLock(_mutex);
-        ConstCacheMap::const_iterator it = _cacheMap.find(cacheId);
-        if (it == _cacheMap.end())
-        {
-            _statistics.notifyMiss();
-            return CacheObjectPtr();
-        }
-
-        _statistics.notifyHit();
-        return it->second;
+        ScopedLock lock(_mutex);
+        updatePolicy();
+        const bool unloaded = unloadFromCache(cacheId, false);
+        _cacheMap.reclaim();
+        return unloaded;
     }
 
-    bool unload(const CacheId& cacheId)
+    ConstCacheObjectPtr get(const CacheId& cacheId) const
     {
-        WriteLock lock(_mutex);
-        return unloadFromCache(cacheId);
+        ConstCacheObjectPtr obj = _cacheMap.find(cacheId);
+        if (obj)
+            _statistics.notifyHit(*obj);
+        else
+            _statistics.notifyMiss();
+        return obj;
     }
 
-    ConstCacheObjectPtr get(const CacheId& cacheId) const
+    size_t getCount() const { return _cacheMap.getSize(); }
+    void setMaximumMemory(const size_t maxMemBytes)
     {
-        return getFromMap(cacheId);
+        ScopedLock lock(_mutex);
+        updatePolicy();
+        _maxMemBytes = maxMemBytes;
+        _statistics.setMaximumMemory(maxMemBytes);
+        _policy->setMaximumMemory(maxMemBytes);
+        applyPolicy();
+        _cacheMap.reclaim();
     }
 
-    size_t getCount() const
+    CacheIds getCacheIds()
     {
-        ReadLock lock(_mutex);
-        return _cacheMap.size();
+        ScopedLock lock(_mutex);
+        updatePolicy();
+        CacheIds cacheIds;
+        cacheIds.reserve(_cacheMap.getSize());
+        for (CacheId cacheId = _policy->getFirst(); cacheId != INVALID_CACHE_ID;
+             cacheId = _policy->getNext(cacheId))
+        {
+            cacheIds.push_back(cacheId);
+        }
+        std::reverse(cacheIds.begin(), cacheIds.end());
+        return cacheIds;
     }
 
     void purge()
     {
-        WriteLock lock(_mutex);
+        ScopedLock lock(_mutex);
+        updatePolicy();
         _statistics.clear();
-        _policy.clear();
+        _policy->clear();
         _cacheMap.clear();
+        _pinnedMemBytes = 0;
+        _cacheMap.reclaim();
     }
 
     void purge(const CacheId& cacheId)
     {
-        WriteLock lock(_mutex);
+        ScopedLock lock(_mutex);
+        updatePolicy();
+        const ConstCacheObjectPtr* obj = _cacheMap.lookup(cacheId);
+        if (!obj)
+            return;
+
+        unpinMemory(cacheId, **obj);
+        _statistics.notifyUnloaded(**obj);
+        _policy->remove(cacheId);
         _cacheMap.erase(cacheId);
+        _cacheMap.reclaim();
     }
 
-    mutable LRUCachePolicy _policy;
-    Cache& _cache;
+    // Lookups neither lock nor touch the policy, the hits are recorded by the
+    // map and reported to the policy by the next modification. Modifications
+    // are serialized, as the policies need a global view of the cache.
+    CachePolicyPtr _policy;
+    size_t _maxMemBytes;
+    const float _cleanUpRatio;
     mutable CacheStatistics _statistics;
-    ConstCacheMap _cacheMap;
-    mutable ReadWriteMutex _mutex;
+    ShardedCacheMap _cacheMap;
+    PendingLoads _pendingLoads;
+    Pins _pins;
+    size_t _pinnedMemBytes;
+    mutable boost::mutex _mutex;
     const std::type_index _cacheObjectType;
 };
 
-Cache::Cache(const std::string& name, size_t maxMemBytes,
-             const std::type_index& cacheObjectType)
-    : _impl(new Cache::Impl(*this, name, maxMemBytes, cacheObjectType))
+Cache::Cache(const std::string& name, const size_t maxMemBytes,
+             const std::type_index& cacheObjectType, CachePolicyPtr policy)
+    : _impl(new Cache::Impl(name, maxMemBytes, cacheObjectType,
+                            std::move(policy)))
 {
 }
 
@@ -218,12 +385,13 @@ Cache::~Cache()
 {
 }
 
-ConstCacheObjectPtr Cache::_load(ConstCacheObjectPtr obj)
+ConstCacheObjectPtr Cache::_load(
+    const CacheId& cacheId, const std::function<ConstCacheObjectPtr()>& create)
 {
-    if (obj->getId() == INVALID_CACHE_ID)
+    if (cacheId == INVALID_CACHE_ID)
         return ConstCacheObjectPtr();
 
-    return _impl->load(obj);
+    return _impl->load(cacheId, create);
 }
 
 bool Cache::unload(const CacheId& cacheId)
@@ -247,11 +415,36 @@ const std::type_index& Cache::_getCacheObjectType() const
     return _impl->_cacheObjectType;
 }
 
+void Cache::_pin(const CacheIds& cacheIds)
+{
+    _impl->pin(cacheIds);
+}
+
+void Cache::_unpin(const CacheIds& cacheIds)
+{
+    _impl->unpin(cacheIds);
+}
+
+CacheIds Cache::_getRejected(const CacheIds& cacheIds) const
+{
+    return _impl->getRejected(cacheIds);
+}
+
 size_t Cache::getCount() const
 {
     return _impl->getCount();
 }
 
+void Cache::setMaximumMemory(const size_t maxMemBytes)
+{
+    _impl->setMaximumMemory(maxMemBytes);
+}
+
+CacheIds Cache::getCacheIds() const
+{
+    return _impl->getCacheIds();
+}
+
 const CacheStatistics& Cache::getStatistics() const
 {
     return _impl->_statistics;
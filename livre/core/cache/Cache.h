@@ -21,6 +21,7 @@
 #define _Cache_h_
 
 #include <livre/core/api.h>
+#include <livre/core/cache/CachePolicy.h>
 #include <livre/core/types.h>
 
 namespace livre
@@ -41,10 +42,10 @@ private:
 };
 
 /**
- * The Cache class manages the \see CacheObjects according to LRU Policy,
- * methods
- * are thread safe inserting/querying nodes. The type safety check is done in
- * runtime.
+ * The Cache class manages the \see CacheObjects according to a \see
+ * CachePolicy, methods are thread safe inserting/querying nodes. The type
+ * safety check is done in runtime. Objects pinned by a \see CacheLease are
+ * not evicted.
  */
 class Cache
 {
@@ -52,7 +53,8 @@ public:
     LIVRECORE_API virtual ~Cache();
 
     /**
-     * Gets the cached object from the cache.
+     * Gets the cached object from the cache. A successful lookup is reported
+     * to the cache policy as an access to the object.
      * @param cacheId The object cache id to be queried.
      * @return The cache object from cache, if object is not in the list an
      * empty cache
@@ -84,8 +86,8 @@ public:
     }
 
     /**
-     * Unloads the object from the memory, if there are not any references. The
-     * objects are removed from cache
+     * Unloads the object from the memory, if there are not any references and
+     * it is not pinned. The objects are removed from cache
      * @param cacheId The object cache id to be unloaded.
      * @return false if object is not unloaded or cacheId is invalid
      */
@@ -96,15 +98,32 @@ public:
      */
     LIVRECORE_API size_t getCount() const;
 
+    /**
+     * Changes the memory budget of the cache. A smaller budget evicts objects
+     * until the cache fits, unless they are referenced or pinned.
+     * @param maxMemBytes the new maximum memory.
+     */
+    LIVRECORE_API void setMaximumMemory(size_t maxMemBytes);
+
+    /**
+     * @return The ids of the cached objects in the reverse eviction order of
+     * the cache policy, i.e. the most recently used first for the LRU policy.
+     */
+    LIVRECORE_API CacheIds getCacheIds() const;
+
     /**
      * Loads the object to cache. If object is not in the cache it is created.
+     * Concurrent loads of the same cache id construct the object only once,
+     * the other callers wait for and share its result.
      * @param cacheId the id of the cache object to be loaded
      * @param args parameters of the cache object constructor. If there is
      * already
      * a cache object with the same cache id, the args are not considered.
      * @return the loaded or previously loaded cache object. Return empty
      * pointer
-     * if cache id is invalid or object cannot be loaded.
+     * if cache id is invalid or object cannot be loaded. An empty pointer is
+     * also returned for a pinned object, if the pinned objects would exceed
+     * the maximum memory.
      */
     template <class CacheObjectT, class... Args>
     LIVRECORE_API std::shared_ptr<const CacheObjectT> load(
@@ -117,25 +136,20 @@ public:
         if (obj)
             return obj;
 
-        try
-        {
-            ConstCacheObjectPtr cacheObject =
-                _load(ConstCacheObjectPtr(new CacheObjectT(cacheId, args...)));
-
-            std::shared_ptr<const CacheObjectT> typedObj =
-                std::dynamic_pointer_cast<const CacheObjectT>(cacheObject);
+        const ConstCacheObjectPtr cacheObject = _load(cacheId, [&] {
+            return ConstCacheObjectPtr(new CacheObjectT(cacheId, args...));
+        });
+        if (!cacheObject)
+            return obj;
 
-            if (!typedObj)
-                LBTHROW(std::runtime_error(
-                    "The cache type casting failed for cached object"));
+        std::shared_ptr<const CacheObjectT> typedObj =
+            std::dynamic_pointer_cast<const CacheObjectT>(cacheObject);
 
-            return typedObj;
-        }
-        catch (const CacheLoadException&)
-        {
-        }
+        if (!typedObj)
+            LBTHROW(std::runtime_error(
+                "The cache type casting failed for cached object"));
 
-        return obj;
+        return typedObj;
     }
 
     /**
@@ -162,12 +176,21 @@ protected:
      * @param name is the name of the cache.
      * @param maxMemBytes maximum memory.
      * @param cacheObjectType type info for the cached object.
+     * @param policy the eviction policy.
      */
     LIVRECORE_API Cache(const std::string& name, size_t maxMemBytes,
-                        const std::type_index& cacheObjectType);
+                        const std::type_index& cacheObjectType,
+                        CachePolicyPtr policy);
 
 private:
-    ConstCacheObjectPtr _load(ConstCacheObjectPtr cacheObject);
+    friend class CacheLease;
+    void _pin(const CacheIds& cacheIds);
+    void _unpin(const CacheIds& cacheIds);
+    CacheIds _getRejected(const CacheIds& cacheIds) const;
+
+    ConstCacheObjectPtr _load(
+        const CacheId& cacheId,
+        const std::function<ConstCacheObjectPtr()>& create);
     const std::type_index& _getCacheObjectType() const;
 
     struct Impl;
@@ -179,12 +202,19 @@ template <class CacheObjectT>
 class CacheT : public Cache
 {
 public:
+    /**
+     * @param name is the name of the cache.
+     * @param maxMemBytes maximum memory.
+     * @param policyType the eviction policy.
+     */
     template <class Q = CacheObjectT>
     LIVRECORE_API CacheT(
         const std::string& name, size_t maxMemBytes,
+        CachePolicyType policyType = CP_LRU,
         typename std::enable_if<std::is_base_of<CacheObject, Q>::value,
                                 Q>::type* = 0)
-        : Cache(name, maxMemBytes, getType<CacheObjectT>())
+        : Cache(name, maxMemBytes, getType<CacheObjectT>(),
+                CachePolicy::create(policyType, maxMemBytes))
     {
     }
 };
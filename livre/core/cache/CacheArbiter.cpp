@@ -0,0 +1,232 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/core/cache/Cache.h>
+#include <livre/core/cache/CacheArbiter.h>
+#include <livre/core/cache/CacheStatistics.h>
+
+namespace livre
+{
+struct CacheArbiter::Impl
+{
+    struct Entry
+    {
+        Cache* cache;
+        size_t minMemBytes;
+        CacheStatisticsSnapshot previous;
+        float hitRatio;
+        float loadTime;
+        bool pressure;
+    };
+
+    explicit Impl(const float step)
+        : _step(step)
+        , _maxMemBytes(0)
+    {
+    }
+
+    size_t getStepBytes() const { return size_t(_step * _maxMemBytes); }
+    static size_t getMaxMem(const Entry& entry)
+    {
+        return entry.cache->getStatistics().getMaximumMemory();
+    }
+
+    void update(Entry& entry) const
+    {
+        const CacheStatisticsSnapshot current =
+            entry.cache->getStatistics().getSnapshot();
+
+        // A purge clears the statistics, the previous snapshot is void then
+        const CacheStatisticsSnapshot diff = current.time < entry.previous.time
+                                                 ? current
+                                                 : current - entry.previous;
+        entry.previous = current;
+        entry.hitRatio = diff.getHitRatio();
+        entry.loadTime = diff.getLoadTime();
+        entry.pressure = diff.evictions + diff.rejectedEvictions > 0 ||
+                         current.usedMemBytes + getStepBytes() >
+                             getMaxMem(entry);
+    }
+
+    Entry* findReceiver()
+    {
+        Entry* receiver = nullptr;
+        for (Entry& entry : _entries)
+        {
+            if (entry.pressure && entry.loadTime > 0.f &&
+                (!receiver || entry.loadTime > receiver->loadTime))
+            {
+                receiver = &entry;
+            }
+        }
+        return receiver;
+    }
+
+    // Unused memory is given away first, then the memory whose misses cost
+    // less than the ones of the receiver
+    Entry* findDonor(const Entry& receiver)
+    {
+        Entry* donor = nullptr;
+        size_t maxUnused = 0;
+        for (Entry& entry : _entries)
+        {
+            const size_t maxMem = getMaxMem(entry);
+            const size_t used = entry.previous.usedMemBytes;
+            if (&entry == &receiver || maxMem <= entry.minMemBytes ||
+                entry.pressure || used >= maxMem)
+            {
+                continue;
+            }
+            if (maxMem - used > maxUnused)
+            {
+                donor = &entry;
+                maxUnused = maxMem - used;
+            }
+        }
+        if (donor)
+            return donor;
+
+        for (Entry& entry : _entries)
+        {
+            if (&entry != &receiver && getMaxMem(entry) > entry.minMemBytes &&
+                entry.loadTime < receiver.loadTime &&
+                (!donor || entry.loadTime < donor->loadTime))
+            {
+                donor = &entry;
+            }
+        }
+        return donor;
+    }
+
+    bool rebalance()
+    {
+        for (Entry& entry : _entries)
+            update(entry);
+
+        Entry* receiver = findReceiver();
+        if (!receiver)
+            return false;
+
+        Entry* donor = findDonor(*receiver);
+        if (!donor)
+            return false;
+
+        const size_t donorMaxMem = getMaxMem(*donor);
+        const size_t bytes =
+            std::min(getStepBytes(), donorMaxMem - donor->minMemBytes);
+        if (bytes == 0)
+            return false;
+
+        // Shrink first, so the caches never exceed the total budget together
+        donor->cache->setMaximumMemory(donorMaxMem - bytes);
+        receiver->cache->setMaximumMemory(getMaxMem(*receiver) + bytes);
+
+        // The evictions of the shrinking are not pressure of the donor
+        donor->previous = donor->cache->getStatistics().getSnapshot();
+        return true;
+    }
+
+    void setMaximumMemory(const size_t maxMemBytes)
+    {
+        if (_entries.empty() || maxMemBytes == _maxMemBytes)
+            return;
+
+        // The last cache gets the rounding remainder
+        const double ratio = double(maxMemBytes) / _maxMemBytes;
+        std::vector<size_t> shares;
+        size_t total = 0;
+        for (Entry& entry : _entries)
+        {
+            entry.minMemBytes = size_t(entry.minMemBytes * ratio);
+            shares.push_back(size_t(getMaxMem(entry) * ratio));
+            total += shares.back();
+        }
+        shares.back() += maxMemBytes - total;
+        _maxMemBytes = maxMemBytes;
+
+        // Shrink first, so the caches never exceed the total budget together
+        for (size_t i = 0; i < _entries.size(); ++i)
+        {
+            if (shares[i] < getMaxMem(_entries[i]))
+                _entries[i].cache->setMaximumMemory(shares[i]);
+        }
+        for (size_t i = 0; i < _entries.size(); ++i)
+        {
+            if (shares[i] > getMaxMem(_entries[i]))
+                _entries[i].cache->setMaximumMemory(shares[i]);
+        }
+
+        // The evictions of the shrinking are not pressure of the caches
+        for (Entry& entry : _entries)
+            entry.previous = entry.cache->getStatistics().getSnapshot();
+    }
+
+    const float _step;
+    size_t _maxMemBytes;
+    std::vector<Entry> _entries;
+};
+
+CacheArbiter::CacheArbiter(const float step)
+    : _impl(new Impl(step))
+{
+}
+
+CacheArbiter::~CacheArbiter()
+{
+}
+
+void CacheArbiter::add(Cache& cache, const size_t minMemBytes)
+{
+    const CacheStatistics& statistics = cache.getStatistics();
+    const Impl::Entry entry = {&cache, minMemBytes, statistics.getSnapshot(),
+                               0.f, 0.f, false};
+    _impl->_entries.push_back(entry);
+    _impl->_maxMemBytes += statistics.getMaximumMemory();
+}
+
+size_t CacheArbiter::getMaximumMemory() const
+{
+    return _impl->_maxMemBytes;
+}
+
+void CacheArbiter::setMaximumMemory(const size_t maxMemBytes)
+{
+    _impl->setMaximumMemory(maxMemBytes);
+}
+
+bool CacheArbiter::rebalance()
+{
+    return _impl->rebalance();
+}
+
+CacheArbiter::Budgets CacheArbiter::getBudgets() const
+{
+    Budgets budgets;
+    for (const Impl::Entry& entry : _impl->_entries)
+    {
+        const CacheStatistics& statistics = entry.cache->getStatistics();
+        const Budget budget = {statistics.getName(),
+                               statistics.getMaximumMemory(),
+                               statistics.getUsedMemory(), entry.hitRatio,
+                               entry.loadTime};
+        budgets.push_back(budget);
+    }
+    return budgets;
+}
+}
@@ -0,0 +1,95 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _CacheArbiter_h_
+#define _CacheArbiter_h_
+
+#include <livre/core/api.h>
+#include <livre/core/types.h>
+
+namespace livre
+{
+/**
+ * The CacheArbiter class shares one memory budget between several \see Cache
+ * instances, instead of giving each of them a fixed budget.
+ *
+ * Each rebalance compares the caches by the time they spent loading objects
+ * since the previous rebalance. A step of the budget moves from the cache
+ * with the most unused memory, or else the one whose misses cost the least,
+ * to the cache under pressure whose misses cost the most. A cache is under
+ * pressure if it evicted objects or is close to its budget. The arbiter is
+ * not thread safe.
+ */
+class CacheArbiter
+{
+public:
+    /** The share of the budget of one cache */
+    struct Budget
+    {
+        std::string name;    //!< Name of the cache statistics
+        size_t maxMemBytes;  //!< Current budget of the cache
+        size_t usedMemBytes; //!< Memory used by the cache
+        float hitRatio;      //!< Hit ratio since the previous rebalance
+        float loadTime;      //!< ms spent loading since the previous rebalance
+    };
+    typedef std::vector<Budget> Budgets;
+
+    /**
+     * @param step the fraction of the total budget moved by one rebalance.
+     */
+    LIVRECORE_API explicit CacheArbiter(float step = 0.05f);
+    LIVRECORE_API ~CacheArbiter();
+
+    /**
+     * Adds a cache to the arbiter. Its maximum memory is added to the total
+     * budget and is its initial share.
+     * @param cache the cache, which has to outlive the arbiter.
+     * @param minMemBytes the share of the cache does not go below this.
+     */
+    LIVRECORE_API void add(Cache& cache, size_t minMemBytes);
+
+    /** @return the total budget of the caches. */
+    LIVRECORE_API size_t getMaximumMemory() const;
+
+    /**
+     * Changes the total budget of the caches. The shares and the minimum
+     * shares of the caches are scaled with it.
+     * @param maxMemBytes the new total budget.
+     */
+    LIVRECORE_API void setMaximumMemory(size_t maxMemBytes);
+
+    /**
+     * Moves one step of the budget to the cache which needs it most, if any.
+     * @return true if the budgets changed.
+     */
+    LIVRECORE_API bool rebalance();
+
+    /** @return the current shares of the caches, in the order of add(). */
+    LIVRECORE_API Budgets getBudgets() const;
+
+private:
+    CacheArbiter(const CacheArbiter&) = delete;
+    CacheArbiter& operator=(const CacheArbiter&) = delete;
+
+    struct Impl;
+    std::unique_ptr<Impl> _impl;
+};
+}
+
+#endif // _CacheArbiter_h_
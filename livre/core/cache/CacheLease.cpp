@@ -0,0 +1,61 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/core/cache/Cache.h>
+#include <livre/core/cache/CacheLease.h>
+#include <livre/data/NodeId.h>
+
+namespace livre
+{
+namespace
+{
+CacheIds toCacheIds(const NodeIds& nodeIds)
+{
+    CacheIds cacheIds;
+    cacheIds.reserve(nodeIds.size());
+    for (const NodeId& nodeId : nodeIds)
+        cacheIds.push_back(nodeId.getId());
+    return cacheIds;
+}
+}
+
+CacheLease::CacheLease(Cache& cache, const CacheIds& cacheIds)
+    : _cache(cache)
+    , _cacheIds(cacheIds)
+{
+    _cache._pin(_cacheIds);
+}
+
+CacheLease::CacheLease(Cache& cache, const NodeIds& nodeIds)
+    : _cache(cache)
+    , _cacheIds(toCacheIds(nodeIds))
+{
+    _cache._pin(_cacheIds);
+}
+
+CacheLease::~CacheLease()
+{
+    _cache._unpin(_cacheIds);
+}
+
+CacheIds CacheLease::getRejected() const
+{
+    return _cache._getRejected(_cacheIds);
+}
+}
@@ -0,0 +1,74 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _CacheLease_h_
+#define _CacheLease_h_
+
+#include <livre/core/api.h>
+#include <livre/core/types.h>
+
+namespace livre
+{
+/**
+ * The CacheLease class pins a working set of objects in a \see Cache for its
+ * lifetime. Pinned objects are not evicted by the cache policy, neither are
+ * they unloaded, so loading the rest of the working set cannot evict them.
+ *
+ * The objects do not need to be in the cache yet, they are pinned once they are
+ * loaded. If the pinned objects would exceed the maximum memory of the cache,
+ * the load of the exceeding ones fails instead and they are reported by
+ * getRejected(). Leases can overlap, an object stays pinned until all its
+ * leases are released.
+ */
+class CacheLease
+{
+public:
+    /**
+     * Pins the objects.
+     * @param cache the cache of the objects.
+     * @param cacheIds the ids of the objects.
+     */
+    LIVRECORE_API CacheLease(Cache& cache, const CacheIds& cacheIds);
+
+    /**
+     * Pins the objects of the nodes.
+     * @param cache the cache of the objects.
+     * @param nodeIds the nodes of the objects.
+     */
+    LIVRECORE_API CacheLease(Cache& cache, const NodeIds& nodeIds);
+
+    /** Releases the objects. */
+    LIVRECORE_API ~CacheLease();
+
+    /**
+     * @return the ids of the objects which could not be loaded because the
+     * pinned objects would exceed the maximum memory of the cache.
+     */
+    LIVRECORE_API CacheIds getRejected() const;
+
+private:
+    CacheLease(const CacheLease&) = delete;
+    CacheLease& operator=(const CacheLease&) = delete;
+
+    Cache& _cache;
+    const CacheIds _cacheIds;
+};
+}
+
+#endif // _CacheLease_h_
@@ -37,6 +37,19 @@ public:
     /** @return The memory size of the object in bytes. */
     virtual size_t getSize() const = 0;
 
+    /**
+     * @return The size of the object in bytes once decompressed, the same as
+     * getSize() for objects which are not compressed.
+     */
+    virtual size_t getUncompressedSize() const { return getSize(); }
+
+    /**
+     * Called when the cache policy evicts the object to free memory, before
+     * the cache releases it. The cache is locked meanwhile.
+     * @param statistics the statistics of the cache.
+     */
+    virtual void evicted(CacheStatistics& /*statistics*/) const {}
+
     /** @return The unique cache id. */
     LIVRECORE_API CacheId getId() const;
 
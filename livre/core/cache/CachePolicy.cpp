@@ -0,0 +1,70 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/core/cache/ARCCachePolicy.h>
+#include <livre/core/cache/CachePolicy.h>
+#include <livre/core/cache/CostCachePolicy.h>
+#include <livre/core/cache/LRUCachePolicy.h>
+#include <livre/core/cache/OctreeCachePolicy.h>
+
+namespace livre
+{
+namespace
+{
+const std::string policyNames[] = {"lru", "arc", "cost", "octree"};
+}
+
+CachePolicy::~CachePolicy()
+{
+}
+
+CachePolicyPtr CachePolicy::create(const CachePolicyType type,
+                                   const size_t maxMemBytes)
+{
+    switch (type)
+    {
+    case CP_LRU:
+        return CachePolicyPtr(new LRUCachePolicy);
+    case CP_ARC:
+        return CachePolicyPtr(new ARCCachePolicy(maxMemBytes));
+    case CP_COST:
+        return CachePolicyPtr(new CostCachePolicy);
+    case CP_OCTREE:
+        return CachePolicyPtr(new OctreeCachePolicy);
+    }
+    LBTHROW(std::runtime_error("Unknown cache policy type"));
+}
+
+CachePolicyType getCachePolicyType(const std::string& name)
+{
+    for (uint32_t i = 0; i < sizeof(policyNames) / sizeof(std::string); ++i)
+    {
+        if (policyNames[i] == name)
+            return CachePolicyType(i);
+    }
+    LBTHROW(std::runtime_error("Unknown cache policy: " + name));
+}
+
+std::string getCachePolicyName(const CachePolicyType type)
+{
+    if (type >= sizeof(policyNames) / sizeof(std::string))
+        LBTHROW(std::runtime_error("Unknown cache policy type"));
+    return policyNames[type];
+}
+}
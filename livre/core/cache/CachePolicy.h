@@ -0,0 +1,120 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _CachePolicy_h_
+#define _CachePolicy_h_
+
+#include <livre/core/api.h>
+#include <livre/core/types.h>
+
+namespace livre
+{
+/** The eviction strategies available for a \see Cache */
+enum CachePolicyType
+{
+    CP_LRU = 0u,   //!< Least recently used, see LRUCachePolicy
+    CP_ARC = 1u,   //!< Adaptive replacement, see ARCCachePolicy
+    CP_COST = 2u,  //!< Reload cost aware, see CostCachePolicy
+    CP_OCTREE = 3u //!< Leaves of the octree first, see OctreeCachePolicy
+};
+
+/**
+ * The CachePolicy class decides in which order the objects of a \see Cache are
+ * evicted. The cache keeps track of the memory usage and asks the policy for
+ * eviction candidates when it is full. Policies are not thread safe, the cache
+ * serializes all calls.
+ */
+class CachePolicy
+{
+public:
+    LIVRECORE_API virtual ~CachePolicy();
+
+    /**
+     * Called when an object is inserted into the cache.
+     * @param cacheObject the inserted object.
+     * @param loadTime the time it took to construct the object in ms.
+     */
+    virtual void insert(const CacheObject& cacheObject, float loadTime) = 0;
+
+    /**
+     * Called on cache hits.
+     * @param cacheId the id of the accessed object.
+     */
+    virtual void touch(const CacheId& cacheId) = 0;
+
+    /**
+     * Called when an object is removed from the cache other than by an
+     * eviction, e.g. when it is unloaded or purged.
+     * @param cacheId the id of the removed object.
+     */
+    virtual void remove(const CacheId& cacheId) = 0;
+
+    /**
+     * Called when the cache evicts one of the candidates of the policy to
+     * free memory. Removes the object by default.
+     * @param cacheId the id of the evicted object.
+     */
+    virtual void evict(const CacheId& cacheId) { remove(cacheId); }
+
+    /** Removes all entries from the policy. */
+    virtual void clear() = 0;
+
+    /**
+     * @return the first eviction candidate or INVALID_CACHE_ID if there is no
+     * object to evict.
+     */
+    virtual CacheId getFirst() const = 0;
+
+    /**
+     * @param cacheId the current eviction candidate.
+     * @return the eviction candidate after cacheId or INVALID_CACHE_ID if there
+     * is none. The candidate order is stable until the policy is modified by
+     * anything else than removing the visited candidates.
+     */
+    virtual CacheId getNext(const CacheId& cacheId) const = 0;
+
+    /**
+     * Called when the memory budget of the cache changes.
+     * @param maxMemBytes the new memory budget.
+     */
+    virtual void setMaximumMemory(size_t /*maxMemBytes*/) {}
+
+    /**
+     * Creates one of the built-in policies.
+     * @param type the policy type.
+     * @param maxMemBytes the memory budget of the cache.
+     * @return the policy.
+     * @throw std::runtime_error if the type is unknown.
+     */
+    LIVRECORE_API static CachePolicyPtr create(CachePolicyType type,
+                                               size_t maxMemBytes);
+};
+
+/**
+ * @param name the policy name, one of "lru", "arc", "cost" or "octree".
+ * @return the policy type.
+ * @throw std::runtime_error if the name is unknown.
+ */
+LIVRECORE_API CachePolicyType getCachePolicyType(const std::string& name);
+
+/** @return the name of the policy type, as accepted by getCachePolicyType */
+LIVRECORE_API std::string getCachePolicyName(CachePolicyType type);
+}
+
+#endif // _CachePolicy_h_
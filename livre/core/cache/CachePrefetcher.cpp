@@ -0,0 +1,203 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/core/cache/Cache.h>
+#include <livre/core/cache/CacheObject.h>
+#include <livre/core/cache/CachePrefetcher.h>
+#include <livre/core/cache/CacheStatistics.h>
+
+#include <boost/thread/thread.hpp>
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace livre
+{
+namespace
+{
+const std::string manifestHeader = "Livre cache manifest 1";
+
+// The signature is stored on a single line
+std::string toLine(std::string signature)
+{
+    std::replace(signature.begin(), signature.end(), '\n', ' ');
+    return signature;
+}
+
+// Prefetching must not compete with the rendering for the CPU
+void lowerPriority()
+{
+#ifdef __linux__
+    // Linux applies the nice value of a thread id to the thread only
+    if (::setpriority(PRIO_PROCESS, ::syscall(SYS_gettid), 19) != 0)
+        LBVERB << "Cannot lower the priority of the prefetching" << std::endl;
+#endif
+}
+}
+
+struct CachePrefetcher::Impl
+{
+    Impl(const Cache& cache, const CacheIds& cacheIds,
+         const LoadFunc& loadFunc, const size_t nThreads)
+        : _cache(cache)
+        , _cacheIds(cacheIds)
+        , _loadFunc(loadFunc)
+        , _next(0)
+        , _loaded(0)
+        , _maxObjectSize(0)
+        , _stopped(false)
+    {
+        for (size_t i = 0; i < std::max(nThreads, size_t(1)); ++i)
+            _threads.create_thread([this] { run(); });
+    }
+
+    ~Impl()
+    {
+        _stopped = true;
+        _threads.join_all();
+    }
+
+    bool isFull() const
+    {
+        const CacheStatistics& statistics = _cache.getStatistics();
+        return statistics.getUsedMemory() + _maxObjectSize >=
+               statistics.getMaximumMemory();
+    }
+
+    void run()
+    {
+        lowerPriority();
+        while (!_stopped)
+        {
+            const size_t index = _next++;
+            if (index >= _cacheIds.size())
+                return;
+
+            // Stop before the next object could evict another one
+            if (isFull())
+            {
+                _stopped = true;
+                return;
+            }
+
+            ConstCacheObjectPtr obj;
+            try
+            {
+                obj = _loadFunc(_cacheIds[index]);
+            }
+            catch (const std::exception& error)
+            {
+                LBWARN << "Prefetching " << _cacheIds[index]
+                       << " failed: " << error.what() << std::endl;
+            }
+            if (!obj)
+                continue;
+
+            ++_loaded;
+            size_t maxSize = _maxObjectSize;
+            while (obj->getSize() > maxSize &&
+                   !_maxObjectSize.compare_exchange_weak(maxSize,
+                                                         obj->getSize()))
+            {
+            }
+        }
+    }
+
+    const Cache& _cache;
+    const CacheIds _cacheIds;
+    const LoadFunc _loadFunc;
+    std::atomic<size_t> _next;
+    std::atomic<size_t> _loaded;
+    std::atomic<size_t> _maxObjectSize;
+    std::atomic<bool> _stopped;
+    boost::thread_group _threads;
+};
+
+CachePrefetcher::CachePrefetcher(const Cache& cache, const CacheIds& cacheIds,
+                                 const LoadFunc& loadFunc,
+                                 const size_t nThreads)
+    : _impl(new Impl(cache, cacheIds, loadFunc, nThreads))
+{
+}
+
+CachePrefetcher::~CachePrefetcher()
+{
+}
+
+void CachePrefetcher::wait()
+{
+    _impl->_threads.join_all();
+}
+
+size_t CachePrefetcher::getLoadedCount() const
+{
+    return _impl->_loaded;
+}
+
+void saveCacheManifest(const Cache& cache, const std::string& filename,
+                       const std::string& signature)
+{
+    const CacheIds cacheIds = cache.getCacheIds();
+    const std::string tmpFilename = filename + ".tmp";
+    {
+        std::ofstream file(tmpFilename);
+        file << manifestHeader << std::endl
+             << toLine(signature) << std::endl
+             << std::hex;
+        for (const CacheId& cacheId : cacheIds)
+            file << cacheId << std::endl;
+        if (!file)
+            LBTHROW(std::runtime_error("Cannot write cache manifest " +
+                                       tmpFilename));
+    }
+
+    if (std::rename(tmpFilename.c_str(), filename.c_str()) != 0)
+    {
+        std::remove(tmpFilename.c_str());
+        LBTHROW(std::runtime_error("Cannot write cache manifest " + filename));
+    }
+}
+
+CacheIds loadCacheManifest(const std::string& filename,
+                           const std::string& signature)
+{
+    std::ifstream file(filename);
+    std::string header;
+    std::string savedSignature;
+    if (!std::getline(file, header) || header != manifestHeader ||
+        !std::getline(file, savedSignature) ||
+        savedSignature != toLine(signature))
+    {
+        return CacheIds();
+    }
+
+    CacheIds cacheIds;
+    CacheId cacheId;
+    while (file >> std::hex >> cacheId)
+        cacheIds.push_back(cacheId);
+    return cacheIds;
+}
+}
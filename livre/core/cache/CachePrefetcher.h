@@ -0,0 +1,92 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _CachePrefetcher_h_
+#define _CachePrefetcher_h_
+
+#include <livre/core/api.h>
+#include <livre/core/types.h>
+
+namespace livre
+{
+/**
+ * The CachePrefetcher class loads a list of objects into a \see Cache in the
+ * background, e.g. to warm up the cache with the hot set of an earlier session
+ * before the first frames need it.
+ *
+ * The objects are loaded in the order of the list by low priority threads. The
+ * prefetching stops before the cache is full, so the prefetched objects never
+ * evict each other or the objects loaded by the renderer in the meantime.
+ */
+class CachePrefetcher
+{
+public:
+    typedef std::function<ConstCacheObjectPtr(const CacheId&)> LoadFunc;
+
+    /**
+     * Starts prefetching.
+     * @param cache the cache the objects are loaded into.
+     * @param cacheIds the ids of the objects, the most important first.
+     * @param loadFunc loads an object into the cache.
+     * @param nThreads the number of loading threads.
+     */
+    LIVRECORE_API CachePrefetcher(const Cache& cache, const CacheIds& cacheIds,
+                                  const LoadFunc& loadFunc,
+                                  size_t nThreads = 2);
+
+    /** Cancels the prefetching and waits for the running loads. */
+    LIVRECORE_API ~CachePrefetcher();
+
+    /** Waits until all objects are loaded or the cache is full. */
+    LIVRECORE_API void wait();
+
+    /** @return the number of objects prefetched so far. */
+    LIVRECORE_API size_t getLoadedCount() const;
+
+private:
+    CachePrefetcher(const CachePrefetcher&) = delete;
+    CachePrefetcher& operator=(const CachePrefetcher&) = delete;
+
+    struct Impl;
+    std::unique_ptr<Impl> _impl;
+};
+
+/**
+ * Saves the ids of the cached objects to a manifest file, in the order of
+ * Cache::getCacheIds().
+ * @param cache the cache.
+ * @param filename the manifest file, replaced atomically.
+ * @param signature identifies the data of the cache, e.g. the volume URI.
+ * @throw std::runtime_error if the file cannot be written.
+ */
+LIVRECORE_API void saveCacheManifest(const Cache& cache,
+                                     const std::string& filename,
+                                     const std::string& signature);
+
+/**
+ * @param filename the manifest file.
+ * @param signature identifies the data of the cache.
+ * @return the ids saved in the manifest, empty if the manifest does not exist
+ * or was saved for other data.
+ */
+LIVRECORE_API CacheIds loadCacheManifest(const std::string& filename,
+                                         const std::string& signature);
+}
+
+#endif // _CachePrefetcher_h_
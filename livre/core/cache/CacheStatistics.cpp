@@ -22,53 +22,303 @@
 #include <livre/core/cache/CacheStatistics.h>
 #include <livre/core/util/ThreadClock.h>
 
+#include <cmath>
+
 namespace livre
 {
+namespace
+{
+const size_t subBucketBits = 2;
+const size_t nSubBuckets = 1u << subBucketBits;
+
+size_t getHighestBit(size_t value)
+{
+    size_t bit = 0;
+    while (value >>= 1)
+        ++bit;
+    return bit;
+}
+
+float getRatio(const size_t part, const size_t total)
+{
+    return total == 0 ? 0.f : float(part) / float(total);
+}
+}
+
+const size_t CacheStatisticsSnapshot::nLatencyBuckets;
+
+CacheStatisticsSnapshot::CacheStatisticsSnapshot()
+    : time(0.f)
+    , usedMemBytes(0)
+    , blockCount(0)
+    , hits(0)
+    , misses(0)
+    , hitBytes(0)
+    , loadedBytes(0)
+    , savedLoads(0)
+    , evictions(0)
+    , rejectedEvictions(0)
+    , rejectedPins(0)
+    , spills(0)
+    , droppedSpills(0)
+    , uncompressedMemBytes(0)
+    , decompressedBytes(0)
+    , decompressionTime(0.f)
+    , loadLatencies(nLatencyBuckets, 0)
+{
+}
+
+size_t CacheStatisticsSnapshot::getLatencyBucket(const float loadTime)
+{
+    // Bucket 0 holds everything below 1 us, then each power of two
+    // microseconds is split into nSubBuckets linear buckets
+    const float micros = loadTime * 1000.f;
+    if (!(micros >= 1.f))
+        return 0;
+    if (micros >= float(1ull << 32))
+        return nLatencyBuckets - 1;
+
+    const size_t value = size_t(micros);
+    const size_t exponent = getHighestBit(value);
+    const size_t subBucket = ((value << subBucketBits) >> exponent) &
+                             (nSubBuckets - 1);
+    return std::min(1 + exponent * nSubBuckets + subBucket,
+                    nLatencyBuckets - 1);
+}
+
+float CacheStatisticsSnapshot::getLatencyBucketLimit(const size_t bucket)
+{
+    if (bucket == 0)
+        return 0.001f;
+
+    const size_t exponent = (bucket - 1) / nSubBuckets;
+    const size_t subBucket = (bucket - 1) % nSubBuckets;
+    const float micros = float(1ull << exponent) *
+                         (1.f + float(subBucket + 1) / float(nSubBuckets));
+    return micros / 1000.f;
+}
+
+float CacheStatisticsSnapshot::getHitRatio() const
+{
+    return getRatio(hits, hits + misses);
+}
+
+float CacheStatisticsSnapshot::getByteHitRatio() const
+{
+    return getRatio(hitBytes, hitBytes + loadedBytes);
+}
+
+size_t CacheStatisticsSnapshot::getLoadCount() const
+{
+    size_t count = 0;
+    for (const size_t bucketCount : loadLatencies)
+        count += bucketCount;
+    return count;
+}
+
+float CacheStatisticsSnapshot::getLoadLatency(const float percentile) const
+{
+    const size_t count = getLoadCount();
+    if (count == 0)
+        return 0.f;
+
+    const size_t rank = std::max(size_t(std::ceil(percentile * count)),
+                                 size_t(1));
+    size_t accumulated = 0;
+    for (size_t i = 0; i < loadLatencies.size(); ++i)
+    {
+        accumulated += loadLatencies[i];
+        if (accumulated >= rank)
+            return getLatencyBucketLimit(i);
+    }
+    return getLatencyBucketLimit(loadLatencies.size() - 1);
+}
+
+float CacheStatisticsSnapshot::getLoadTime() const
+{
+    // The middle of a bucket is within 12.5% of the times in it
+    float time = 0.f;
+    for (size_t i = 0; i < loadLatencies.size(); ++i)
+    {
+        const float lower = i == 0 ? 0.f : getLatencyBucketLimit(i - 1);
+        time += loadLatencies[i] * 0.5f * (lower + getLatencyBucketLimit(i));
+    }
+    return time;
+}
+
+float CacheStatisticsSnapshot::getCompressionRatio() const
+{
+    return usedMemBytes == 0 ? 1.f : float(uncompressedMemBytes) /
+                                         float(usedMemBytes);
+}
+
+float CacheStatisticsSnapshot::getDecompressionThroughput() const
+{
+    return decompressionTime <= 0.f ? 0.f
+                                    : float(decompressedBytes) / LB_1MB /
+                                          (decompressionTime / 1000.f);
+}
+
+CacheStatisticsSnapshot CacheStatisticsSnapshot::operator-(
+    const CacheStatisticsSnapshot& previous) const
+{
+    CacheStatisticsSnapshot diff(*this);
+    diff.time -= previous.time;
+    diff.hits -= previous.hits;
+    diff.misses -= previous.misses;
+    diff.hitBytes -= previous.hitBytes;
+    diff.loadedBytes -= previous.loadedBytes;
+    diff.savedLoads -= previous.savedLoads;
+    diff.evictions -= previous.evictions;
+    diff.rejectedEvictions -= previous.rejectedEvictions;
+    diff.rejectedPins -= previous.rejectedPins;
+    diff.spills -= previous.spills;
+    diff.droppedSpills -= previous.droppedSpills;
+    diff.decompressedBytes -= previous.decompressedBytes;
+    diff.decompressionTime -= previous.decompressionTime;
+    for (size_t i = 0; i < nLatencyBuckets; ++i)
+        diff.loadLatencies[i] -= previous.loadLatencies[i];
+    return diff;
+}
+
 CacheStatistics::CacheStatistics(const std::string& name,
                                  const size_t maxMemBytes)
     : _name(name)
     , _usedMemBytes(0)
+    , _uncompressedMemBytes(0)
     , _maxMemBytes(maxMemBytes)
     , _objCount(0)
     , _cacheHit(0)
     , _cacheMiss(0)
+    , _savedLoads(0)
+    , _hitBytes(0)
+    , _loadedBytes(0)
+    , _evictions(0)
+    , _rejectedEvictions(0)
+    , _rejectedPins(0)
+    , _spills(0)
+    , _droppedSpills(0)
+    , _decompressedBytes(0)
+    , _decompressionTime(0)
+{
+    for (std::atomic<size_t>& bucket : _loadLatencies)
+        bucket = 0;
+}
+
+void CacheStatistics::notifyHit(const CacheObject& cacheObject)
 {
+    ++_cacheHit;
+    _hitBytes += cacheObject.getSize();
 }
 
-void CacheStatistics::notifyLoaded(const CacheObject& cacheObject)
+void CacheStatistics::notifyLoaded(const CacheObject& cacheObject,
+                                   const float loadTime)
 {
+    const size_t size = cacheObject.getSize();
     ++_objCount;
-    _usedMemBytes += cacheObject.getSize();
+    _usedMemBytes += size;
+    _uncompressedMemBytes += cacheObject.getUncompressedSize();
+    _loadedBytes += size;
+    ++_loadLatencies[CacheStatisticsSnapshot::getLatencyBucket(loadTime)];
 }
 
 void CacheStatistics::notifyUnloaded(const CacheObject& cacheObject)
 {
     --_objCount;
     _usedMemBytes -= cacheObject.getSize();
+    _uncompressedMemBytes -= cacheObject.getUncompressedSize();
+}
+
+void CacheStatistics::notifySpill(const bool stored)
+{
+    ++_spills;
+    if (!stored)
+        ++_droppedSpills;
+}
+
+void CacheStatistics::notifyDecompressed(const size_t size,
+                                         const float time) const
+{
+    _decompressedBytes += size;
+    _decompressionTime += size_t(time * 1000000.f);
+}
+
+CacheStatisticsSnapshot CacheStatistics::getSnapshot() const
+{
+    CacheStatisticsSnapshot snapshot;
+    snapshot.time = _clock.getTimef();
+    snapshot.usedMemBytes = _usedMemBytes;
+    snapshot.blockCount = _objCount;
+    snapshot.hits = _cacheHit;
+    snapshot.misses = _cacheMiss;
+    snapshot.hitBytes = _hitBytes;
+    snapshot.loadedBytes = _loadedBytes;
+    snapshot.savedLoads = _savedLoads;
+    snapshot.evictions = _evictions;
+    snapshot.rejectedEvictions = _rejectedEvictions;
+    snapshot.rejectedPins = _rejectedPins;
+    snapshot.spills = _spills;
+    snapshot.droppedSpills = _droppedSpills;
+    snapshot.uncompressedMemBytes = _uncompressedMemBytes;
+    snapshot.decompressedBytes = _decompressedBytes;
+    snapshot.decompressionTime = float(_decompressionTime) / 1000000.f;
+    for (size_t i = 0; i < CacheStatisticsSnapshot::nLatencyBuckets; ++i)
+        snapshot.loadLatencies[i] = _loadLatencies[i];
+    return snapshot;
 }
 
 void CacheStatistics::clear()
 {
     _usedMemBytes = 0;
+    _uncompressedMemBytes = 0;
     _objCount = 0;
     _cacheHit = 0;
     _cacheMiss = 0;
+    _savedLoads = 0;
+    _hitBytes = 0;
+    _loadedBytes = 0;
+    _evictions = 0;
+    _rejectedEvictions = 0;
+    _rejectedPins = 0;
+    _spills = 0;
+    _droppedSpills = 0;
+    _decompressedBytes = 0;
+    _decompressionTime = 0;
+    for (std::atomic<size_t>& bucket : _loadLatencies)
+        bucket = 0;
+    _clock.reset();
 }
 
 std::ostream& operator<<(std::ostream& stream,
                          const CacheStatistics& statistics)
 {
-    const int hits = int(100.f * float(statistics._cacheHit) /
-                         float(statistics._cacheHit + statistics._cacheMiss));
+    const CacheStatisticsSnapshot snapshot = statistics.getSnapshot();
+    const int hits = int(100.f * snapshot.getHitRatio());
+    const int byteHits = int(100.f * snapshot.getByteHitRatio());
     stream << statistics._name << std::endl;
-    stream << "  Used Memory: "
-           << (statistics._usedMemBytes + LB_1MB - 1) / LB_1MB << "/"
-           << (statistics._maxMemBytes + LB_1MB - 1) / LB_1MB << "MB"
-           << std::endl;
-    stream << "  Block Count: " << statistics._objCount << std::endl;
-    stream << "  Cache hits: " << statistics._cacheHit << " (" << hits << "%)"
+    stream << "  Used Memory: " << (snapshot.usedMemBytes + LB_1MB - 1) / LB_1MB
+           << "/" << (statistics.getMaximumMemory() + LB_1MB - 1) / LB_1MB
+           << "MB"
            << std::endl;
-    stream << "  Cache misses: " << statistics._cacheMiss << std::endl;
+    if (snapshot.uncompressedMemBytes != snapshot.usedMemBytes)
+        stream << "  Compression: " << snapshot.getCompressionRatio()
+               << "x, decompressed at " << snapshot.getDecompressionThroughput()
+               << "MB/s" << std::endl;
+    stream << "  Block Count: " << snapshot.blockCount << std::endl;
+    stream << "  Cache hits: " << snapshot.hits << " (" << hits << "%, "
+           << byteHits << "% bytes)" << std::endl;
+    stream << "  Cache misses: " << snapshot.misses << std::endl;
+    stream << "  Saved loads: " << snapshot.savedLoads << std::endl;
+    stream << "  Evictions: " << snapshot.evictions << " ("
+           << snapshot.rejectedEvictions << " rejected)" << std::endl;
+    if (snapshot.spills > 0)
+        stream << "  Spills: " << snapshot.spills << " ("
+               << snapshot.droppedSpills << " dropped)" << std::endl;
+    if (snapshot.rejectedPins > 0)
+        stream << "  Pinned over budget: " << snapshot.rejectedPins
+               << std::endl;
+    stream << "  Load latency: " << snapshot.getLoadLatency(0.5f) << "ms p50, "
+           << snapshot.getLoadLatency(0.99f) << "ms p99" << std::endl;
 
     return stream;
 }
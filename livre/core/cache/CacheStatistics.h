@@ -23,14 +23,107 @@
 
 #include <livre/core/api.h>
 #include <livre/core/types.h>
+#include <lunchbox/clock.h>
 #include <lunchbox/mtQueue.h>
 
+#include <atomic>
+
 #define CACHE_LOG_SIZE 1000000
 
 namespace livre
 {
 /**
- * The CacheStatistics struct keeps the statistics of the \see Cache.
+ * The CacheStatisticsSnapshot struct is a copy of the counters of the \see
+ * CacheStatistics at a point in time. The difference of two snapshots gives
+ * the activity in between, from which rates can be computed without clearing
+ * the statistics.
+ */
+struct CacheStatisticsSnapshot
+{
+    /** The number of buckets of the load latency histogram. */
+    static const size_t nLatencyBuckets = 129;
+
+    LIVRECORE_API CacheStatisticsSnapshot();
+
+    /**
+     * @param loadTime the load time in milliseconds.
+     * @return the histogram bucket of the load time. The buckets are log-linear
+     * with four buckets per power of two microseconds, so a bucket has a
+     * precision of 25%.
+     */
+    LIVRECORE_API static size_t getLatencyBucket(float loadTime);
+
+    /**
+     * @param bucket the histogram bucket.
+     * @return the upper limit of the bucket in milliseconds.
+     */
+    LIVRECORE_API static float getLatencyBucketLimit(size_t bucket);
+
+    /** @return the ratio of hits to lookups, 0 if there were no lookups */
+    LIVRECORE_API float getHitRatio() const;
+
+    /**
+     * @return the ratio of the bytes returned by hits to the bytes returned by
+     * hits and loads, 0 if there were none.
+     */
+    LIVRECORE_API float getByteHitRatio() const;
+
+    /** @return the number of loads in the load latency histogram. */
+    LIVRECORE_API size_t getLoadCount() const;
+
+    /**
+     * @param percentile in the range [0,1].
+     * @return the upper limit in milliseconds of the load latency histogram
+     * bucket containing the percentile, 0 if there were no loads.
+     */
+    LIVRECORE_API float getLoadLatency(float percentile) const;
+
+    /**
+     * @return the total time of the loads in milliseconds, estimated from the
+     * load latency histogram.
+     */
+    LIVRECORE_API float getLoadTime() const;
+
+    /**
+     * @return the ratio of the uncompressed to the used memory, 1 if the cache
+     * is empty or its objects are not compressed.
+     */
+    LIVRECORE_API float getCompressionRatio() const;
+
+    /** @return the decompressed MB per second, 0 if nothing was decompressed */
+    LIVRECORE_API float getDecompressionThroughput() const;
+
+    /**
+     * @param previous an earlier snapshot of the same statistics.
+     * @return the counters accumulated since the previous snapshot. The memory
+     * usage and the block count are not accumulated and taken from this
+     * snapshot, the time is the duration between the snapshots.
+     */
+    LIVRECORE_API CacheStatisticsSnapshot
+        operator-(const CacheStatisticsSnapshot& previous) const;
+
+    float time;                        //!< ms since creation or clear
+    size_t usedMemBytes;               //!< Memory used by the cached objects
+    size_t blockCount;                 //!< Number of cached objects
+    size_t hits;                       //!< Lookups finding the object
+    size_t misses;                     //!< Lookups not finding the object
+    size_t hitBytes;                   //!< Bytes of the hit objects
+    size_t loadedBytes;                //!< Bytes of the loaded objects
+    size_t savedLoads;                 //!< Loads joining a concurrent load
+    size_t evictions;                  //!< Objects unloaded by the cache policy
+    size_t rejectedEvictions;          //!< Referenced objects not unloaded
+    size_t rejectedPins;               //!< Pinned objects exceeding memory
+    size_t spills;                     //!< Evicted objects given for spilling
+    size_t droppedSpills;              //!< Evicted objects not spilled
+    size_t uncompressedMemBytes;       //!< Used memory once decompressed
+    size_t decompressedBytes;          //!< Bytes decompressed by readers
+    float decompressionTime;           //!< ms spent decompressing
+    std::vector<size_t> loadLatencies; //!< Load latency histogram
+};
+
+/**
+ * The CacheStatistics struct keeps the statistics of the \see Cache. The
+ * counters can be updated and read concurrently.
  */
 class CacheStatistics
 {
@@ -56,6 +149,15 @@ public:
      * @return Max memory in bytes used by the \see Cache.
      */
     LIVRECORE_API size_t getMaximumMemory() const { return _maxMemBytes; }
+    /**
+     * Sets the max memory reported by the statistics, the \see Cache sets it
+     * when its budget changes.
+     */
+    void setMaximumMemory(const size_t maxMemBytes)
+    {
+        _maxMemBytes = maxMemBytes;
+    }
+
     /**
      * @return the name of the statistics
      */
@@ -66,13 +168,59 @@ public:
     void notifyMiss() { ++_cacheMiss; }
     /**
      * Notifies the statistics for cache hits
+     * @param cacheObject is the cache object found.
+     */
+    LIVRECORE_API void notifyHit(const CacheObject& cacheObject);
+
+    /**
+     * Notifies the statistics for loads which waited for the same object being
+     * loaded by another thread instead of loading it again
+     */
+    void notifySavedLoad() { ++_savedLoads; }
+    /**
+     * @return Number of loads which were not executed because the same object
+     * was already being loaded.
+     */
+    LIVRECORE_API size_t getSavedLoads() const { return _savedLoads; }
+    /**
+     * Notifies the statistics for objects unloaded by the cache policy
+     */
+    void notifyEviction() { ++_evictions; }
+    /**
+     * @return Number of objects unloaded by the cache policy.
+     */
+    LIVRECORE_API size_t getEvictions() const { return _evictions; }
+    /**
+     * Notifies the statistics for unloads which failed because the object is
+     * still referenced
      */
-    void notifyHit() { ++_cacheHit; }
+    void notifyRejectedEviction() { ++_rejectedEvictions; }
+    /**
+     * @return Number of unloads which failed because the object was still
+     * referenced.
+     */
+    LIVRECORE_API size_t getRejectedEvictions() const
+    {
+        return _rejectedEvictions;
+    }
+
+    /**
+     * Notifies the statistics for pinned objects which were not loaded because
+     * the pinned objects would exceed the maximum memory
+     */
+    void notifyRejectedPin() { ++_rejectedPins; }
+    /**
+     * @return Number of pinned objects which were not loaded because the
+     * pinned objects would exceed the maximum memory.
+     */
+    LIVRECORE_API size_t getRejectedPins() const { return _rejectedPins; }
     /**
      * Notifies statistics when an object is loaded.
      * @param cacheObject is the cache object.
+     * @param loadTime the time in milliseconds to load the object.
      */
-    LIVRECORE_API void notifyLoaded(const CacheObject& cacheObject);
+    LIVRECORE_API void notifyLoaded(const CacheObject& cacheObject,
+                                    float loadTime);
 
     /**
      * Notifies statistics when an object is unloaded.
@@ -80,6 +228,28 @@ public:
      */
     LIVRECORE_API void notifyUnloaded(const CacheObject& cacheObject);
 
+    /**
+     * Notifies statistics when an evicted object is handed to a second level
+     * cache, see CacheObject::evicted().
+     * @param stored false if the second level cache dropped the object.
+     */
+    LIVRECORE_API void notifySpill(bool stored);
+
+    /**
+     * Notifies statistics when the data of a compressed object is decompressed
+     * for use. The readers of a cache only have const access to it, hence this
+     * is const.
+     * @param size the decompressed size in bytes.
+     * @param time the time in milliseconds to decompress.
+     */
+    LIVRECORE_API void notifyDecompressed(size_t size, float time) const;
+
+    /**
+     * @return a copy of the current counters. The counters are read one by one,
+     * so concurrent updates may be partially included.
+     */
+    LIVRECORE_API CacheStatisticsSnapshot getSnapshot() const;
+
     /**
       * Clears the statistics
       */
@@ -95,11 +265,25 @@ public:
 
 private:
     std::string _name;
-    size_t _usedMemBytes;
-    const size_t _maxMemBytes;
-    size_t _objCount;
-    size_t _cacheHit;
-    size_t _cacheMiss;
+    std::atomic<size_t> _usedMemBytes;
+    std::atomic<size_t> _uncompressedMemBytes;
+    std::atomic<size_t> _maxMemBytes;
+    std::atomic<size_t> _objCount;
+    std::atomic<size_t> _cacheHit;
+    std::atomic<size_t> _cacheMiss;
+    std::atomic<size_t> _savedLoads;
+    std::atomic<size_t> _hitBytes;
+    std::atomic<size_t> _loadedBytes;
+    std::atomic<size_t> _evictions;
+    std::atomic<size_t> _rejectedEvictions;
+    std::atomic<size_t> _rejectedPins;
+    std::atomic<size_t> _spills;
+    std::atomic<size_t> _droppedSpills;
+    mutable std::atomic<size_t> _decompressedBytes;
+    mutable std::atomic<size_t> _decompressionTime; // ns
+    std::atomic<size_t>
+        _loadLatencies[CacheStatisticsSnapshot::nLatencyBuckets];
+    lunchbox::Clock _clock;
 };
 }
 
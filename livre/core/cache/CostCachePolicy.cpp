@@ -0,0 +1,182 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/core/cache/CacheObject.h>
+#include <livre/core/cache/CostCachePolicy.h>
+#include <livre/data/NodeId.h>
+
+namespace livre
+{
+namespace
+{
+// Objects served from memory (e.g. textures uploaded from the data cache) still
+// have a cost, otherwise only the level would matter
+const float minLoadTime = 0.01f; // ms
+
+double getCost(const CacheObject& cacheObject, const float loadTime)
+{
+    const NodeId nodeId(cacheObject.getId());
+    const uint32_t level = nodeId.isValid() ? nodeId.getLevel() : 0;
+    const double levelWeight = INVALID_LEVEL - level;
+    return std::max(loadTime, minLoadTime) * levelWeight;
+}
+}
+
+struct CostCachePolicy::Impl
+{
+    typedef std::pair<double, CacheId> Priority;
+    typedef std::set<Priority> Queue;
+
+    struct Entry
+    {
+        double costPerMB;
+        Queue::iterator position;
+    };
+
+    typedef std::unordered_map<CacheId, Entry> Index;
+
+    Impl()
+        : _inflation(0.0)
+    {
+    }
+
+    void insert(const CacheObject& cacheObject, const float loadTime)
+    {
+        const CacheId& cacheId = cacheObject.getId();
+        const double sizeMB =
+            std::max(double(cacheObject.getSize()) / LB_1MB, 1.0 / LB_1MB);
+        const double costPerMB = getCost(cacheObject, loadTime) / sizeMB;
+
+        Index::iterator it = _index.find(cacheId);
+        if (it == _index.end())
+        {
+            const Entry entry = {costPerMB, _queue.end()};
+            it = _index.emplace(cacheId, entry).first;
+        }
+        else
+        {
+            _queue.erase(it->second.position);
+            it->second.costPerMB = costPerMB;
+        }
+        enqueue(cacheId, it->second);
+    }
+
+    void touch(const CacheId& cacheId)
+    {
+        Index::iterator it = _index.find(cacheId);
+        if (it == _index.end())
+            return;
+
+        _queue.erase(it->second.position);
+        enqueue(cacheId, it->second);
+    }
+
+    void remove(const CacheId& cacheId, const bool evicted)
+    {
+        Index::iterator it = _index.find(cacheId);
+        if (it == _index.end())
+            return;
+
+        if (evicted)
+            _inflation = std::max(_inflation, it->second.position->first);
+        _queue.erase(it->second.position);
+        _index.erase(it);
+    }
+
+    void clear()
+    {
+        _queue.clear();
+        _index.clear();
+        _inflation = 0.0;
+    }
+
+    CacheId getFirst() const
+    {
+        return _queue.empty() ? INVALID_CACHE_ID : _queue.begin()->second;
+    }
+
+    CacheId getNext(const CacheId& cacheId) const
+    {
+        Index::const_iterator it = _index.find(cacheId);
+        if (it == _index.end())
+            return INVALID_CACHE_ID;
+
+        Queue::const_iterator next = it->second.position;
+        if (++next == _queue.end())
+            return INVALID_CACHE_ID;
+        return next->second;
+    }
+
+    void enqueue(const CacheId& cacheId, Entry& entry)
+    {
+        entry.position =
+            _queue.insert(Priority(_inflation + entry.costPerMB, cacheId))
+                .first;
+    }
+
+    double _inflation; // 'L' in the paper
+    Queue _queue;
+    Index _index;
+};
+
+CostCachePolicy::CostCachePolicy()
+    : _impl(new CostCachePolicy::Impl)
+{
+}
+
+CostCachePolicy::~CostCachePolicy()
+{
+}
+
+void CostCachePolicy::insert(const CacheObject& cacheObject,
+                             const float loadTime)
+{
+    _impl->insert(cacheObject, loadTime);
+}
+
+void CostCachePolicy::touch(const CacheId& cacheId)
+{
+    _impl->touch(cacheId);
+}
+
+void CostCachePolicy::remove(const CacheId& cacheId)
+{
+    _impl->remove(cacheId, false);
+}
+
+void CostCachePolicy::evict(const CacheId& cacheId)
+{
+    _impl->remove(cacheId, true);
+}
+
+void CostCachePolicy::clear()
+{
+    _impl->clear();
+}
+
+CacheId CostCachePolicy::getFirst() const
+{
+    return _impl->getFirst();
+}
+
+CacheId CostCachePolicy::getNext(const CacheId& cacheId) const
+{
+    return _impl->getNext(cacheId);
+}
+}
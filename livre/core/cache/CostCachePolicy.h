@@ -0,0 +1,73 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _CostCachePolicy_h_
+#define _CostCachePolicy_h_
+
+#include <livre/core/api.h>
+#include <livre/core/cache/CachePolicy.h> // base class
+
+namespace livre
+{
+/**
+ * The CostCachePolicy class weights objects by the cost of reloading them,
+ * using the GreedyDual-Size algorithm (Cao and Irani, 1997).
+ *
+ * The reload cost of an object is its measured load time, which reflects the
+ * compressed size and the storage speed, weighted by its octree level: coarse
+ * nodes are the rendering fallback of all their descendants and are kept
+ * longer. Objects with the lowest cost per byte are evicted first, and an
+ * inflation value raised on every eviction ages the objects which are not
+ * accessed anymore. Objects removed otherwise do not raise it.
+ */
+class CostCachePolicy : public CachePolicy
+{
+public:
+    LIVRECORE_API CostCachePolicy();
+    LIVRECORE_API ~CostCachePolicy();
+
+    /** @copydoc CachePolicy::insert */
+    LIVRECORE_API void insert(const CacheObject& cacheObject,
+                              float loadTime) final;
+
+    /** @copydoc CachePolicy::touch */
+    LIVRECORE_API void touch(const CacheId& cacheId) final;
+
+    /** @copydoc CachePolicy::remove */
+    LIVRECORE_API void remove(const CacheId& cacheId) final;
+
+    /** @copydoc CachePolicy::evict */
+    LIVRECORE_API void evict(const CacheId& cacheId) final;
+
+    /** @copydoc CachePolicy::clear */
+    LIVRECORE_API void clear() final;
+
+    /** @copydoc CachePolicy::getFirst */
+    LIVRECORE_API CacheId getFirst() const final;
+
+    /** @copydoc CachePolicy::getNext */
+    LIVRECORE_API CacheId getNext(const CacheId& cacheId) const final;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> _impl;
+};
+}
+
+#endif // _CostCachePolicy_h_
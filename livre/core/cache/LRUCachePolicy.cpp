@@ -0,0 +1,172 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/core/cache/CacheObject.h>
+#include <livre/core/cache/LRUCachePolicy.h>
+
+namespace livre
+{
+/**
+ * The recency order is a doubly-linked list whose links live in the hash index
+ * entries, so no operation depends on the number of cached objects.
+ */
+struct LRUCachePolicy::Impl
+{
+    Impl()
+        : _head(nullptr)
+        , _tail(nullptr)
+    {
+    }
+
+    void insert(const CacheId& cacheId)
+    {
+        Index::iterator it = _index.find(cacheId);
+        if (it == _index.end())
+            it = _index.emplace(cacheId, Entry(cacheId)).first;
+        else
+            unlink(it->second);
+        pushBack(it->second);
+    }
+
+    void touch(const CacheId& cacheId)
+    {
+        Index::iterator it = _index.find(cacheId);
+        if (it == _index.end() || &it->second == _tail)
+            return;
+
+        unlink(it->second);
+        pushBack(it->second);
+    }
+
+    void remove(const CacheId& cacheId)
+    {
+        Index::iterator it = _index.find(cacheId);
+        if (it == _index.end())
+            return;
+
+        unlink(it->second);
+        _index.erase(it);
+    }
+
+    void clear()
+    {
+        _index.clear();
+        _head = _tail = nullptr;
+    }
+
+    CacheId getFirst() const
+    {
+        return _head ? _head->cacheId : INVALID_CACHE_ID;
+    }
+
+    CacheId getNext(const CacheId& cacheId) const
+    {
+        Index::const_iterator it = _index.find(cacheId);
+        if (it == _index.end() || !it->second.next)
+            return INVALID_CACHE_ID;
+        return it->second.next->cacheId;
+    }
+
+    struct Entry
+    {
+        explicit Entry(const CacheId& cacheId_)
+            : cacheId(cacheId_)
+            , prev(nullptr)
+            , next(nullptr)
+        {
+        }
+
+        const CacheId cacheId;
+        Entry* prev;
+        Entry* next;
+    };
+
+    // Node based container, entry addresses are stable until erased
+    typedef std::unordered_map<CacheId, Entry> Index;
+
+    void unlink(Entry& entry)
+    {
+        if (entry.prev)
+            entry.prev->next = entry.next;
+        else
+            _head = entry.next;
+
+        if (entry.next)
+            entry.next->prev = entry.prev;
+        else
+            _tail = entry.prev;
+
+        entry.prev = entry.next = nullptr;
+    }
+
+    void pushBack(Entry& entry)
+    {
+        entry.prev = _tail;
+        entry.next = nullptr;
+        if (_tail)
+            _tail->next = &entry;
+        else
+            _head = &entry;
+        _tail = &entry;
+    }
+
+    Index _index;
+    Entry* _head; // least recently used
+    Entry* _tail; // most recently used
+};
+
+LRUCachePolicy::LRUCachePolicy()
+    : _impl(new LRUCachePolicy::Impl)
+{
+}
+
+LRUCachePolicy::~LRUCachePolicy()
+{
+}
+
+void LRUCachePolicy::insert(const CacheObject& cacheObject, float)
+{
+    _impl->insert(cacheObject.getId());
+}
+
+void LRUCachePolicy::touch(const CacheId& cacheId)
+{
+    _impl->touch(cacheId);
+}
+
+void LRUCachePolicy::remove(const CacheId& cacheId)
+{
+    _impl->remove(cacheId);
+}
+
+void LRUCachePolicy::clear()
+{
+    _impl->clear();
+}
+
+CacheId LRUCachePolicy::getFirst() const
+{
+    return _impl->getFirst();
+}
+
+CacheId LRUCachePolicy::getNext(const CacheId& cacheId) const
+{
+    return _impl->getNext(cacheId);
+}
+}
@@ -0,0 +1,63 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _LRUCachePolicy_h_
+#define _LRUCachePolicy_h_
+
+#include <livre/core/api.h>
+#include <livre/core/cache/CachePolicy.h> // base class
+
+namespace livre
+{
+/**
+ * The LRUCachePolicy class evicts the least recently used objects first.
+ * Insertion, touch on hit and removal are O(1).
+ */
+class LRUCachePolicy : public CachePolicy
+{
+public:
+    LIVRECORE_API LRUCachePolicy();
+    LIVRECORE_API ~LRUCachePolicy();
+
+    /** @copydoc CachePolicy::insert */
+    LIVRECORE_API void insert(const CacheObject& cacheObject,
+                              float loadTime) final;
+
+    /** @copydoc CachePolicy::touch */
+    LIVRECORE_API void touch(const CacheId& cacheId) final;
+
+    /** @copydoc CachePolicy::remove */
+    LIVRECORE_API void remove(const CacheId& cacheId) final;
+
+    /** @copydoc CachePolicy::clear */
+    LIVRECORE_API void clear() final;
+
+    /** @copydoc CachePolicy::getFirst */
+    LIVRECORE_API CacheId getFirst() const final;
+
+    /** @copydoc CachePolicy::getNext */
+    LIVRECORE_API CacheId getNext(const CacheId& cacheId) const final;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> _impl;
+};
+}
+
+#endif // _LRUCachePolicy_h_
@@ -0,0 +1,184 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/core/cache/CacheObject.h>
+#include <livre/core/cache/OctreeCachePolicy.h>
+#include <livre/data/NodeId.h>
+
+namespace livre
+{
+struct OctreeCachePolicy::Impl
+{
+    typedef std::list<CacheId> CacheIdList;
+
+    // Entries exist for cached nodes and for the ancestors of cached nodes
+    struct Entry
+    {
+        Entry()
+            : cached(false)
+            , descendants(0)
+            , isLeaf(false)
+        {
+        }
+
+        bool cached;
+        uint32_t descendants; // number of cached descendants
+        bool isLeaf;          // cached without cached descendants
+        CacheIdList::iterator position; // in the leaf list, if isLeaf
+    };
+
+    typedef std::unordered_map<CacheId, Entry> Index;
+
+    void insert(const CacheId& cacheId)
+    {
+        Entry& entry = _index[cacheId];
+        if (entry.cached)
+        {
+            touch(cacheId);
+            return;
+        }
+
+        entry.cached = true;
+        if (entry.descendants == 0)
+            addLeaf(cacheId, entry);
+
+        for (NodeId parent = NodeId(cacheId).getParent(); parent.isValid();
+             parent = parent.getParent())
+        {
+            Entry& parentEntry = _index[parent.getId()];
+            if (parentEntry.descendants++ == 0 && parentEntry.isLeaf)
+                removeLeaf(parentEntry);
+        }
+    }
+
+    void touch(const CacheId& cacheId)
+    {
+        Index::iterator it = _index.find(cacheId);
+        if (it == _index.end() || !it->second.isLeaf)
+            return;
+
+        _leaves.splice(_leaves.end(), _leaves, it->second.position);
+    }
+
+    void remove(const CacheId& cacheId)
+    {
+        Index::iterator it = _index.find(cacheId);
+        if (it == _index.end() || !it->second.cached)
+            return;
+
+        Entry& entry = it->second;
+        entry.cached = false;
+        if (entry.isLeaf)
+            removeLeaf(entry);
+        if (entry.descendants == 0)
+            _index.erase(it);
+
+        for (NodeId parent = NodeId(cacheId).getParent(); parent.isValid();
+             parent = parent.getParent())
+        {
+            Index::iterator parentIt = _index.find(parent.getId());
+            Entry& parentEntry = parentIt->second;
+            if (--parentEntry.descendants > 0)
+                continue;
+
+            if (parentEntry.cached)
+                addLeaf(parent.getId(), parentEntry);
+            else
+                _index.erase(parentIt);
+        }
+    }
+
+    void clear()
+    {
+        _leaves.clear();
+        _index.clear();
+    }
+
+    CacheId getFirst() const
+    {
+        return _leaves.empty() ? INVALID_CACHE_ID : _leaves.front();
+    }
+
+    CacheId getNext(const CacheId& cacheId) const
+    {
+        Index::const_iterator it = _index.find(cacheId);
+        if (it == _index.end() || !it->second.isLeaf)
+            return INVALID_CACHE_ID;
+
+        CacheIdList::const_iterator next = it->second.position;
+        if (++next == _leaves.end())
+            return INVALID_CACHE_ID;
+        return *next;
+    }
+
+    void addLeaf(const CacheId& cacheId, Entry& entry)
+    {
+        entry.isLeaf = true;
+        entry.position = _leaves.insert(_leaves.end(), cacheId);
+    }
+
+    void removeLeaf(Entry& entry)
+    {
+        entry.isLeaf = false;
+        _leaves.erase(entry.position);
+    }
+
+    CacheIdList _leaves; // least recently used first
+    Index _index;
+};
+
+OctreeCachePolicy::OctreeCachePolicy()
+    : _impl(new OctreeCachePolicy::Impl)
+{
+}
+
+OctreeCachePolicy::~OctreeCachePolicy()
+{
+}
+
+void OctreeCachePolicy::insert(const CacheObject& cacheObject, float)
+{
+    _impl->insert(cacheObject.getId());
+}
+
+void OctreeCachePolicy::touch(const CacheId& cacheId)
+{
+    _impl->touch(cacheId);
+}
+
+void OctreeCachePolicy::remove(const CacheId& cacheId)
+{
+    _impl->remove(cacheId);
+}
+
+void OctreeCachePolicy::clear()
+{
+    _impl->clear();
+}
+
+CacheId OctreeCachePolicy::getFirst() const
+{
+    return _impl->getFirst();
+}
+
+CacheId OctreeCachePolicy::getNext(const CacheId& cacheId) const
+{
+    return _impl->getNext(cacheId);
+}
+}
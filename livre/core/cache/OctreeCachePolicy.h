@@ -0,0 +1,69 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _OctreeCachePolicy_h_
+#define _OctreeCachePolicy_h_
+
+#include <livre/core/api.h>
+#include <livre/core/cache/CachePolicy.h> // base class
+
+namespace livre
+{
+/**
+ * The OctreeCachePolicy class keeps the hierarchy of the cached octree nodes
+ * consistent. The cache ids are interpreted as \see NodeId, and a node is only
+ * offered for eviction when none of its descendants is in the cache, i.e.
+ * leaves are evicted first, in least recently used order.
+ *
+ * This guarantees that the coarser fallback of every cached node stays
+ * available for rendering. If all leaves are referenced the cache may exceed
+ * its budget until they are released.
+ */
+class OctreeCachePolicy : public CachePolicy
+{
+public:
+    LIVRECORE_API OctreeCachePolicy();
+    LIVRECORE_API ~OctreeCachePolicy();
+
+    /** @copydoc CachePolicy::insert */
+    LIVRECORE_API void insert(const CacheObject& cacheObject,
+                              float loadTime) final;
+
+    /** @copydoc CachePolicy::touch */
+    LIVRECORE_API void touch(const CacheId& cacheId) final;
+
+    /** @copydoc CachePolicy::remove */
+    LIVRECORE_API void remove(const CacheId& cacheId) final;
+
+    /** @copydoc CachePolicy::clear */
+    LIVRECORE_API void clear() final;
+
+    /** @copydoc CachePolicy::getFirst */
+    LIVRECORE_API CacheId getFirst() const final;
+
+    /** @copydoc CachePolicy::getNext */
+    LIVRECORE_API CacheId getNext(const CacheId& cacheId) const final;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> _impl;
+};
+}
+
+#endif // _OctreeCachePolicy_h_
@@ -0,0 +1,439 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/core/cache/CacheObject.h>
+#include <livre/core/cache/ShardedCacheMap.h>
+
+#include <boost/thread/thread.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+namespace livre
+{
+namespace
+{
+const size_t nShards = 16;
+const size_t shardBits = 4;
+const size_t minCapacity = 16;
+const size_t accessLogSize = 256;
+const size_t cacheLineSize = 64;
+
+uint64_t mix(uint64_t value)
+{
+    // SplitMix64 finalizer, the node ids have most of their entropy in the
+    // middle bits
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+
+struct Node
+{
+    Node()
+        : cacheId(INVALID_CACHE_ID)
+    {
+    }
+
+    explicit Node(const ConstCacheObjectPtr& obj)
+        : cacheId(obj->getId())
+        , object(obj)
+    {
+    }
+
+    const CacheId cacheId;
+    const ConstCacheObjectPtr object;
+};
+
+typedef std::chrono::steady_clock::rep Time;
+
+Time now()
+{
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+// Hits are stamped with a monotonic clock instead of a global sequence number,
+// which would be contended; the stamps restore the order across the shards.
+struct Access
+{
+    std::atomic<CacheId> cacheId;
+    std::atomic<Time> time;
+};
+
+// Marks the removed slots, so the probe sequences stay intact
+Node tombstone;
+
+struct Table
+{
+    explicit Table(const size_t capacity_)
+        : capacity(capacity_)
+        , used(0)
+        , slots(new std::atomic<Node*>[capacity_])
+    {
+        for (size_t i = 0; i < capacity; ++i)
+            slots[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    const size_t capacity;
+    size_t used; // live and removed slots, modified by the writer only
+    std::unique_ptr<std::atomic<Node*>[]> slots;
+};
+
+struct Shard
+{
+    Shard()
+        : table(new Table(minCapacity))
+        , epoch(0)
+        , accessHead(0)
+        , accessTail(0)
+    {
+        readers[0] = 0;
+        readers[1] = 0;
+        for (size_t i = 0; i < accessLogSize; ++i)
+        {
+            accesses[i].cacheId.store(INVALID_CACHE_ID,
+                                      std::memory_order_relaxed);
+            accesses[i].time.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    ~Shard()
+    {
+        freeRetired();
+        Table* current = table.load();
+        for (size_t i = 0; i < current->capacity; ++i)
+        {
+            Node* node = current->slots[i].load();
+            if (node && node != &tombstone)
+                delete node;
+        }
+        delete current;
+    }
+
+    void freeRetired()
+    {
+        for (Node* node : retiredNodes)
+            delete node;
+        for (Table* retired : retiredTables)
+            delete retired;
+        retiredNodes.clear();
+        retiredTables.clear();
+    }
+
+    // Waits until all lookups which may have seen the retired entries are
+    // finished. Flipping the epoch lets new lookups use the other counter,
+    // so a steady stream of lookups cannot starve the writer.
+    void synchronize()
+    {
+        for (size_t i = 0; i < 2; ++i)
+        {
+            const size_t index = epoch.fetch_add(1) & 1;
+            while (readers[index].load() != 0)
+                boost::this_thread::yield();
+        }
+    }
+
+    std::atomic<Table*> table;
+    std::atomic<size_t> readers[2];
+    std::atomic<size_t> epoch;
+
+    Access accesses[accessLogSize];
+    std::atomic<size_t> accessHead;
+    size_t accessTail;
+
+    std::vector<Node*> retiredNodes;
+    std::vector<Table*> retiredTables;
+
+    // Keeps the shards on different cache lines
+    char padding[cacheLineSize];
+};
+}
+
+struct ShardedCacheMap::Impl
+{
+    Impl()
+        : _size(0)
+    {
+    }
+
+    static size_t getSlot(const uint64_t hash, const Table& table)
+    {
+        return hash & (table.capacity - 1);
+    }
+
+    Shard& getShard(const uint64_t hash) const
+    {
+        return _shards[hash >> (64 - shardBits)];
+    }
+
+    ConstCacheObjectPtr find(const CacheId& cacheId) const
+    {
+        const uint64_t hash = mix(cacheId);
+        Shard& shard = getShard(hash);
+
+        const size_t index = shard.epoch.load() & 1;
+        shard.readers[index].fetch_add(1);
+
+        ConstCacheObjectPtr obj;
+        const Table* table = shard.table.load();
+        for (size_t i = getSlot(hash, *table), probes = 0;
+             probes < table->capacity;
+             i = (i + 1) & (table->capacity - 1), ++probes)
+        {
+            const Node* node = table->slots[i].load();
+            if (!node)
+                break;
+            if (node->cacheId == cacheId && node != &tombstone)
+            {
+                obj = node->object;
+                break;
+            }
+        }
+
+        shard.readers[index].fetch_sub(1);
+
+        if (obj)
+        {
+            const size_t head =
+                shard.accessHead.fetch_add(1, std::memory_order_relaxed);
+            Access& access = shard.accesses[head % accessLogSize];
+            access.cacheId.store(cacheId, std::memory_order_relaxed);
+            access.time.store(now(), std::memory_order_relaxed);
+        }
+        return obj;
+    }
+
+    std::atomic<Node*>* findSlot(const CacheId& cacheId) const
+    {
+        const uint64_t hash = mix(cacheId);
+        const Table* table = getShard(hash).table.load();
+        for (size_t i = getSlot(hash, *table), probes = 0;
+             probes < table->capacity;
+             i = (i + 1) & (table->capacity - 1), ++probes)
+        {
+            Node* node = table->slots[i].load();
+            if (!node)
+                return nullptr;
+            if (node->cacheId == cacheId && node != &tombstone)
+                return &table->slots[i];
+        }
+        return nullptr;
+    }
+
+    const ConstCacheObjectPtr* lookup(const CacheId& cacheId) const
+    {
+        const std::atomic<Node*>* slot = findSlot(cacheId);
+        return slot ? &slot->load()->object : nullptr;
+    }
+
+    // Moves the live entries to a new table, which also drops the tombstones
+    void rehash(Shard& shard, const size_t count)
+    {
+        Table* table = shard.table.load();
+        size_t capacity = minCapacity;
+        while (capacity < count * 4)
+            capacity *= 2;
+
+        Table* newTable = new Table(capacity);
+        for (size_t i = 0; i < table->capacity; ++i)
+        {
+            Node* node = table->slots[i].load();
+            if (!node || node == &tombstone)
+                continue;
+
+            size_t slot = getSlot(mix(node->cacheId), *newTable);
+            while (newTable->slots[slot].load(std::memory_order_relaxed))
+                slot = (slot + 1) & (capacity - 1);
+            newTable->slots[slot].store(node, std::memory_order_relaxed);
+            ++newTable->used;
+        }
+
+        shard.table.store(newTable);
+        shard.retiredTables.push_back(table);
+    }
+
+    size_t getShardCount(const Table& table) const
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < table.capacity; ++i)
+        {
+            const Node* node = table.slots[i].load(std::memory_order_relaxed);
+            if (node && node != &tombstone)
+                ++count;
+        }
+        return count;
+    }
+
+    void insert(const ConstCacheObjectPtr& object)
+    {
+        const uint64_t hash = mix(object->getId());
+        Shard& shard = getShard(hash);
+
+        Table* table = shard.table.load();
+        if ((table->used + 1) * 2 > table->capacity)
+        {
+            rehash(shard, getShardCount(*table) + 1);
+            table = shard.table.load();
+        }
+
+        size_t slot = getSlot(hash, *table);
+        for (;;)
+        {
+            const Node* node = table->slots[slot].load();
+            if (!node || node == &tombstone)
+                break;
+            slot = (slot + 1) & (table->capacity - 1);
+        }
+
+        if (!table->slots[slot].load())
+            ++table->used;
+        table->slots[slot].store(new Node(object));
+        ++_size;
+    }
+
+    bool erase(const CacheId& cacheId)
+    {
+        std::atomic<Node*>* slot = findSlot(cacheId);
+        if (!slot)
+            return false;
+
+        Shard& shard = getShard(mix(cacheId));
+        shard.retiredNodes.push_back(slot->load());
+        slot->store(&tombstone);
+        --_size;
+        return true;
+    }
+
+    void clear()
+    {
+        for (Shard& shard : _shards)
+        {
+            Table* table = shard.table.load();
+            shard.table.store(new Table(minCapacity));
+            for (size_t i = 0; i < table->capacity; ++i)
+            {
+                Node* node = table->slots[i].load(std::memory_order_relaxed);
+                if (node && node != &tombstone)
+                    shard.retiredNodes.push_back(node);
+            }
+            shard.retiredTables.push_back(table);
+        }
+        _size = 0;
+    }
+
+    void reclaim()
+    {
+        for (Shard& shard : _shards)
+        {
+            if (shard.retiredNodes.empty() && shard.retiredTables.empty())
+                continue;
+
+            shard.synchronize();
+            shard.freeRetired();
+        }
+    }
+
+    void drainAccesses(const std::function<void(const CacheId&)>& visitor)
+    {
+        for (Shard& shard : _shards)
+        {
+            const size_t head = shard.accessHead.load();
+            if (head - shard.accessTail > accessLogSize)
+                shard.accessTail = head - accessLogSize;
+
+            for (; shard.accessTail != head; ++shard.accessTail)
+            {
+                // A lookup may not have written its entry yet, the log is
+                // lossy anyway
+                const Access& access =
+                    shard.accesses[shard.accessTail % accessLogSize];
+                const CacheId cacheId =
+                    access.cacheId.load(std::memory_order_relaxed);
+                if (cacheId != INVALID_CACHE_ID)
+                    _drained.emplace_back(
+                        access.time.load(std::memory_order_relaxed), cacheId);
+            }
+        }
+
+        std::stable_sort(_drained.begin(), _drained.end(),
+                         [](const std::pair<Time, CacheId>& a,
+                            const std::pair<Time, CacheId>& b) {
+                             return a.first < b.first;
+                         });
+        for (const auto& access : _drained)
+            visitor(access.second);
+        _drained.clear();
+    }
+
+    mutable Shard _shards[nShards];
+    std::atomic<size_t> _size;
+    std::vector<std::pair<Time, CacheId>> _drained;
+};
+
+ShardedCacheMap::ShardedCacheMap()
+    : _impl(new ShardedCacheMap::Impl())
+{
+}
+
+ShardedCacheMap::~ShardedCacheMap()
+{
+}
+
+ConstCacheObjectPtr ShardedCacheMap::find(const CacheId& cacheId) const
+{
+    return _impl->find(cacheId);
+}
+
+size_t ShardedCacheMap::getSize() const
+{
+    return _impl->_size;
+}
+
+const ConstCacheObjectPtr* ShardedCacheMap::lookup(const CacheId& cacheId) const
+{
+    return _impl->lookup(cacheId);
+}
+
+void ShardedCacheMap::insert(const ConstCacheObjectPtr& object)
+{
+    _impl->insert(object);
+}
+
+bool ShardedCacheMap::erase(const CacheId& cacheId)
+{
+    return _impl->erase(cacheId);
+}
+
+void ShardedCacheMap::clear()
+{
+    _impl->clear();
+}
+
+void ShardedCacheMap::reclaim()
+{
+    _impl->reclaim();
+}
+
+void ShardedCacheMap::drainAccesses(
+    const std::function<void(const CacheId&)>& visitor)
+{
+    _impl->drainAccesses(visitor);
+}
+}
@@ -0,0 +1,103 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _ShardedCacheMap_h_
+#define _ShardedCacheMap_h_
+
+#include <livre/core/api.h>
+#include <livre/core/types.h>
+
+namespace livre
+{
+/**
+ * The ShardedCacheMap class is the concurrent id to object map of the \see
+ * Cache.
+ *
+ * Lookups are lock-free: the ids are spread over shards of open addressing
+ * tables, and removed entries are only reclaimed once no lookup of the shard
+ * can still access them (a grace period tracked by two reader counters per
+ * shard). Successful lookups are recorded in a lossy per-shard access log, so
+ * the cache policy can be updated without taking a lock on the hit path.
+ *
+ * The modifying methods are not thread safe among themselves, the caller has to
+ * serialize them.
+ */
+class ShardedCacheMap
+{
+public:
+    LIVRECORE_API ShardedCacheMap();
+    LIVRECORE_API ~ShardedCacheMap();
+
+    /**
+     * Finds an object, lock-free and thread safe. A successful lookup is
+     * recorded in the access log.
+     * @param cacheId the id of the object.
+     * @return the object or an empty pointer if it is not in the map.
+     */
+    LIVRECORE_API ConstCacheObjectPtr find(const CacheId& cacheId) const;
+
+    /** @return the number of objects in the map, thread safe. */
+    LIVRECORE_API size_t getSize() const;
+
+    /**
+     * Finds an object without recording the access or changing its reference
+     * count. Must be serialized with the modifying methods.
+     * @param cacheId the id of the object.
+     * @return the object stored in the map or nullptr if it is not in the map.
+     */
+    LIVRECORE_API const ConstCacheObjectPtr* lookup(
+        const CacheId& cacheId) const;
+
+    /**
+     * Inserts an object.
+     * @param object the object, whose id must not be in the map.
+     */
+    LIVRECORE_API void insert(const ConstCacheObjectPtr& object);
+
+    /**
+     * Removes an object. The map keeps its reference until reclaim().
+     * @param cacheId the id of the object.
+     * @return false if the id was not in the map.
+     */
+    LIVRECORE_API bool erase(const CacheId& cacheId);
+
+    /** Removes all objects. The map keeps the references until reclaim(). */
+    LIVRECORE_API void clear();
+
+    /**
+     * Waits until no lookup can access the removed objects anymore and
+     * releases the references of the map to them.
+     */
+    LIVRECORE_API void reclaim();
+
+    /**
+     * Calls the given function for the recorded accesses since the last call,
+     * oldest first. Accesses are dropped if the log of a shard overflows.
+     * @param visitor the function called with the accessed ids.
+     */
+    LIVRECORE_API void drainAccesses(
+        const std::function<void(const CacheId&)>& visitor);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> _impl;
+};
+}
+
+#endif // _ShardedCacheMap_h_
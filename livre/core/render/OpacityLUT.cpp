@@ -0,0 +1,62 @@
+/* Copyright (c) 2017, EPFL/Blue Brain Project
+ *                     bbp-open-source@googlegroups.com
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "OpacityLUT.h"
+#include "TransferFunction1D.h"
+
+#include <cmath>
+
+namespace livre
+{
+OpacityLUT::OpacityLUT()
+{
+}
+
+OpacityLUT::OpacityLUT(const TransferFunction1D& transferFunction,
+                       const DataType dataType)
+    : _dataRange(transferFunction.getDataRange(dataType))
+{
+    // The alphas of the LUT, as the renderer uses them
+    const std::vector<Vector4ub> lut = transferFunction.getLUT();
+    _alphaSums.resize(lut.size() + 1, 0);
+    for (size_t i = 0; i < lut.size(); ++i)
+        _alphaSums[i + 1] = _alphaSums[i] + lut[i][3];
+}
+
+bool OpacityLUT::isTransparent(const Range& values) const
+{
+    const float width = _dataRange[1] - _dataRange[0];
+    if (_alphaSums.size() < 2 || !(width > 0.f) || !(values[0] <= values[1]))
+        return false;
+
+    // The renderer interpolates linearly between the entries of the LUT
+    const int64_t size = _alphaSums.size() - 1;
+    const auto getEntry = [&](const float value) {
+        const float entry =
+            (value - _dataRange[0]) / width * float(size) - 0.5f;
+        return int64_t(
+            std::floor(std::min(std::max(entry, -2.f), float(size + 1))));
+    };
+    const int64_t first =
+        std::min(std::max(getEntry(values[0]), int64_t(0)), size - 1);
+    const int64_t last =
+        std::min(std::max(getEntry(values[1]) + 1, int64_t(0)), size - 1);
+    return _alphaSums[last + 1] == _alphaSums[first];
+}
+}
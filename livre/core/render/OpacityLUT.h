@@ -0,0 +1,58 @@
+/* Copyright (c) 2017, EPFL/Blue Brain Project
+ *                     bbp-open-source@googlegroups.com
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#pragma once
+
+#include <livre/core/api.h>
+#include <livre/core/types.h>
+#include <livre/data/VolumeInformation.h> // DataType
+
+namespace livre
+{
+/**
+ * Tells in constant time whether ranges of values are fully transparent under
+ * a transfer function, from the prefix sums of the alphas of its LUT.
+ */
+class OpacityLUT
+{
+public:
+    /** Create a LUT under which no range is transparent. */
+    LIVRECORE_API OpacityLUT();
+
+    /**
+     * Create the LUT of a transfer function.
+     * @param transferFunction the transfer function.
+     * @param dataType the type of the values of the volume.
+     * @throw std::runtime_error if the data type is undefined.
+     */
+    LIVRECORE_API OpacityLUT(const TransferFunction1D& transferFunction,
+                             DataType dataType);
+
+    /**
+     * @param values a range of values of the volume.
+     * @return true if the values of the range, and the values interpolated
+     *         between them by the renderer, map to a zero alpha.
+     */
+    LIVRECORE_API bool isTransparent(const Range& values) const;
+
+private:
+    std::vector<uint32_t> _alphaSums; // of the entries before each index
+    Vector2f _dataRange;
+};
+}
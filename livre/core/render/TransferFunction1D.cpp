@@ -22,9 +22,20 @@
 #include "TransferFunction1D.h"
 
 #include <fstream>
+#include <limits>
 
 namespace livre
 {
+namespace
+{
+template <class T>
+Vector2f _getDataRange()
+{
+    return Vector2f(std::numeric_limits<T>::min(),
+                    std::numeric_limits<T>::max());
+}
+}
+
 TransferFunction1D::TransferFunction1D(const std::string& file)
     : TransferFunction1D()
 {
@@ -105,4 +116,32 @@ std::vector<Vector4ub> TransferFunction1D::getLUT() const
 
     return lut;
 }
+
+Vector2f TransferFunction1D::getDataRange(const DataType dataType) const
+{
+    const auto& range = getRange();
+    if (range[1] > 0 && range[1] - range[0] > 0)
+        return Vector2f(range[0], range[1]);
+
+    switch (dataType)
+    {
+    case DT_UINT8:
+        return _getDataRange<uint8_t>();
+    case DT_UINT16:
+        return _getDataRange<uint16_t>();
+    case DT_UINT32:
+        return _getDataRange<uint32_t>();
+    case DT_FLOAT:
+        return _getDataRange<float>();
+    case DT_INT8:
+        return _getDataRange<int8_t>();
+    case DT_INT16:
+        return _getDataRange<int16_t>();
+    case DT_INT32:
+        return _getDataRange<int32_t>();
+    case DT_UNDEFINED:
+        break;
+    }
+    LBTHROW(std::runtime_error("Undefined data type"));
+}
 }
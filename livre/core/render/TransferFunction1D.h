@@ -22,6 +22,7 @@
 
 #include <livre/core/api.h>
 #include <livre/core/types.h>
+#include <livre/data/VolumeInformation.h> // DataType
 
 #include <co/distributable.h>
 #include <lexis/render/materialLUT.h>
@@ -51,5 +52,14 @@ public:
 
     /** @return RGBA lookup table for direct in use in GL texture. */
     LIVRECORE_API std::vector<Vector4ub> getLUT() const;
+
+    /**
+     * @param dataType the type of the values of the volume.
+     * @return the values mapped to the first and last entry of the LUT, the
+     *         range of the material LUT if valid, otherwise the full range of
+     *         the data type.
+     * @throw std::runtime_error if the data type is undefined.
+     */
+    LIVRECORE_API Vector2f getDataRange(DataType dataType) const;
 };
 }
@@ -58,13 +58,16 @@
 namespace livre
 {
 class Cache;
+class CacheLease;
 class CacheObject;
+class CachePolicy;
 class CacheStatistics;
 using ClipPlanesDist = co::Distributable<::lexis::render::ClipPlanes>;
 class Configuration;
 class Frustum;
 class GLContext;
 class GLSLShaders;
+class OpacityLUT;
 using Histogram = co::Distributable<::lexis::render::Histogram>;
 class Parameter;
 class Renderer;
@@ -112,6 +115,7 @@ typedef std::shared_ptr<PortData> PortDataPtr;
 typedef std::shared_ptr<Executable> ExecutablePtr;
 
 typedef std::unique_ptr<Filter> FilterPtr;
+typedef std::unique_ptr<CachePolicy> CachePolicyPtr;
 
 /** Helper classes for shared_ptr objects */
 template <typename T>
@@ -0,0 +1,183 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/core/util/MemoryPressureMonitor.h>
+
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace livre
+{
+namespace
+{
+const std::string cgroupRoot = "/sys/fs/cgroup";
+const std::string systemPressureFile = "/proc/pressure/memory";
+const float highUsage = 0.9f;
+const float lowUsage = 0.8f;
+const float highPressure = 10.f; // %
+const float lowPressure = 1.f;   // %
+
+// The cgroup v2 entry of /proc/self/cgroup is "0::<path>"
+std::string findCgroupDirectory()
+{
+    std::ifstream file("/proc/self/cgroup");
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.compare(0, 3, "0::") == 0)
+            return cgroupRoot + line.substr(3);
+    }
+    LBTHROW(std::runtime_error("No cgroup v2 found for the process"));
+}
+
+bool exists(const std::string& filename)
+{
+    return std::ifstream(filename).good();
+}
+
+// Reads a single value file, "max" is returned as 0 for unlimited
+size_t readValue(const std::string& filename)
+{
+    std::ifstream file(filename);
+    std::string word;
+    if (!(file >> word) || word == "max")
+        return 0;
+    std::istringstream stream(word);
+    size_t value = 0;
+    stream >> value;
+    return value;
+}
+
+// Reads a value of a flat keyed file like memory.stat
+size_t readKey(const std::string& filename, const std::string& key)
+{
+    std::ifstream file(filename);
+    std::string name;
+    size_t value;
+    while (file >> name >> value)
+    {
+        if (name == key)
+            return value;
+    }
+    return 0;
+}
+
+// Reads avg10 of the "some avg10=0.00 avg60=0.00 avg300=0.00 total=0" line
+float readPressure(const std::string& filename)
+{
+    const std::string avg10 = "avg10=";
+    std::ifstream file(filename);
+    std::string type;
+    std::string value;
+    while (file >> type >> value)
+    {
+        if (type == "some" && value.compare(0, avg10.size(), avg10) == 0)
+        {
+            std::istringstream stream(value.substr(avg10.size()));
+            float pressure = 0.f;
+            stream >> pressure;
+            return pressure;
+        }
+        file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+    return 0.f;
+}
+}
+
+struct MemoryPressureMonitor::Impl
+{
+    explicit Impl(const std::string& cgroupDirectory)
+        : directory(cgroupDirectory == "auto" ? findCgroupDirectory()
+                                              : cgroupDirectory)
+    {
+    }
+
+    const std::string directory;
+};
+
+MemoryPressureMonitor::MemoryPressureMonitor(const std::string& cgroupDirectory)
+    : _impl(new Impl(cgroupDirectory))
+{
+}
+
+MemoryPressureMonitor::~MemoryPressureMonitor()
+{
+}
+
+const std::string& MemoryPressureMonitor::getCgroupDirectory() const
+{
+    return _impl->directory;
+}
+
+MemoryPressureMonitor::Sample MemoryPressureMonitor::sample() const
+{
+    // Inactive file pages are reclaimed before the limit is hit, they do not
+    // count as usage
+    const size_t current = readValue(_impl->directory + "/memory.current");
+    const size_t inactive =
+        readKey(_impl->directory + "/memory.stat", "inactive_file");
+
+    Sample sample;
+    sample.maxBytes = readValue(_impl->directory + "/memory.max");
+    sample.currentBytes = current > inactive ? current - inactive : 0;
+    const std::string pressureFile = _impl->directory + "/memory.pressure";
+    sample.pressure = readPressure(exists(pressureFile) ? pressureFile
+                                                        : systemPressureFile);
+    return sample;
+}
+
+size_t MemoryPressureMonitor::getBudget(const size_t budget,
+                                        const size_t minBudget,
+                                        const size_t maxBudget) const
+{
+    const Sample current = sample();
+    const size_t step = maxBudget / 10;
+
+    size_t shrink = 0;
+    const size_t highMark = size_t(current.maxBytes * highUsage);
+    if (current.maxBytes > 0 && current.currentBytes > highMark)
+        shrink = current.currentBytes - highMark;
+    if (current.pressure >= highPressure)
+        shrink = std::max(shrink, step);
+
+    size_t newBudget = budget;
+    if (shrink > 0)
+        newBudget = budget - std::min(budget, shrink);
+    else if (current.pressure < lowPressure &&
+             (current.maxBytes == 0 ||
+              current.currentBytes + step <
+                  size_t(current.maxBytes * lowUsage)))
+    {
+        newBudget = budget + step;
+    }
+    return std::min(std::max(newBudget, minBudget), maxBudget);
+}
+
+void MemoryPressureMonitor::releaseFreeMemory()
+{
+#ifdef __GLIBC__
+    ::malloc_trim(0);
+#endif
+}
+}
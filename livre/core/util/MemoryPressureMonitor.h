@@ -0,0 +1,89 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _MemoryPressureMonitor_h_
+#define _MemoryPressureMonitor_h_
+
+#include <livre/core/api.h>
+#include <livre/core/types.h>
+
+namespace livre
+{
+/**
+ * The MemoryPressureMonitor class adapts the memory budget of the caches to
+ * the memory limit of the cgroup of the process and to the memory pressure.
+ *
+ * It reads memory.max, memory.current and memory.stat of a cgroup v2
+ * directory, and the "some" pressure stall information of memory.pressure in
+ * the same directory or else of /proc/pressure/memory. The budget shrinks
+ * when the cgroup gets close to its limit or when tasks stall on memory, and
+ * grows back when there is room again.
+ */
+class MemoryPressureMonitor
+{
+public:
+    /** A reading of the memory state */
+    struct Sample
+    {
+        size_t maxBytes;     //!< Limit of the cgroup, 0 if unlimited
+        size_t currentBytes; //!< Usage of the cgroup without inactive files
+        float pressure;      //!< % of time stalled on memory over 10 seconds
+    };
+
+    /**
+     * @param cgroupDirectory the cgroup v2 directory, e.g. a fake one for
+     * testing, or "auto" for the cgroup of the process.
+     * @throw std::runtime_error if the cgroup of the process is not found.
+     */
+    LIVRECORE_API explicit MemoryPressureMonitor(
+        const std::string& cgroupDirectory);
+    LIVRECORE_API ~MemoryPressureMonitor();
+
+    /** @return the cgroup v2 directory which is monitored. */
+    LIVRECORE_API const std::string& getCgroupDirectory() const;
+
+    /** @return the current memory state. */
+    LIVRECORE_API Sample sample() const;
+
+    /**
+     * Computes the cache budget for the current memory state. The budget
+     * shrinks by the memory used above 90% of the limit, and at least by a
+     * tenth of maxBudget under pressure. It grows by a tenth of maxBudget
+     * while the usage stays below 80% of the limit without pressure.
+     * @param budget the current budget of the caches.
+     * @param minBudget the minimum budget.
+     * @param maxBudget the maximum budget.
+     * @return the new budget.
+     */
+    LIVRECORE_API size_t getBudget(size_t budget, size_t minBudget,
+                                   size_t maxBudget) const;
+
+    /** Returns the memory freed by the caches to the operating system. */
+    LIVRECORE_API static void releaseFreeMemory();
+
+private:
+    MemoryPressureMonitor(const MemoryPressureMonitor&) = delete;
+    MemoryPressureMonitor& operator=(const MemoryPressureMonitor&) = delete;
+
+    struct Impl;
+    std::unique_ptr<Impl> _impl;
+};
+}
+
+#endif // _MemoryPressureMonitor_h_
@@ -0,0 +1,633 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/data/BrickedDataSource.h>
+#include <livre/data/Compression.h>
+#include <livre/data/LODNode.h>
+#include <livre/data/MemoryUnit.h>
+#include <livre/data/ValueRange.h>
+
+#include <lunchbox/memoryMap.h>
+#include <lunchbox/pluginRegisterer.h>
+
+#include <boost/algorithm/string.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace livre
+{
+namespace
+{
+lunchbox::PluginRegisterer<BrickedDataSource> registerer;
+
+const char formatMagic[8] = {'L', 'I', 'V', 'R', 'E', 'L', 'V', 'B'};
+const uint32_t formatVersion = 1;
+const uint32_t byteOrderMark = 0x01020304;
+const uint64_t pageSize = 4096;
+
+// The file header, the brick table follows at tableOffset
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t dataType;
+    uint32_t compCount;
+    uint32_t bigEndian;
+    uint32_t depth;
+    uint32_t voxels[3];
+    uint32_t overlap[3];
+    uint32_t maximumBlockSize[3];
+    uint32_t rootBlocks[3];
+    uint32_t frameRange[2];
+    float worldSize[3];
+    float worldSpacePerVoxel;
+    float resolution[3];
+    float meterToDataUnitRatio;
+    float dataToLivreTransform[16];
+    uint64_t brickCount;
+    uint64_t tableOffset;
+    uint64_t descriptionOffset;
+    uint64_t descriptionSize;
+};
+static_assert(sizeof(Header) == 216, "Header layout changed");
+
+// A brick is compressed if its size is smaller than its raw size, an
+// unwritten brick has a size of 0. The value range is the one of the subtree
+// of the brick, UNKNOWN_VALUE_RANGE if the subtree has unwritten bricks.
+struct BrickEntry
+{
+    uint64_t offset;
+    uint32_t size;
+    uint32_t rawSize;
+    float minValue;
+    float maxValue;
+};
+static_assert(sizeof(BrickEntry) == 24, "BrickEntry layout changed");
+
+uint64_t roundUp(const uint64_t size, const uint64_t alignment)
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+Header makeHeader(const VolumeInformation& info)
+{
+    Header header;
+    ::memset(&header, 0, sizeof(Header));
+    ::memcpy(header.magic, formatMagic, sizeof(formatMagic));
+    header.version = formatVersion;
+    header.byteOrder = byteOrderMark;
+    header.dataType = info.dataType;
+    header.compCount = info.compCount;
+    header.bigEndian = info.bigEndian;
+    header.depth = info.rootNode.getDepth();
+    for (size_t i = 0; i < 3; ++i)
+    {
+        header.voxels[i] = info.voxels[i];
+        header.overlap[i] = info.overlap[i];
+        header.maximumBlockSize[i] = info.maximumBlockSize[i];
+        header.rootBlocks[i] = info.rootNode.getBlockSize()[i];
+        header.worldSize[i] = info.worldSize[i];
+        header.resolution[i] = info.resolution[i];
+    }
+
+    // Volumes without frames are stored as one frame
+    if (info.frameRange[1] > info.frameRange[0])
+    {
+        header.frameRange[0] = info.frameRange[0];
+        header.frameRange[1] = info.frameRange[1];
+    }
+    else
+        header.frameRange[1] = 1;
+
+    header.worldSpacePerVoxel = info.worldSpacePerVoxel;
+    header.meterToDataUnitRatio = info.meterToDataUnitRatio;
+    for (size_t i = 0; i < 16; ++i)
+        header.dataToLivreTransform[i] = info.dataToLivreTransform.array[i];
+    return header;
+}
+
+void fillVolumeInfo(const Header& header, VolumeInformation& info)
+{
+    info.dataType = DataType(header.dataType);
+    info.compCount = header.compCount;
+    info.bigEndian = header.bigEndian;
+    for (size_t i = 0; i < 3; ++i)
+    {
+        info.voxels[i] = header.voxels[i];
+        info.overlap[i] = header.overlap[i];
+        info.maximumBlockSize[i] = header.maximumBlockSize[i];
+        info.worldSize[i] = header.worldSize[i];
+        info.resolution[i] = header.resolution[i];
+    }
+    info.rootNode =
+        RootNode(header.depth, Vector3ui(header.rootBlocks[0],
+                                         header.rootBlocks[1],
+                                         header.rootBlocks[2]));
+    info.frameRange = Vector2ui(header.frameRange[0], header.frameRange[1]);
+    info.worldSpacePerVoxel = header.worldSpacePerVoxel;
+    info.meterToDataUnitRatio = header.meterToDataUnitRatio;
+    for (size_t i = 0; i < 16; ++i)
+        info.dataToLivreTransform.array[i] = header.dataToLivreTransform[i];
+}
+}
+
+struct BrickedDataSource::Impl
+{
+    Impl(const DataSourcePluginData& initData, VolumeInformation& volumeInfo)
+        : _volumeInfo(volumeInfo)
+        , _filename(initData.getURI().getPath())
+        , _writing(initData.getAccessMode() == MODE_WRITE)
+        , _compress(false)
+        , _bricksPerFrame(0)
+        , _table(nullptr)
+        , _writeOffset(0)
+    {
+        ::memset(&_header, 0, sizeof(Header));
+        const servus::URI& uri = initData.getURI();
+        const auto compress = uri.findQuery("compress");
+        _compress = compress != uri.queryEnd() && compress->second != "0" &&
+                    compress->second != "false";
+
+        // A written file gets its layout from setVolumeInfo()
+        if (!_writing)
+            open();
+    }
+
+    ~Impl()
+    {
+        if (!_file.is_open())
+            return;
+        try
+        {
+            finish();
+        }
+        catch (const std::runtime_error& error)
+        {
+            LBERROR << error.what() << std::endl;
+        }
+    }
+
+    void open()
+    {
+        if (!_mmap.map(_filename))
+            LBTHROW(std::runtime_error("Cannot mmap file " + _filename));
+
+        const uint8_t* base = _mmap.getAddress<uint8_t>();
+        const size_t fileSize = _mmap.getSize();
+        if (fileSize < sizeof(Header))
+            LBTHROW(std::runtime_error("Not a Livre volume: " + _filename));
+
+        ::memcpy(&_header, base, sizeof(Header));
+        if (::memcmp(_header.magic, formatMagic, sizeof(formatMagic)) != 0 ||
+            _header.byteOrder != byteOrderMark)
+        {
+            LBTHROW(std::runtime_error("Not a Livre volume: " + _filename));
+        }
+        if (_header.version != formatVersion)
+            LBTHROW(std::runtime_error("Unsupported Livre volume version " +
+                                       std::to_string(_header.version)));
+
+        setupLayout();
+        if (_header.brickCount != getBrickCount() ||
+            getBrickCount() > fileSize / sizeof(BrickEntry) ||
+            _header.tableOffset % sizeof(uint64_t) != 0 ||
+            _header.tableOffset + getBrickCount() * sizeof(BrickEntry) >
+                fileSize ||
+            _header.descriptionOffset + _header.descriptionSize > fileSize)
+        {
+            LBTHROW(std::runtime_error("Corrupted Livre volume: " + _filename));
+        }
+
+        _table =
+            reinterpret_cast<const BrickEntry*>(base + _header.tableOffset);
+        fillVolumeInfo(_header, _volumeInfo);
+        _volumeInfo.description =
+            std::string(reinterpret_cast<const char*>(base) +
+                            _header.descriptionOffset,
+                        _header.descriptionSize);
+    }
+
+    // The range of a subtree unites the ranges of its bricks, from the finest
+    // level up. Unwritten bricks make the ranges of their ancestors unknown.
+    void uniteSubtreeRanges()
+    {
+        const Vector3ui rootBlocks(_header.rootBlocks[0],
+                                   _header.rootBlocks[1],
+                                   _header.rootBlocks[2]);
+        for (uint64_t offset = 0; offset < getBrickCount();
+             offset += _bricksPerFrame)
+        {
+            for (uint32_t level = _header.depth; level-- > 0;)
+            {
+                const Vector3ui blocks = rootBlocks * (1u << level);
+                const bool hasChildren = level + 1 < _header.depth;
+                const uint64_t childOffset =
+                    hasChildren ? offset + _levelOffsets[level + 1] : 0;
+                uint64_t index = offset + _levelOffsets[level];
+                for (uint32_t z = 0; z < blocks.z(); ++z)
+                    for (uint32_t y = 0; y < blocks.y(); ++y)
+                        for (uint32_t x = 0; x < blocks.x(); ++x, ++index)
+                        {
+                            BrickEntry& entry = _entries[index];
+                            Range range = entry.size == 0
+                                              ? UNKNOWN_VALUE_RANGE
+                                              : getRange(entry);
+                            if (hasChildren)
+                                range = uniteChildRanges(range, childOffset,
+                                                         blocks * 2,
+                                                         Vector3ui(x, y, z) *
+                                                             2);
+                            entry.minValue = range[0];
+                            entry.maxValue = range[1];
+                        }
+            }
+        }
+    }
+
+    Range uniteChildRanges(Range range, const uint64_t levelOffset,
+                           const Vector3ui& blocks,
+                           const Vector3ui& position) const
+    {
+        for (uint32_t z = position.z(); z < position.z() + 2; ++z)
+            for (uint32_t y = position.y(); y < position.y() + 2; ++y)
+                for (uint32_t x = position.x(); x < position.x() + 2; ++x)
+                {
+                    const uint64_t child =
+                        levelOffset +
+                        (uint64_t(z) * blocks.y() + y) * blocks.x() + x;
+                    range = uniteValueRanges(range, getRange(_entries[child]));
+                }
+        return range;
+    }
+
+    static Range getRange(const BrickEntry& entry)
+    {
+        return Range{{entry.minValue, entry.maxValue}};
+    }
+
+    bool getValueRange(const LODNode& node, Range& range) const
+    {
+        if (_writing)
+            return false;
+
+        const uint64_t index = getIndex(node.getNodeId());
+        if (index >= getBrickCount() || isUnknown(getRange(_table[index])))
+            return false;
+
+        range = getRange(_table[index]);
+        return true;
+    }
+
+    // The table holds the bricks of each frame, by level and position
+    void setupLayout()
+    {
+        const Vector3ui rootBlocks(_header.rootBlocks[0],
+                                   _header.rootBlocks[1],
+                                   _header.rootBlocks[2]);
+        if (_header.depth == 0 || _header.depth >= INVALID_LEVEL ||
+            rootBlocks.product() == 0 ||
+            (uint64_t(rootBlocks.find_max()) << (_header.depth - 1)) >
+                (1u << NODEID_BLOCK_BITS) ||
+            _header.frameRange[1] <= _header.frameRange[0] ||
+            _header.frameRange[1] >= INVALID_TIMESTEP)
+        {
+            LBTHROW(std::runtime_error("Invalid Livre volume layout"));
+        }
+
+        _levelOffsets.clear();
+        _bricksPerFrame = 0;
+        for (uint32_t level = 0; level < _header.depth; ++level)
+        {
+            _levelOffsets.push_back(_bricksPerFrame);
+            _bricksPerFrame += (uint64_t(rootBlocks.x()) << level) *
+                               (uint64_t(rootBlocks.y()) << level) *
+                               (uint64_t(rootBlocks.z()) << level);
+        }
+    }
+
+    uint64_t getBrickCount() const
+    {
+        return _bricksPerFrame *
+               (_header.frameRange[1] - _header.frameRange[0]);
+    }
+
+    // @return the index in the brick table, or the brick count if the node
+    // is outside of the volume
+    uint64_t getIndex(const NodeId& nodeId) const
+    {
+        const uint32_t level = nodeId.getLevel();
+        const uint32_t frame = nodeId.getTimeStep();
+        if (level >= _header.depth || frame < _header.frameRange[0] ||
+            frame >= _header.frameRange[1])
+        {
+            return getBrickCount();
+        }
+
+        const uint32_t scale = 1u << level;
+        const Vector3ui blocks(_header.rootBlocks[0] * scale,
+                               _header.rootBlocks[1] * scale,
+                               _header.rootBlocks[2] * scale);
+        const Vector3ui position = nodeId.getPosition();
+        if (position.x() >= blocks.x() || position.y() >= blocks.y() ||
+            position.z() >= blocks.z())
+        {
+            return getBrickCount();
+        }
+
+        return (frame - _header.frameRange[0]) * _bricksPerFrame +
+               _levelOffsets[level] +
+               (uint64_t(position.z()) * blocks.y() + position.y()) *
+                   blocks.x() +
+               position.x();
+    }
+
+    MemoryUnitPtr getData(const LODNode& node) const
+    {
+        if (_writing)
+            LBTHROW(std::runtime_error("Livre volume is opened for writing"));
+
+        const uint64_t index = getIndex(node.getNodeId());
+        if (index >= getBrickCount() || _table[index].size == 0)
+            return MemoryUnitPtr();
+
+        const BrickEntry& entry = _table[index];
+        if (entry.offset + entry.size > _mmap.getSize() ||
+            entry.size > entry.rawSize)
+        {
+            LBTHROW(std::runtime_error("Corrupted Livre volume: " + _filename));
+        }
+
+        // The brick is copied, so its pages are not touched in the texture
+        // upload
+        const uint8_t* data = _mmap.getAddress<uint8_t>() + entry.offset;
+        if (entry.size == entry.rawSize)
+            return MemoryUnitPtr(new PooledMemoryUnit(data, entry.size));
+
+        MemoryUnitPtr brick(new PooledMemoryUnit(entry.rawSize));
+        if (!decompress(data, entry.size, brick->getData<uint8_t>(),
+                        entry.rawSize))
+        {
+            LBTHROW(std::runtime_error("Corrupted brick in Livre volume: " +
+                                       _filename));
+        }
+        return brick;
+    }
+
+    // Sorts the nodes by their file offset and asks the kernel to read the
+    // coalesced ranges of the bricks ahead, so the bricks are read with few
+    // large sequential reads
+    void prefetch(LODNodes& nodes) const
+    {
+        if (_writing)
+            return;
+
+        const uint64_t count = getBrickCount();
+        const auto getOffset = [&](const LODNode& node) {
+            const uint64_t index = getIndex(node.getNodeId());
+            return index < count ? _table[index].offset : 0;
+        };
+        std::sort(nodes.begin(), nodes.end(),
+                  [&](const LODNode& a, const LODNode& b) {
+                      return getOffset(a) < getOffset(b);
+                  });
+
+#ifndef _WIN32
+        const uint64_t pageSize = ::sysconf(_SC_PAGESIZE);
+        uint64_t begin = 0;
+        uint64_t end = 0;
+        for (const LODNode& node : nodes)
+        {
+            const uint64_t index = getIndex(node.getNodeId());
+            if (index >= count || _table[index].size == 0)
+                continue;
+
+            const BrickEntry& entry = _table[index];
+            if (entry.offset + entry.size > _mmap.getSize())
+                continue;
+
+            // Bricks less than a page apart share the read
+            if (end > begin && entry.offset <= end + pageSize)
+            {
+                end = std::max(end, entry.offset + entry.size);
+                continue;
+            }
+            willNeed(begin, end);
+            begin = entry.offset;
+            end = entry.offset + entry.size;
+        }
+        willNeed(begin, end);
+#endif
+    }
+
+#ifndef _WIN32
+    void willNeed(uint64_t begin, const uint64_t end) const
+    {
+        if (end <= begin)
+            return;
+
+        const uint64_t pageSize = ::sysconf(_SC_PAGESIZE);
+        begin -= begin % pageSize;
+        uint8_t* address = const_cast<uint8_t*>(_mmap.getAddress<uint8_t>());
+        ::posix_madvise(address + begin, end - begin, POSIX_MADV_WILLNEED);
+    }
+#endif
+
+    void setVolumeInfo(const VolumeInformation& volumeInfo)
+    {
+        if (!_writing)
+            LBTHROW(std::runtime_error("Data source is read-only"));
+        if (_header.brickCount > 0)
+            LBTHROW(std::runtime_error("Volume information is already set"));
+
+        _header = makeHeader(volumeInfo);
+        setupLayout();
+        _header.brickCount = getBrickCount();
+        _header.tableOffset = pageSize;
+        _entries.assign(getBrickCount(), BrickEntry{0, 0, 0, 0.f, 0.f});
+        _writeOffset = roundUp(_header.tableOffset +
+                                   getBrickCount() * sizeof(BrickEntry),
+                               pageSize);
+
+        _file.open(_filename, std::ios::binary | std::ios::trunc);
+        if (!_file)
+            LBTHROW(std::runtime_error("Cannot create " + _filename));
+
+        _volumeInfo = volumeInfo;
+        _volumeInfo.frameRange =
+            Vector2ui(_header.frameRange[0], _header.frameRange[1]);
+    }
+
+    void setData(const LODNode& node, const MemoryUnit& data)
+    {
+        checkWritable();
+
+        const uint64_t index = getIndex(node.getNodeId());
+        if (index >= getBrickCount())
+            LBTHROW(std::runtime_error("Node is outside of the volume"));
+
+        const size_t rawSize = data.getAllocSize();
+        if (rawSize > std::numeric_limits<uint32_t>::max())
+            LBTHROW(std::runtime_error("Brick is too large"));
+
+        const uint8_t* ptr = data.getData<uint8_t>();
+        const Range range =
+            computeValueRange(_volumeInfo.dataType, ptr, rawSize);
+        BrickEntry entry = {_writeOffset, uint32_t(rawSize), uint32_t(rawSize),
+                            range[0], range[1]};
+
+        // Incompressible bricks are stored as they are
+        std::vector<uint8_t> compressed;
+        if (_compress)
+        {
+            compressed = livre::compress(ptr, rawSize,
+                                         _volumeInfo.getBytesPerVoxel());
+            if (compressed.size() < rawSize)
+            {
+                ptr = compressed.data();
+                entry.size = uint32_t(compressed.size());
+            }
+        }
+
+        _file.seekp(_writeOffset);
+        _file.write(reinterpret_cast<const char*>(ptr), entry.size);
+        if (!_file)
+            LBTHROW(std::runtime_error("Cannot write " + _filename));
+
+        _entries[index] = entry;
+        _writeOffset = roundUp(_writeOffset + entry.size, pageSize);
+    }
+
+    void checkWritable() const
+    {
+        if (!_writing)
+            LBTHROW(std::runtime_error("Data source is read-only"));
+        if (_header.brickCount == 0)
+            LBTHROW(std::runtime_error("Volume information is not set"));
+        if (!_file.is_open())
+            LBTHROW(std::runtime_error("File is already finished"));
+    }
+
+    // The header is written last, an unfinished file is not valid
+    void finish()
+    {
+        checkWritable();
+        const std::string& description = _volumeInfo.description;
+        _header.descriptionOffset = _writeOffset;
+        _header.descriptionSize = description.size();
+        uniteSubtreeRanges();
+
+        _file.seekp(_header.descriptionOffset);
+        _file.write(description.data(), description.size());
+        _file.seekp(_header.tableOffset);
+        _file.write(reinterpret_cast<const char*>(_entries.data()),
+                    _entries.size() * sizeof(BrickEntry));
+        _file.seekp(0);
+        _file.write(reinterpret_cast<const char*>(&_header), sizeof(Header));
+        _file.close();
+        if (!_file)
+            LBTHROW(std::runtime_error("Cannot write " + _filename));
+    }
+
+    VolumeInformation& _volumeInfo;
+    const std::string _filename;
+    const bool _writing;
+    bool _compress;
+
+    Header _header;
+    std::vector<uint64_t> _levelOffsets; // in the table of a frame
+    uint64_t _bricksPerFrame;
+
+    lunchbox::MemoryMap _mmap;
+    const BrickEntry* _table;
+
+    std::ofstream _file;
+    std::vector<BrickEntry> _entries;
+    uint64_t _writeOffset;
+};
+
+BrickedDataSource::BrickedDataSource(const DataSourcePluginData& initData)
+    : _impl(new Impl(initData, _volumeInfo))
+{
+}
+
+BrickedDataSource::~BrickedDataSource()
+{
+}
+
+MemoryUnitPtr BrickedDataSource::getData(const LODNode& node)
+{
+    return _impl->getData(node);
+}
+
+std::future<void> BrickedDataSource::getDataAsync(const LODNodes& nodes,
+                                                  const DataCallback& callback)
+{
+    LODNodes sorted(nodes);
+    _impl->prefetch(sorted);
+    return getDataParallel(sorted, callback);
+}
+
+bool BrickedDataSource::getValueRange(const LODNode& node, Range& range) const
+{
+    return _impl->getValueRange(node, range);
+}
+
+void BrickedDataSource::setVolumeInfo(const VolumeInformation& volumeInfo)
+{
+    _impl->setVolumeInfo(volumeInfo);
+}
+
+void BrickedDataSource::setData(const LODNode& node, const MemoryUnit& data)
+{
+    _impl->setData(node, data);
+}
+
+void BrickedDataSource::finish()
+{
+    _impl->finish();
+}
+
+bool BrickedDataSource::handles(const DataSourcePluginData& initData)
+{
+    const servus::URI& uri = initData.getURI();
+    if (uri.getScheme() == "lvb")
+        return true;
+
+    if (!uri.getScheme().empty())
+        return false;
+
+    return boost::algorithm::ends_with(uri.getPath(), ".lvb");
+}
+
+std::string BrickedDataSource::getDescription()
+{
+    return R"(Livre bricked volume: [lvb://]/filename.lvb(?compress=1)
+  with the compress query parameter to compress the bricks of a written
+  volume. Volumes are converted with livreConvert.)";
+}
+}
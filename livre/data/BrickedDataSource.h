@@ -0,0 +1,101 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _BrickedDataSource_h_
+#define _BrickedDataSource_h_
+
+#include <livre/data/DataSourcePlugin.h>
+
+#include <livre/data/types.h>
+
+namespace livre
+{
+/**
+ * Data source for the Livre bricked volume format (*.lvb).
+ *
+ * The file holds all levels of detail of a volume as bricks with overlap:
+ * - a header with the volume information,
+ * - a flat table with one entry per brick, indexed by level, position and
+ *   time step of the NodeId, with the offset and size of the brick and the
+ *   value range of its subtree,
+ * - the bricks, page aligned and optionally compressed,
+ * - the description of the volume.
+ * Opening a file only maps it and reads the header; a brick is found without
+ * any search.
+ *
+ * With MODE_WRITE, a new file is written: setVolumeInfo() defines the layout,
+ * setData() appends the bricks and finish() writes the table and the
+ * header, which the destructor does if finish() was not called. The
+ * "compress" query parameter compresses the bricks where that saves space.
+ */
+class BrickedDataSource : public DataSourcePlugin
+{
+public:
+    /**
+     * @throw std::runtime_error if the file cannot be opened or is invalid.
+     */
+    BrickedDataSource(const DataSourcePluginData& initData);
+
+    /** Finishes a written file, if finish() was not called. */
+    ~BrickedDataSource();
+
+    /**
+     * Read the data for a given node.
+     * @param node LODNode to be read.
+     * @return The block data for the node, or an empty pointer if the brick
+     *         was not written.
+     */
+    MemoryUnitPtr getData(const LODNode& node) final;
+
+    /**
+     * @copydoc DataSourcePlugin::getDataAsync()
+     *
+     * The bricks are read in the order of the file from several threads, and
+     * the kernel is asked to read their coalesced ranges ahead.
+     */
+    std::future<void> getDataAsync(const LODNodes& nodes,
+                                   const DataCallback& callback) final;
+
+    /**
+     * @copydoc DataSourcePlugin::getValueRange()
+     *
+     * The ranges of the subtrees are computed when the file is finished and
+     * stored in its table, they are not known while writing.
+     */
+    bool getValueRange(const LODNode& node, Range& range) const final;
+
+    /** @copydoc DataSourcePlugin::setVolumeInfo() */
+    void setVolumeInfo(const VolumeInformation& volumeInfo) final;
+
+    /** @copydoc DataSourcePlugin::setData() */
+    void setData(const LODNode& node, const MemoryUnit& data) final;
+
+    /** @copydoc DataSourcePlugin::finish() */
+    void finish() final;
+
+    static bool handles(const DataSourcePluginData& initData);
+    static std::string getDescription();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> _impl;
+};
+}
+
+#endif // _BrickedDataSource_h_
@@ -0,0 +1,251 @@
+/* Copyright (c) 2017, EPFL/Blue Brain Project
+ *                     bbp-open-source@googlegroups.com
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/data/Compression.h>
+
+#include <lunchbox/perThread.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace livre
+{
+namespace
+{
+// Sequences are laid out as in LZ4: a token holding the literal count and the
+// match length in its high and low nibbles, the literal count extension, the
+// literals, the 16 bit match offset and the match length extension. The last
+// sequence only has literals.
+const size_t minMatch = 4;
+const size_t maxOffset = 65535;
+const size_t hashBits = 12;
+const size_t maxNibble = 15;
+
+// Buffers reused by the calling thread, so bricks do not allocate their size
+// in temporaries on every call
+struct Scratch
+{
+    std::vector<size_t> table;     // match positions of compressBlock()
+    std::vector<uint8_t> shuffled; // element bytes grouped by significance
+    std::vector<uint8_t> out;      // output of compress()
+};
+lunchbox::PerThread<Scratch> _scratch;
+
+Scratch& getScratch()
+{
+    Scratch* scratch = _scratch.get();
+    if (!scratch)
+    {
+        scratch = new Scratch;
+        _scratch = scratch;
+    }
+    return *scratch;
+}
+
+uint32_t read32(const uint8_t* ptr)
+{
+    uint32_t value;
+    std::memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+uint32_t hash(const uint32_t value)
+{
+    return (value * 2654435761u) >> (32 - hashBits);
+}
+
+void writeLength(std::vector<uint8_t>& out, size_t length)
+{
+    for (length -= maxNibble; length >= 255; length -= 255)
+        out.push_back(255);
+    out.push_back(uint8_t(length));
+}
+
+bool readLength(const uint8_t*& ptr, const uint8_t* end, size_t& length)
+{
+    uint8_t byte;
+    do
+    {
+        if (ptr == end)
+            return false;
+        byte = *ptr++;
+        length += byte;
+    }
+    while (byte == 255);
+    return true;
+}
+
+void writeSequence(std::vector<uint8_t>& out, const uint8_t* literals,
+                   const size_t nLiterals, const size_t offset,
+                   const size_t matchLength)
+{
+    const size_t tokenPos = out.size();
+    out.push_back(uint8_t(std::min(nLiterals, maxNibble) << 4));
+    if (nLiterals >= maxNibble)
+        writeLength(out, nLiterals);
+    out.insert(out.end(), literals, literals + nLiterals);
+
+    if (matchLength == 0)
+        return;
+
+    out.push_back(uint8_t(offset & 0xff));
+    out.push_back(uint8_t(offset >> 8));
+    const size_t length = matchLength - minMatch;
+    out[tokenPos] |= uint8_t(std::min(length, maxNibble));
+    if (length >= maxNibble)
+        writeLength(out, length);
+}
+
+void compressBlock(const uint8_t* in, const size_t size,
+                   std::vector<uint8_t>& out, std::vector<size_t>& table)
+{
+    // Positions are stored off by one, zero marks an empty slot
+    table.assign(1u << hashBits, 0);
+    size_t anchor = 0;
+    size_t pos = 0;
+    while (pos + minMatch <= size)
+    {
+        const uint32_t value = read32(in + pos);
+        size_t& slot = table[hash(value)];
+        const size_t candidate = slot;
+        slot = pos + 1;
+
+        if (candidate == 0 || pos + 1 - candidate > maxOffset ||
+            read32(in + candidate - 1) != value)
+        {
+            // Skip faster through incompressible data
+            pos += 1 + ((pos - anchor) >> 6);
+            continue;
+        }
+
+        const size_t match = candidate - 1;
+        size_t length = minMatch;
+        while (pos + length < size && in[match + length] == in[pos + length])
+            ++length;
+
+        writeSequence(out, in + anchor, pos - anchor, pos - match, length);
+        pos += length;
+        anchor = pos;
+    }
+    writeSequence(out, in + anchor, size - anchor, 0, 0);
+}
+
+bool decompressBlock(const uint8_t* in, const uint8_t* end, uint8_t* out,
+                     const size_t size)
+{
+    size_t pos = 0;
+    for (;;)
+    {
+        if (in == end)
+            return false;
+
+        const uint8_t token = *in++;
+        size_t nLiterals = token >> 4;
+        if (nLiterals == maxNibble && !readLength(in, end, nLiterals))
+            return false;
+        if (nLiterals > size_t(end - in) || nLiterals > size - pos)
+            return false;
+
+        std::memcpy(out + pos, in, nLiterals);
+        in += nLiterals;
+        pos += nLiterals;
+        if (in == end)
+            return pos == size;
+
+        if (end - in < 2)
+            return false;
+        const size_t offset = size_t(in[0]) | (size_t(in[1]) << 8);
+        in += 2;
+        if (offset == 0 || offset > pos)
+            return false;
+
+        size_t length = token & maxNibble;
+        if (length == maxNibble && !readLength(in, end, length))
+            return false;
+        length += minMatch;
+        if (length > size - pos)
+            return false;
+
+        const uint8_t* match = out + pos - offset;
+        if (offset >= length)
+            std::memcpy(out + pos, match, length);
+        else // overlapping match repeats the last offset bytes
+            for (size_t i = 0; i < length; ++i)
+                out[pos + i] = match[i];
+        pos += length;
+    }
+}
+}
+
+std::vector<uint8_t> compress(const uint8_t* data, const size_t size,
+                              size_t elementSize)
+{
+    if (elementSize == 0 || elementSize > 255 || size % elementSize != 0)
+        elementSize = 1;
+
+    Scratch& scratch = getScratch();
+    std::vector<uint8_t>& out = scratch.out;
+    out.clear();
+    out.reserve(size + size / 255 + 16);
+    out.push_back(uint8_t(elementSize));
+
+    const uint8_t* in = data;
+    if (elementSize > 1)
+    {
+        const size_t nElements = size / elementSize;
+        std::vector<uint8_t>& shuffled = scratch.shuffled;
+        shuffled.resize(size);
+        for (size_t i = 0; i < nElements; ++i)
+            for (size_t byte = 0; byte < elementSize; ++byte)
+                shuffled[byte * nElements + i] = data[i * elementSize + byte];
+        in = shuffled.data();
+    }
+    compressBlock(in, size, out, scratch.table);
+
+    // The result only takes the compressed size, not the worst case capacity
+    return std::vector<uint8_t>(out.begin(), out.end());
+}
+
+bool decompress(const uint8_t* compressed, const size_t compressedSize,
+                uint8_t* data, const size_t size)
+{
+    if (compressedSize == 0)
+        return false;
+
+    const size_t elementSize = compressed[0];
+    const uint8_t* begin = compressed + 1;
+    const uint8_t* end = compressed + compressedSize;
+    if (elementSize == 0 || size % elementSize != 0)
+        return false;
+
+    if (elementSize == 1)
+        return decompressBlock(begin, end, data, size);
+
+    std::vector<uint8_t>& shuffled = getScratch().shuffled;
+    shuffled.resize(size);
+    if (!decompressBlock(begin, end, shuffled.data(), size))
+        return false;
+
+    const size_t nElements = size / elementSize;
+    for (size_t i = 0; i < nElements; ++i)
+        for (size_t byte = 0; byte < elementSize; ++byte)
+            data[i * elementSize + byte] = shuffled[byte * nElements + i];
+    return true;
+}
+}
@@ -0,0 +1,57 @@
+/* Copyright (c) 2017, EPFL/Blue Brain Project
+ *                     bbp-open-source@googlegroups.com
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _Compression_h_
+#define _Compression_h_
+
+#include <livre/data/api.h>
+#include <livre/data/types.h>
+
+namespace livre
+{
+/**
+ * Compresses data with a fast LZ77 codec in the style of LZ4, which trades
+ * compression ratio for speed. Multi-byte elements are optionally shuffled
+ * first, grouping the n-th bytes of all elements, which makes the slowly
+ * changing high bytes of 16 and 32 bit data compressible.
+ *
+ * @param data the data to compress.
+ * @param size the size of the data in bytes.
+ * @param elementSize the size of the shuffled elements, 1 disables shuffling.
+ * @return the compressed data, including the element size.
+ */
+LIVREDATA_API std::vector<uint8_t> compress(const uint8_t* data, size_t size,
+                                           size_t elementSize = 1);
+
+/**
+ * Decompresses data compressed by compress().
+ *
+ * @param compressed the compressed data.
+ * @param compressedSize the size of the compressed data in bytes.
+ * @param data the output buffer.
+ * @param size the size of the uncompressed data in bytes.
+ * @return false if the compressed data is invalid or does not decompress to
+ * the given size.
+ */
+LIVREDATA_API bool decompress(const uint8_t* compressed,
+                             size_t compressedSize, uint8_t* data,
+                             size_t size);
+}
+
+#endif // _Compression_h_
@@ -21,11 +21,78 @@
 #include <livre/data/DataSource.h>
 #include <livre/data/NodeVisitor.h>
 
+#include <algorithm>
+#include <thread>
+
 namespace livre
 {
+namespace
+{
+// Enough subtrees to balance the threads of a parallel traversal
+const size_t MIN_SUBTREES = 256;
+// Chunks of consecutive subtrees per thread, which share a forked visitor
+const size_t CHUNKS_PER_THREAD = 4;
+
+// A run of nodes between subtrees, or a chunk of consecutive subtrees
+struct Segment
+{
+    size_t firstSubtree;
+    size_t nSubtrees; // 0 for a run of nodes
+    std::unique_ptr<NodeVisitor> visitor;
+};
+typedef std::vector<Segment> Segments;
+
+// Visits the levels above the subtrees of a parallel traversal. The nodes are
+// visited by forked visitors, one per run between two subtrees and one per
+// chunk of consecutive subtrees, to keep the results in the order of the
+// serial traversal with a few forks per thread.
+class SplitVisitor : public NodeVisitor
+{
+public:
+    SplitVisitor(const NodeVisitor& visitor, const uint32_t subtreeLevel,
+                 const size_t chunkSize, Segments& segments, NodeIds& subtrees)
+        : _visitor(visitor)
+        , _subtreeLevel(subtreeLevel)
+        , _chunkSize(chunkSize)
+        , _segments(segments)
+        , _subtrees(subtrees)
+    {
+    }
+
+    bool visit(const NodeId& nodeId) final
+    {
+        if (nodeId.getLevel() == _subtreeLevel)
+        {
+            if (_segments.empty() || _segments.back().nSubtrees == 0 ||
+                _segments.back().nSubtrees == _chunkSize)
+            {
+                _segments.push_back({_subtrees.size(), 0, _visitor.fork()});
+            }
+            ++_segments.back().nSubtrees;
+            _subtrees.push_back(nodeId);
+            return false;
+        }
+
+        if (_segments.empty() || _segments.back().nSubtrees > 0)
+            _segments.push_back({0, 0, _visitor.fork()});
+        return _segments.back().visitor->visit(nodeId);
+    }
+
+private:
+    const NodeVisitor& _visitor;
+    const uint32_t _subtreeLevel;
+    const size_t _chunkSize;
+    Segments& _segments;
+    NodeIds& _subtrees;
+};
+}
+
 struct DFSTraversal::Impl
 {
 public:
+    // Depth-first traversal with an explicit stack instead of recursion and
+    // NodeId::getChildren(), to keep the per-frame traversal free of heap
+    // allocations. Children are visited in the order of getChildren().
     void traverse(const NodeId& nodeId, const uint32_t depth,
                   livre::NodeVisitor& visitor)
     {
@@ -34,12 +101,99 @@ public:
         if (!visitor.visit(nodeId))
             return;
 
-        if (depth == 1)
+        // Nodes at INVALID_LEVEL have no children
+        const uint32_t levels =
+            std::min(depth, INVALID_LEVEL + 1 - nodeId.getLevel());
+        if (levels == 1)
             return;
 
-        const NodeIds& nodeIds = nodeId.getChildren();
-        for (const NodeId& childNodeId : nodeIds)
-            traverse(childNodeId, depth - 1, visitor);
+        // One entry per level below nodeId: the position of the first child
+        // and the index of the next child to visit
+        struct Entry
+        {
+            Vector3ui position;
+            uint32_t child;
+        };
+        Entry stack[INVALID_LEVEL];
+        uint32_t top = 0;
+        stack[0] = {nodeId.getPosition() * 2u, 0};
+
+        const uint32_t firstLevel = nodeId.getLevel() + 1;
+        const uint32_t timeStep = nodeId.getTimeStep();
+        for (;;)
+        {
+            Entry& entry = stack[top];
+            if (entry.child == 8)
+            {
+                if (top == 0)
+                    return;
+                --top;
+                continue;
+            }
+
+            const uint32_t child = entry.child++;
+            const Vector3ui offset(child >> 2, (child >> 1) & 1, child & 1);
+            const NodeId childId(firstLevel + top, entry.position + offset,
+                                 timeStep);
+            if (visitor.visit(childId) && top + 2 < levels)
+                stack[++top] = {childId.getPosition() * 2u, 0};
+        }
+    }
+
+    void traverse(const RootNode& rootNode, NodeVisitor& visitor,
+                  const uint32_t timeStep)
+    {
+        const Vector3ui& blockSize = rootNode.getBlockSize();
+        for (uint32_t x = 0; x < blockSize.x(); ++x)
+            for (uint32_t y = 0; y < blockSize.y(); ++y)
+                for (uint32_t z = 0; z < blockSize.z(); ++z)
+                {
+                    traverse(NodeId(0, Vector3ui(x, y, z), timeStep),
+                             rootNode.getDepth(), visitor);
+                }
+    }
+
+    void traverseParallel(const RootNode& rootNode, NodeVisitor& visitor,
+                          const uint32_t timeStep)
+    {
+        if (!visitor.canFork())
+        {
+            traverse(rootNode, visitor, timeStep);
+            return;
+        }
+
+        const uint32_t depth = rootNode.getDepth();
+        const size_t nBlocks = rootNode.getBlockSize().product();
+        uint32_t subtreeLevel = 0;
+        while (subtreeLevel + 1 < depth &&
+               (nBlocks << (3 * subtreeLevel)) < MIN_SUBTREES)
+        {
+            ++subtreeLevel;
+        }
+
+        const size_t nThreads =
+            std::max(std::thread::hardware_concurrency(), 1u);
+        const size_t maxSubtrees = nBlocks << (3 * subtreeLevel);
+        const size_t chunkSize =
+            std::max(maxSubtrees / (nThreads * CHUNKS_PER_THREAD), size_t(1));
+
+        Segments segments;
+        NodeIds subtrees;
+        SplitVisitor splitVisitor(visitor, subtreeLevel, chunkSize, segments,
+                                  subtrees);
+        traverse(rootNode, splitVisitor, timeStep);
+
+#pragma omp parallel for schedule(dynamic)
+        for (ssize_t i = 0; i < ssize_t(segments.size()); ++i)
+        {
+            Segment& segment = segments[i];
+            for (size_t j = 0; j < segment.nSubtrees; ++j)
+                traverse(subtrees[segment.firstSubtree + j],
+                         depth - subtreeLevel, *segment.visitor);
+        }
+
+        for (Segment& segment : segments)
+            visitor.join(*segment.visitor);
     }
 };
 
@@ -64,14 +218,16 @@ void DFSTraversal::traverse(const RootNode& rootNode, NodeVisitor& visitor,
                             const uint32_t timeStep)
 {
     visitor.visitPre();
-    const Vector3ui& blockSize = rootNode.getBlockSize();
-    for (uint32_t x = 0; x < blockSize.x(); ++x)
-        for (uint32_t y = 0; y < blockSize.y(); ++y)
-            for (uint32_t z = 0; z < blockSize.z(); ++z)
-            {
-                _impl->traverse(NodeId(0, Vector3ui(x, y, z), timeStep),
-                                rootNode.getDepth(), visitor);
-            }
+    _impl->traverse(rootNode, visitor, timeStep);
+    visitor.visitPost();
+}
+
+void DFSTraversal::traverseParallel(const RootNode& rootNode,
+                                    NodeVisitor& visitor,
+                                    const uint32_t timeStep)
+{
+    visitor.visitPre();
+    _impl->traverseParallel(rootNode, visitor, timeStep);
     visitor.visitPost();
 }
 }
@@ -51,6 +51,23 @@ public:
     LIVREDATA_API void traverse(const RootNode& rootNode, NodeVisitor& visitor,
                                 const uint32_t timeStep);
 
+    /**
+     * Traverse the node tree starting from the root, with its subtrees
+     * distributed over the OpenMP threads.
+     *
+     * The subtrees are visited by visitors created with NodeVisitor::fork()
+     * and joined in the order of traverse(), so the results are the same as
+     * for a serial traversal. Consecutive subtrees share a forked visitor, a
+     * few per thread. If NodeVisitor::canFork() is false, the traversal is
+     * serial.
+     * @param rootNode  The tree root information.
+     * @param visitor Visitor object, visit() has to be thread-safe.
+     * @param timeStep The temporal position of the node tree.
+     */
+    LIVREDATA_API void traverseParallel(const RootNode& rootNode,
+                                        NodeVisitor& visitor,
+                                        const uint32_t timeStep);
+
 private:
     struct Impl;
     std::unique_ptr<Impl> _impl;
@@ -122,6 +122,47 @@ ConstMemoryUnitPtr DataSource::getData(const NodeId& nodeId) const
     return _impl->plugin->getData(lodNode);
 }
 
+std::future<void> DataSource::getDataAsync(const NodeIds& nodeIds,
+                                           const DataCallback& callback)
+{
+    LODNodes nodes;
+    nodes.reserve(nodeIds.size());
+    for (const NodeId& nodeId : nodeIds)
+    {
+        const LODNode& lodNode =
+            nodeId.isValid() ? getNode(nodeId) : LODNode();
+        if (lodNode.isValid())
+            nodes.push_back(lodNode);
+        else
+            callback(nodeId, MemoryUnitPtr());
+    }
+    return _impl->plugin->getDataAsync(nodes, callback);
+}
+
+bool DataSource::getValueRange(const LODNode& node, Range& range) const
+{
+    return node.isValid() && _impl->plugin->getValueRange(node, range);
+}
+
+void DataSource::setVolumeInfo(const VolumeInformation& volumeInfo)
+{
+    _impl->plugin->setVolumeInfo(volumeInfo);
+}
+
+void DataSource::setData(const NodeId& nodeId, const MemoryUnit& data)
+{
+    const LODNode& lodNode = getNode(nodeId);
+    if (!lodNode.isValid())
+        LBTHROW(std::runtime_error("Invalid node"));
+
+    _impl->plugin->setData(lodNode, data);
+}
+
+void DataSource::finish()
+{
+    _impl->plugin->finish();
+}
+
 VolumeInformation DataSource::getVolumeInfo(const servus::URI& uri)
 {
     const DataSource source(uri);
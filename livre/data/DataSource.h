@@ -25,6 +25,8 @@
 #include <livre/data/VolumeInformation.h>
 #include <livre/data/api.h>
 
+#include <future>
+
 namespace livre
 {
 class DataSource
@@ -77,6 +79,34 @@ public:
     /** @copydoc getData( const NodeId& nodeId ) */
     LIVREDATA_API ConstMemoryUnitPtr getData(const NodeId& nodeId) const;
 
+    /**
+     * Read the data for several nodes asynchronously.
+     * @param nodeIds NodeIds to be read, invalid ones are reported with an
+     * empty pointer.
+     * @param callback receives the data of each node, see
+     * DataSourcePlugin::getDataAsync().
+     * @return a future which is ready once all callbacks have returned.
+     */
+    LIVREDATA_API std::future<void> getDataAsync(const NodeIds& nodeIds,
+                                                 const DataCallback& callback);
+
+    /** @copydoc DataSourcePlugin::getValueRange() */
+    LIVREDATA_API bool getValueRange(const LODNode& node, Range& range) const;
+
+    /** @copydoc DataSourcePlugin::setVolumeInfo() */
+    LIVREDATA_API void setVolumeInfo(const VolumeInformation& volumeInfo);
+
+    /**
+     * Write the data for a given node, if opened with MODE_WRITE.
+     * @param nodeId NodeId to be written.
+     * @param data The block data for the node.
+     * @throw std::runtime_error if the data source is read-only.
+     */
+    LIVREDATA_API void setData(const NodeId& nodeId, const MemoryUnit& data);
+
+    /** @copydoc DataSourcePlugin::finish() */
+    LIVREDATA_API void finish();
+
     /**
      * @param nodeId The nodeId to get the node for.
      * @return The LODNode for the ID or an invalid node if not found.
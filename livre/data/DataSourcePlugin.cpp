@@ -19,14 +19,158 @@
 
 #include <livre/data/DataSourcePlugin.h>
 
+#include <lunchbox/debug.h>
 #include <lunchbox/log.h>
+#include <lunchbox/mtQueue.h>
+#include <lunchbox/thread.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 namespace livre
 {
+namespace
+{
+typedef std::function<void()> Task;
+
+// The threads which read the data of all data sources. They are started on
+// first use and live until the process exits, so a batch of reads neither
+// starts threads nor an OpenMP team.
+class ReaderThreads
+{
+public:
+    static ReaderThreads& getInstance()
+    {
+        // Never destroyed, the threads wait for tasks until the process exits
+        static ReaderThreads* readers = new ReaderThreads;
+        return *readers;
+    }
+
+    size_t getSize() const { return _threads.size(); }
+    void post(const Task& task) { _tasks.push(task); }
+private:
+    ReaderThreads()
+    {
+        const size_t nThreads =
+            std::max(std::thread::hardware_concurrency(), 2u);
+        for (size_t i = 0; i < nThreads; ++i)
+            _threads.emplace_back([this] {
+                lunchbox::Thread::setName("DataReader");
+                for (;;)
+                    _tasks.pop()();
+            });
+    }
+
+    lunchbox::MTQueue<Task> _tasks;
+    std::vector<std::thread> _threads;
+};
+
+// The progress of a batch, shared by the tasks which work on it
+struct Batch
+{
+    Batch(const size_t count_, const std::function<void(size_t)>& function_,
+          const size_t nTasks)
+        : count(count_)
+        , function(function_)
+        , next(0)
+        , running(nTasks)
+    {
+    }
+
+    void run()
+    {
+        for (size_t i = next++; i < count; i = next++)
+        {
+            try
+            {
+                function(i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!exception)
+                    exception = std::current_exception();
+            }
+        }
+
+        if (--running > 0)
+            return;
+        if (exception)
+            done.set_exception(exception);
+        else
+            done.set_value();
+    }
+
+    const size_t count;
+    const std::function<void(size_t)> function;
+    std::atomic<size_t> next;
+    std::atomic<size_t> running;
+    std::mutex mutex;
+    std::exception_ptr exception;
+    std::promise<void> done;
+};
+
+MemoryUnitPtr readData(DataSourcePlugin& plugin, const LODNode& node)
+{
+    try
+    {
+        return plugin.getData(node);
+    }
+    catch (const std::exception& e)
+    {
+        LBWARN << "Cannot read node " << node.getNodeId() << ": " << e.what()
+               << std::endl;
+        return MemoryUnitPtr();
+    }
+}
+}
+
 DataSourcePlugin::DataSourcePlugin()
 {
 }
 
+std::future<void> DataSourcePlugin::getDataAsync(const LODNodes& nodes,
+                                                 const DataCallback& callback)
+{
+    return runAsync(nodes.size(),
+                    [this, nodes, callback](const size_t i) {
+                        callback(nodes[i].getNodeId(),
+                                 readData(*this, nodes[i]));
+                    },
+                    false);
+}
+
+std::future<void> DataSourcePlugin::getDataParallel(
+    const LODNodes& nodes, const DataCallback& callback)
+{
+    return runAsync(nodes.size(), [this, nodes, callback](const size_t i) {
+        callback(nodes[i].getNodeId(), readData(*this, nodes[i]));
+    });
+}
+
+std::future<void> DataSourcePlugin::runAsync(
+    const size_t count, const std::function<void(size_t)>& function,
+    const bool parallel)
+{
+    if (count == 0)
+    {
+        std::promise<void> done;
+        done.set_value();
+        return done.get_future();
+    }
+
+    ReaderThreads& readers = ReaderThreads::getInstance();
+    const size_t nTasks = parallel ? std::min(count, readers.getSize()) : 1;
+    const std::shared_ptr<Batch> batch =
+        std::make_shared<Batch>(count, function, nTasks);
+    std::future<void> future = batch->done.get_future();
+    for (size_t i = 0; i < nTasks; ++i)
+        readers.post([batch] { batch->run(); });
+    return future;
+}
+
 LODNode DataSourcePlugin::getNode(const NodeId& nodeId) const
 {
     return internalNodeToLODNode(nodeId);
@@ -37,6 +181,26 @@ const VolumeInformation& DataSourcePlugin::getVolumeInfo() const
     return _volumeInfo;
 }
 
+bool DataSourcePlugin::getValueRange(const LODNode&, Range&) const
+{
+    return false;
+}
+
+void DataSourcePlugin::setVolumeInfo(const VolumeInformation&)
+{
+    LBTHROW(std::runtime_error("Data source is read-only"));
+}
+
+void DataSourcePlugin::setData(const LODNode&, const MemoryUnit&)
+{
+    LBTHROW(std::runtime_error("Data source is read-only"));
+}
+
+void DataSourcePlugin::finish()
+{
+    LBTHROW(std::runtime_error("Data source is read-only"));
+}
+
 LODNode DataSourcePlugin::internalNodeToLODNode(
     const NodeId& internalNode) const
 {
@@ -28,6 +28,8 @@
 #include <lunchbox/plugin.h>
 #include <servus/uri.h>
 
+#include <future>
+
 namespace livre
 {
 class DataSourcePluginData
@@ -80,6 +82,64 @@ public:
      */
     virtual MemoryUnitPtr getData(const LODNode& node) = 0;
 
+    /**
+     * Read the data for several nodes asynchronously.
+     *
+     * The callback is called exactly once per node, in any order and possibly
+     * concurrently from several threads, and must not throw. Nodes which
+     * cannot be read are reported with an empty pointer. The default
+     * implementation reads the nodes one after another with getData() on a
+     * reader thread, which is shared by all data sources; implementations may
+     * coalesce adjacent reads and issue them in parallel.
+     *
+     * @param nodes LODNodes to be read.
+     * @param callback receives the data of each node.
+     * @return a future which is ready once all callbacks have returned.
+     */
+    LIVREDATA_API virtual std::future<void> getDataAsync(
+        const LODNodes& nodes, const DataCallback& callback);
+
+    /**
+     * Gives the range of the values of a node and all its descendants, for
+     * skipping empty and uniform subtrees without reading their data. The
+     * range may be larger than the actual one, but has to cover the overlap
+     * of all bricks of the subtree.
+     * @param node the root of the subtree.
+     * @param range set to the minimum and maximum value, in the units of the
+     * data type, if it is known.
+     * @return true if the range is known, false by default.
+     */
+    LIVREDATA_API virtual bool getValueRange(const LODNode& node,
+                                             Range& range) const;
+
+    /**
+     * Sets the volume information of a data source opened with MODE_WRITE,
+     * before any data is written.
+     * @param volumeInfo the volume information.
+     * @throw std::runtime_error if the data source is read-only.
+     */
+    LIVREDATA_API virtual void setVolumeInfo(
+        const VolumeInformation& volumeInfo);
+
+    /**
+     * Writes the data for a given node to a data source opened with
+     * MODE_WRITE.
+     * @param node LODNode to be written.
+     * @param data The block data for the node.
+     * @throw std::runtime_error if the data source is read-only.
+     */
+    LIVREDATA_API virtual void setData(const LODNode& node,
+                                       const MemoryUnit& data);
+
+    /**
+     * Completes a data source opened with MODE_WRITE, after all data is
+     * written. Implementations also finish on destruction, but can only
+     * report errors from here.
+     * @throw std::runtime_error if the data source is read-only or cannot be
+     *        completed.
+     */
+    LIVREDATA_API virtual void finish();
+
     /**
      * Converts internal node to lod node.
      * @param nodeId Internal node.
@@ -102,6 +162,29 @@ public:
     LIVREDATA_API LODNode getNode(const NodeId& nodeId) const;
 
 protected:
+    /**
+     * Reads the nodes with getData() on all reader threads, for the
+     * implementations of getDataAsync() of thread safe data sources.
+     */
+    LIVREDATA_API std::future<void> getDataParallel(
+        const LODNodes& nodes, const DataCallback& callback);
+
+    /**
+     * Calls a function for all indices of a batch on the reader threads,
+     * for the implementations of getDataAsync(). The reader threads are
+     * started once per process; the function must not wait for other reads.
+     * @param count the number of indices.
+     * @param function called for each index in [0, count) once, possibly
+     *        concurrently.
+     * @param parallel use all reader threads, or one for a data source which
+     *        is not thread safe.
+     * @return a future which is ready once all calls have returned, and
+     *         which holds the first exception of a call.
+     */
+    LIVREDATA_API static std::future<void> runAsync(
+        size_t count, const std::function<void(size_t)>& function,
+        bool parallel = true);
+
     DataSourcePlugin(const DataSourcePlugin&) = delete;
     DataSourcePlugin& operator=(const DataSourcePlugin&) = delete;
 
@@ -0,0 +1,520 @@
+/* Copyright (c) 2017, EPFL/Blue Brain Project
+ *                     bbp-open-source@googlegroups.com
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/data/Downsample.h>
+
+#include <lunchbox/debug.h>
+
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#include <immintrin.h>
+#define LIVRE_USE_SSE2
+#define LIVRE_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace livre
+{
+namespace
+{
+// The four input rows of an output row, from its first voxel on: output
+// voxel i reduces the voxels 2i and 2i + 1 of each row
+template <class T>
+using Rows = const T* const[4];
+
+template <class T>
+struct BoxFilter
+{
+    // Floats are summed in the order of the vector code, for equal results
+    typedef typename std::conditional<std::is_floating_point<T>::value, T,
+                                      int64_t>::type Sum;
+
+    static T reduce(const Rows<T>& rows, const size_t x0, const size_t x1)
+    {
+        Sum sum = 0;
+        for (const T* row : rows)
+            sum += Sum(row[x0]) + Sum(row[x1]);
+        return T(sum / 8);
+    }
+};
+
+template <class T>
+struct MaxFilter
+{
+    static T reduce(const Rows<T>& rows, const size_t x0, const size_t x1)
+    {
+        T value = std::max(rows[0][x0], rows[0][x1]);
+        for (size_t i = 1; i < 4; ++i)
+            value = std::max(value, std::max(rows[i][x0], rows[i][x1]));
+        return value;
+    }
+};
+
+// Ties go to the first value in x, y, z order
+template <class T>
+struct ModeFilter
+{
+    static T reduce(const Rows<T>& rows, const size_t x0, const size_t x1)
+    {
+        const T values[] = {rows[0][x0], rows[0][x1], rows[1][x0],
+                            rows[1][x1], rows[2][x0], rows[2][x1],
+                            rows[3][x0], rows[3][x1]};
+        size_t best = 0;
+        size_t bestCount = 0;
+        for (size_t i = 0; i < 8 && bestCount < 8 - i; ++i)
+        {
+            size_t count = 1;
+            for (size_t j = i + 1; j < 8; ++j)
+                count += values[j] == values[i];
+            if (count > bestCount)
+            {
+                best = i;
+                bestCount = count;
+            }
+        }
+        return values[best];
+    }
+};
+
+// The vector code reduces the first output voxels of a row and returns their
+// number, the filter reduces the remaining ones
+template <class Filter, class T>
+size_t reduceVector(Filter, const Rows<T>&, size_t, T*)
+{
+    return 0;
+}
+
+#ifdef LIVRE_USE_SSE2
+// The CPU features of libgcc may not be initialized yet during the static
+// initialization of a shared library
+bool hasAVX2()
+{
+    static const bool avx2 = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return avx2;
+}
+
+__m128i load128(const void* in)
+{
+    return _mm_loadu_si128(static_cast<const __m128i*>(in));
+}
+
+void store128(void* out, const __m128i value)
+{
+    _mm_storeu_si128(static_cast<__m128i*>(out), value);
+}
+
+LIVRE_AVX2 __m256i load256(const void* in)
+{
+    return _mm256_loadu_si256(static_cast<const __m256i*>(in));
+}
+
+// The packing instructions interleave their inputs per 128 bit lane
+LIVRE_AVX2 void storePacked256(void* out, const __m256i value)
+{
+    _mm256_storeu_si256(static_cast<__m256i*>(out),
+                        _mm256_permute4x64_epi64(value,
+                                                 _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+size_t reduceSSE2(BoxFilter<uint8_t>, const Rows<uint8_t>& rows, size_t i,
+                  const size_t count, uint8_t* out)
+{
+    const __m128i mask = _mm_set1_epi16(0xff);
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i sum[2] = {_mm_setzero_si128(), _mm_setzero_si128()};
+        for (const uint8_t* row : rows)
+            for (size_t j = 0; j < 2; ++j)
+            {
+                const __m128i value = load128(row + 2 * i + 16 * j);
+                sum[j] = _mm_add_epi16(sum[j], _mm_and_si128(value, mask));
+                sum[j] = _mm_add_epi16(sum[j], _mm_srli_epi16(value, 8));
+            }
+        store128(out + i, _mm_packus_epi16(_mm_srli_epi16(sum[0], 3),
+                                           _mm_srli_epi16(sum[1], 3)));
+    }
+    return i;
+}
+
+LIVRE_AVX2 size_t reduceAVX2(BoxFilter<uint8_t>, const Rows<uint8_t>& rows,
+                             size_t i, const size_t count, uint8_t* out)
+{
+    const __m256i mask = _mm256_set1_epi16(0xff);
+    for (; i + 32 <= count; i += 32)
+    {
+        __m256i sum[2] = {_mm256_setzero_si256(), _mm256_setzero_si256()};
+        for (const uint8_t* row : rows)
+            for (size_t j = 0; j < 2; ++j)
+            {
+                const __m256i value = load256(row + 2 * i + 32 * j);
+                sum[j] =
+                    _mm256_add_epi16(sum[j], _mm256_and_si256(value, mask));
+                sum[j] = _mm256_add_epi16(sum[j], _mm256_srli_epi16(value, 8));
+            }
+        storePacked256(out + i,
+                       _mm256_packus_epi16(_mm256_srli_epi16(sum[0], 3),
+                                           _mm256_srli_epi16(sum[1], 3)));
+    }
+    return i;
+}
+
+size_t reduceSSE2(MaxFilter<uint8_t>, const Rows<uint8_t>& rows, size_t i,
+                  const size_t count, uint8_t* out)
+{
+    const __m128i mask = _mm_set1_epi16(0xff);
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i max[2];
+        for (size_t j = 0; j < 2; ++j)
+        {
+            max[j] = load128(rows[0] + 2 * i + 16 * j);
+            for (size_t k = 1; k < 4; ++k)
+                max[j] = _mm_max_epu8(max[j],
+                                      load128(rows[k] + 2 * i + 16 * j));
+            max[j] = _mm_max_epu8(max[j], _mm_srli_epi16(max[j], 8));
+            max[j] = _mm_and_si128(max[j], mask);
+        }
+        store128(out + i, _mm_packus_epi16(max[0], max[1]));
+    }
+    return i;
+}
+
+LIVRE_AVX2 size_t reduceAVX2(MaxFilter<uint8_t>, const Rows<uint8_t>& rows,
+                             size_t i, const size_t count, uint8_t* out)
+{
+    const __m256i mask = _mm256_set1_epi16(0xff);
+    for (; i + 32 <= count; i += 32)
+    {
+        __m256i max[2];
+        for (size_t j = 0; j < 2; ++j)
+        {
+            max[j] = load256(rows[0] + 2 * i + 32 * j);
+            for (size_t k = 1; k < 4; ++k)
+                max[j] = _mm256_max_epu8(max[j],
+                                         load256(rows[k] + 2 * i + 32 * j));
+            max[j] = _mm256_max_epu8(max[j], _mm256_srli_epi16(max[j], 8));
+            max[j] = _mm256_and_si256(max[j], mask);
+        }
+        storePacked256(out + i, _mm256_packus_epi16(max[0], max[1]));
+    }
+    return i;
+}
+
+// SSE2 has no unsigned 16 bit packing and maximum, the values are biased to
+// use the signed instructions
+size_t reduceSSE2(BoxFilter<uint16_t>, const Rows<uint16_t>& rows, size_t i,
+                  const size_t count, uint16_t* out)
+{
+    const __m128i mask = _mm_set1_epi32(0xffff);
+    const __m128i bias32 = _mm_set1_epi32(0x8000);
+    const __m128i bias16 = _mm_set1_epi16(-0x8000);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i sum[2] = {_mm_setzero_si128(), _mm_setzero_si128()};
+        for (const uint16_t* row : rows)
+            for (size_t j = 0; j < 2; ++j)
+            {
+                const __m128i value = load128(row + 2 * i + 8 * j);
+                sum[j] = _mm_add_epi32(sum[j], _mm_and_si128(value, mask));
+                sum[j] = _mm_add_epi32(sum[j], _mm_srli_epi32(value, 16));
+            }
+        for (size_t j = 0; j < 2; ++j)
+            sum[j] = _mm_sub_epi32(_mm_srli_epi32(sum[j], 3), bias32);
+        store128(out + i,
+                 _mm_xor_si128(_mm_packs_epi32(sum[0], sum[1]), bias16));
+    }
+    return i;
+}
+
+LIVRE_AVX2 size_t reduceAVX2(BoxFilter<uint16_t>, const Rows<uint16_t>& rows,
+                             size_t i, const size_t count, uint16_t* out)
+{
+    const __m256i mask = _mm256_set1_epi32(0xffff);
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256i sum[2] = {_mm256_setzero_si256(), _mm256_setzero_si256()};
+        for (const uint16_t* row : rows)
+            for (size_t j = 0; j < 2; ++j)
+            {
+                const __m256i value = load256(row + 2 * i + 16 * j);
+                sum[j] =
+                    _mm256_add_epi32(sum[j], _mm256_and_si256(value, mask));
+                sum[j] =
+                    _mm256_add_epi32(sum[j], _mm256_srli_epi32(value, 16));
+            }
+        storePacked256(out + i,
+                       _mm256_packus_epi32(_mm256_srli_epi32(sum[0], 3),
+                                           _mm256_srli_epi32(sum[1], 3)));
+    }
+    return i;
+}
+
+size_t reduceSSE2(MaxFilter<uint16_t>, const Rows<uint16_t>& rows, size_t i,
+                  const size_t count, uint16_t* out)
+{
+    const __m128i bias16 = _mm_set1_epi16(-0x8000);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i max[2];
+        for (size_t j = 0; j < 2; ++j)
+        {
+            max[j] = _mm_xor_si128(load128(rows[0] + 2 * i + 8 * j), bias16);
+            for (size_t k = 1; k < 4; ++k)
+            {
+                const __m128i value = load128(rows[k] + 2 * i + 8 * j);
+                max[j] = _mm_max_epi16(max[j], _mm_xor_si128(value, bias16));
+            }
+            // the low 16 bits hold the maximum of the pair, sign extended
+            max[j] = _mm_max_epi16(max[j], _mm_srli_epi32(max[j], 16));
+            max[j] = _mm_srai_epi32(_mm_slli_epi32(max[j], 16), 16);
+        }
+        store128(out + i,
+                 _mm_xor_si128(_mm_packs_epi32(max[0], max[1]), bias16));
+    }
+    return i;
+}
+
+LIVRE_AVX2 size_t reduceAVX2(MaxFilter<uint16_t>, const Rows<uint16_t>& rows,
+                             size_t i, const size_t count, uint16_t* out)
+{
+    const __m256i mask = _mm256_set1_epi32(0xffff);
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256i max[2];
+        for (size_t j = 0; j < 2; ++j)
+        {
+            max[j] = load256(rows[0] + 2 * i + 16 * j);
+            for (size_t k = 1; k < 4; ++k)
+                max[j] = _mm256_max_epu16(max[j],
+                                          load256(rows[k] + 2 * i + 16 * j));
+            max[j] = _mm256_max_epu16(max[j], _mm256_srli_epi32(max[j], 16));
+            max[j] = _mm256_and_si256(max[j], mask);
+        }
+        storePacked256(out + i, _mm256_packus_epi32(max[0], max[1]));
+    }
+    return i;
+}
+
+// AVX2 where available, SSE2 for the rest of the row
+template <class Filter, class T>
+size_t reduceX86(const Filter filter, const Rows<T>& rows, const size_t count,
+                 T* out)
+{
+    const size_t i = hasAVX2() ? reduceAVX2(filter, rows, 0, count, out) : 0;
+    return reduceSSE2(filter, rows, i, count, out);
+}
+
+size_t reduceVector(const BoxFilter<uint8_t> filter,
+                    const Rows<uint8_t>& rows, const size_t count,
+                    uint8_t* out)
+{
+    return reduceX86(filter, rows, count, out);
+}
+
+size_t reduceVector(const MaxFilter<uint8_t> filter,
+                    const Rows<uint8_t>& rows, const size_t count,
+                    uint8_t* out)
+{
+    return reduceX86(filter, rows, count, out);
+}
+
+size_t reduceVector(const BoxFilter<uint16_t> filter,
+                    const Rows<uint16_t>& rows, const size_t count,
+                    uint16_t* out)
+{
+    return reduceX86(filter, rows, count, out);
+}
+
+size_t reduceVector(const MaxFilter<uint16_t> filter,
+                    const Rows<uint16_t>& rows, const size_t count,
+                    uint16_t* out)
+{
+    return reduceX86(filter, rows, count, out);
+}
+
+__m128 loadEven(const float* in)
+{
+    return _mm_shuffle_ps(_mm_loadu_ps(in), _mm_loadu_ps(in + 4),
+                          _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+__m128 loadOdd(const float* in)
+{
+    return _mm_shuffle_ps(_mm_loadu_ps(in), _mm_loadu_ps(in + 4),
+                          _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+size_t reduceVector(BoxFilter<float>, const Rows<float>& rows,
+                    const size_t count, float* out)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 sum = _mm_setzero_ps();
+        for (const float* row : rows)
+            sum = _mm_add_ps(sum, _mm_add_ps(loadEven(row + 2 * i),
+                                             loadOdd(row + 2 * i)));
+        _mm_storeu_ps(out + i, _mm_mul_ps(sum, _mm_set1_ps(0.125f)));
+    }
+    return i;
+}
+
+size_t reduceVector(MaxFilter<float>, const Rows<float>& rows,
+                    const size_t count, float* out)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 max = _mm_max_ps(loadEven(rows[0] + 2 * i),
+                                loadOdd(rows[0] + 2 * i));
+        for (size_t k = 1; k < 4; ++k)
+            max = _mm_max_ps(max, _mm_max_ps(loadEven(rows[k] + 2 * i),
+                                             loadOdd(rows[k] + 2 * i)));
+        _mm_storeu_ps(out + i, max);
+    }
+    return i;
+}
+#endif
+
+// Reduces count voxels, the last one repeats its input voxel if the input
+// row ends after pairs voxels
+template <class T, template <class> class Filter>
+void _reduceRow(const Rows<T>& rows, const size_t count, const size_t pairs,
+                T* out)
+{
+    size_t i = reduceVector(Filter<T>(), rows, pairs, out);
+    for (; i < pairs; ++i)
+        out[i] = Filter<T>::reduce(rows, 2 * i, 2 * i + 1);
+    for (; i < count; ++i)
+        out[i] = Filter<T>::reduce(rows, 2 * i, 2 * i);
+}
+
+template <class T, template <class> class Filter>
+void _reduce(const T* in, const Vector3ui& inSize, T* out,
+             const Vector3ui& outSize, const Vector3i& origin)
+{
+    const Vector3ui size = getDownsampledSize(inSize);
+
+    // The output voxels inside of the halved volume in x, others are 0
+    const int64_t width = outSize.x();
+    const int64_t begin =
+        std::min(std::max(-int64_t(origin.x()), int64_t(0)), width);
+    const int64_t end =
+        std::min(std::max(int64_t(size.x()) - origin.x(), begin), width);
+    const size_t inX = 2 * (origin.x() + begin);
+    const size_t count = end - begin;
+    const size_t pairs = count ? std::min(count, (inSize.x() - inX) / 2) : 0;
+    const size_t inSlice = size_t(inSize.x()) * inSize.y();
+
+#pragma omp parallel for
+    for (ssize_t z = 0; z < ssize_t(outSize.z()); ++z)
+    {
+        const int64_t coarseZ = origin.z() + z;
+        for (size_t y = 0; y < outSize.y(); ++y)
+        {
+            T* outRow = out + (z * outSize.y() + y) * outSize.x();
+            const int64_t coarseY = origin.y() + int64_t(y);
+            if (count == 0 || coarseZ < 0 || coarseZ >= size.z() ||
+                coarseY < 0 || coarseY >= size.y())
+            {
+                std::fill(outRow, outRow + width, T(0));
+                continue;
+            }
+            std::fill(outRow, outRow + begin, T(0));
+            std::fill(outRow + end, outRow + width, T(0));
+
+            const size_t z0 = 2 * coarseZ;
+            const size_t z1 = std::min(z0 + 1, size_t(inSize.z() - 1));
+            const size_t y0 = 2 * coarseY;
+            const size_t y1 = std::min(y0 + 1, size_t(inSize.y() - 1));
+            const T* first = in + inX;
+            const Rows<T> rows = {first + z0 * inSlice + y0 * inSize.x(),
+                                  first + z0 * inSlice + y1 * inSize.x(),
+                                  first + z1 * inSlice + y0 * inSize.x(),
+                                  first + z1 * inSlice + y1 * inSize.x()};
+            _reduceRow<T, Filter>(rows, count, pairs, outRow + begin);
+        }
+    }
+}
+
+template <class T>
+void _downsample(const DownsampleFilter filter, const uint8_t* in,
+                 const Vector3ui& inSize, uint8_t* out,
+                 const Vector3ui& outSize, const Vector3i& origin)
+{
+    const T* input = reinterpret_cast<const T*>(in);
+    T* output = reinterpret_cast<T*>(out);
+    switch (filter)
+    {
+    case DF_BOX:
+        _reduce<T, BoxFilter>(input, inSize, output, outSize, origin);
+        return;
+    case DF_MAX:
+        _reduce<T, MaxFilter>(input, inSize, output, outSize, origin);
+        return;
+    case DF_MODE:
+        _reduce<T, ModeFilter>(input, inSize, output, outSize, origin);
+        return;
+    }
+}
+}
+
+Vector3ui getDownsampledSize(const Vector3ui& size)
+{
+    return Vector3ui((size.x() + 1) / 2, (size.y() + 1) / 2,
+                     (size.z() + 1) / 2);
+}
+
+void downsample(const DataType dataType, const DownsampleFilter filter,
+                const uint8_t* in, const Vector3ui& inSize, uint8_t* out,
+                const Vector3ui& outSize, const Vector3i& origin)
+{
+    switch (dataType)
+    {
+    case DT_UINT8:
+        _downsample<uint8_t>(filter, in, inSize, out, outSize, origin);
+        return;
+    case DT_UINT16:
+        _downsample<uint16_t>(filter, in, inSize, out, outSize, origin);
+        return;
+    case DT_UINT32:
+        _downsample<uint32_t>(filter, in, inSize, out, outSize, origin);
+        return;
+    case DT_INT8:
+        _downsample<int8_t>(filter, in, inSize, out, outSize, origin);
+        return;
+    case DT_INT16:
+        _downsample<int16_t>(filter, in, inSize, out, outSize, origin);
+        return;
+    case DT_INT32:
+        _downsample<int32_t>(filter, in, inSize, out, outSize, origin);
+        return;
+    case DT_FLOAT:
+        _downsample<float>(filter, in, inSize, out, outSize, origin);
+        return;
+    case DT_UNDEFINED:
+        break;
+    }
+    LBTHROW(std::runtime_error("Undefined data type"));
+}
+}
@@ -0,0 +1,70 @@
+/* Copyright (c) 2017, EPFL/Blue Brain Project
+ *                     bbp-open-source@googlegroups.com
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _Downsample_h_
+#define _Downsample_h_
+
+#include <livre/data/VolumeInformation.h> // DataType
+#include <livre/data/api.h>
+#include <livre/data/types.h>
+
+namespace livre
+{
+/** Filters reducing 2x2x2 voxels to one voxel of the next coarser level. */
+enum DownsampleFilter
+{
+    DF_BOX,  //!< Average, for intensity data
+    DF_MAX,  //!< Maximum, keeps thin and sparse structures visible
+    DF_MODE, //!< Most frequent value, for label data
+};
+
+/**
+ * @return the size of a volume after downsample(), odd sizes are rounded up.
+ */
+LIVREDATA_API Vector3ui getDownsampledSize(const Vector3ui& size);
+
+/**
+ * Halves the resolution of a volume, or computes a box of the halved volume.
+ *
+ * Each output voxel reduces the 2x2x2 input voxels it covers; at the upper
+ * border of odd sized volumes the last input voxel is repeated. The output
+ * box may reach outside of the halved volume, e.g. for the overlap of a brick
+ * at the border, where the voxels are set to 0. Bricks with overlap cut from
+ * a halved level thus match their neighbours, unlike bricks downsampled from
+ * the bricks of the finer level.
+ *
+ * The box and max filters use AVX2 or SSE2 for 8 and 16 bit unsigned data and
+ * SSE for float data. The slices of the output are computed in parallel.
+ *
+ * @param dataType the type of the voxels.
+ * @param filter the reduction of the input voxels.
+ * @param in the input volume, x varying fastest.
+ * @param inSize the size of the input volume in voxels.
+ * @param out the output, of outSize voxels.
+ * @param outSize the size of the output in voxels.
+ * @param origin the position of the first output voxel in the halved volume.
+ * @throw std::runtime_error if the data type is undefined.
+ */
+LIVREDATA_API void downsample(DataType dataType, DownsampleFilter filter,
+                              const uint8_t* in, const Vector3ui& inSize,
+                              uint8_t* out, const Vector3ui& outSize,
+                              const Vector3i& origin = Vector3i(0));
+}
+
+#endif // _Downsample_h_
@@ -28,39 +28,389 @@
 #include <livre/data/MemoryDataSource.h>
 #include <lunchbox/pluginRegisterer.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 namespace livre
 {
 namespace
 {
 lunchbox::PluginRegisterer<MemoryDataSource> registerer;
+
+enum Pattern
+{
+    PATTERN_CONSTANT,
+    PATTERN_NOISE,
+    PATTERN_GRADIENT,
+    PATTERN_SPHERES,
+    PATTERN_BLOBS
+};
+
+const float nShells = 8.f;
+const float nBlobCells = 8.f;
+
+// Smaller bricks are generated by the calling thread, the loading threads run
+// in parallel already
+const size_t minParallelVoxels = 1 << 20;
+
+// SplitMix64, derives the keys of the random numbers
+uint64_t splitMix64(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+// Counter based random numbers: the n-th number of a key is a hash of both,
+// without any state. Voxels are thus generated in any order and in parallel,
+// and the 32 bit arithmetic vectorizes.
+inline uint32_t getRandom(const uint32_t key, const uint32_t counter)
+{
+    uint32_t x = key ^ (counter * 0x9e3779b9u);
+    x = (x ^ (x >> 16)) * 0x7feb352du;
+    x = (x ^ (x >> 15)) * 0x846ca68bu;
+    return x ^ (x >> 16);
+}
+
+// @return a random number in [0, 1)
+inline float uniform(const uint32_t key, const uint32_t counter)
+{
+    // signed, which converts to float with vector instructions
+    return float(int32_t(getRandom(key, counter) >> 8)) * (1.f / 16777216.f);
+}
+
+template <class T>
+double getMaxValue()
+{
+    return std::is_floating_point<T>::value ? 1.0
+                                            : std::numeric_limits<T>::max();
+}
+
+// @return the value of an intensity in [0, 1]
+template <class T>
+inline T toValue(const float intensity, const double maxValue)
+{
+    if (std::is_floating_point<T>::value)
+        return T(intensity * float(maxValue));
+    if (sizeof(T) < sizeof(int32_t))
+        return T(int32_t(intensity * float(maxValue)));
+    return T(int64_t(intensity * maxValue));
+}
+
+Pattern getPattern(const std::string& pattern)
+{
+    if (pattern == "constant")
+        return PATTERN_CONSTANT;
+    if (pattern == "noise")
+        return PATTERN_NOISE;
+    if (pattern == "gradient")
+        return PATTERN_GRADIENT;
+    if (pattern == "spheres")
+        return PATTERN_SPHERES;
+    if (pattern == "blobs")
+        return PATTERN_BLOBS;
+    LBTHROW(std::runtime_error("Unsupported pattern " + pattern));
+}
 }
 
-template <typename T>
-MemoryUnitPtr computeData(const LODNode& node, const size_t dataSize,
-                          const float sparsity, const Vector3ui& blockSize)
+struct MemoryDataSource::Impl
 {
-    const Identifier nodeId = node.getNodeId().getId();
-    const uint8_t* id = reinterpret_cast<const uint8_t*>(&nodeId);
-    const T value =
-        (id[0] ^ id[1] ^ id[2] ^ id[3]) + 16 +
-        127 * std::sin(((float)node.getNodeId().getTimeStep() + 1) / 200.f);
+    Impl(const servus::URI& uri, const VolumeInformation& volumeInfo)
+        : _volumeInfo(volumeInfo)
+        , _sparsity(1.f)
+        , _pattern(PATTERN_CONSTANT)
+        , _seed(0)
+    {
+        using boost::lexical_cast;
+        try
+        {
+            servus::URI::ConstKVIter i = uri.findQuery("sparsity");
+            if (i != uri.queryEnd())
+                _sparsity = lexical_cast<float>(i->second);
+
+            i = uri.findQuery("seed");
+            if (i != uri.queryEnd())
+                _seed = lexical_cast<uint64_t>(i->second);
+        }
+        catch (boost::bad_lexical_cast& except)
+            LBTHROW(std::runtime_error(except.what()));
+
+        const servus::URI::ConstKVIter i = uri.findQuery("pattern");
+        if (i != uri.queryEnd())
+            _pattern = getPattern(i->second);
+    }
 
-    AllocMemoryUnitPtr memoryUnit(new AllocMemoryUnit(dataSize));
-    T* dstData = memoryUnit->getData<T>();
-    for (size_t i = 0; i < blockSize.product(); ++i)
+    template <class T>
+    MemoryUnitPtr getData(const LODNode& node) const
     {
-        if (sparsity < 1.f)
+        const Vector3ui size =
+            node.getBlockSize() + _volumeInfo.overlap * 2;
+        const size_t dataSize = size.product() * _volumeInfo.compCount *
+                                _volumeInfo.getBytesPerVoxel();
+        MemoryUnitPtr memoryUnit(new PooledMemoryUnit(dataSize));
+        T* data = memoryUnit->getData<T>();
+
+        switch (_pattern)
+        {
+        case PATTERN_CONSTANT:
         {
-            const int32_t random = rand() % 1000000 + 1;
-            dstData[i] = random < 1000000.0f * sparsity ? value : 0;
+            const T value = getConstant<T>(node);
+            if (_sparsity >= 1.f)
+                std::fill(data, data + size.product(), value);
+            else
+                fill(node, data, value,
+                     [](uint32_t, float, float, float) { return 1.f; });
+            break;
+        }
+        case PATTERN_NOISE:
+        {
+            const uint32_t key = ~getKey(node);
+            fill(node, data, getMaxValue<T>(),
+                 [key](const uint32_t index, float, float, float) {
+                     return uniform(key, index);
+                 });
+            break;
+        }
+        case PATTERN_GRADIENT:
+            fill(node, data, getMaxValue<T>(), [](uint32_t, const float x,
+                                                  const float y,
+                                                  const float z) {
+                return std::min(std::max((x + y + z) / 3.f, 0.f), 1.f);
+            });
+            break;
+        case PATTERN_SPHERES:
+            fill(node, data, getMaxValue<T>(), [](uint32_t, const float x,
+                                                  const float y,
+                                                  const float z) {
+                const float radius =
+                    std::sqrt((x - .5f) * (x - .5f) + (y - .5f) * (y - .5f) +
+                              (z - .5f) * (z - .5f));
+                const float shell = radius * 2.f * nShells;
+                const float intensity =
+                    1.f - std::abs(2.f * (shell - std::floor(shell)) - 1.f);
+                return radius < .5f ? intensity : 0.f;
+            });
+            break;
+        case PATTERN_BLOBS:
+        {
+            // The blobs do not depend on the node, so they are sampled
+            // consistently across nodes and levels
+            const uint32_t key = uint32_t(splitMix64(_seed));
+            const float sparsity = _sparsity;
+            fill(node, data, getMaxValue<T>(),
+                 [key, sparsity](uint32_t, const float x, const float y,
+                                 const float z) {
+                     return getBlob(key, sparsity, x, y, z);
+                 });
+            break;
+        }
+        }
+        return memoryUnit;
+    }
+
+    // Fills the brick of a node with the intensities in [0, 1] of a pattern,
+    // which gets the voxel index and its position in the volume normalized to
+    // [0, 1]. Voxels are kept with the probability of the sparsity, without
+    // branches so the loops vectorize.
+    template <class T, class F>
+    void fill(const LODNode& node, T* data, const double maxValue,
+              const F pattern) const
+    {
+        const Vector3ui size = node.getBlockSize() + _volumeInfo.overlap * 2;
+        Vector3f origin;
+        Vector3f step;
+        getPositions(node, origin, step);
+
+        const uint32_t key = getKey(node);
+        const uint32_t threshold =
+            _pattern == PATTERN_BLOBS
+                ? 1u << 24
+                : uint32_t(std::min(std::max(_sparsity, 0.f), 1.f) *
+                           16777216.f);
+        const size_t width = size.x();
+        const bool parallel = size.product() >= minParallelVoxels;
+#pragma omp parallel for if (parallel)
+        for (ssize_t z = 0; z < ssize_t(size.z()); ++z)
+        {
+            const float posZ = origin.z() + z * step.z();
+            for (size_t y = 0; y < size.y(); ++y)
+            {
+                const float posY = origin.y() + y * step.y();
+                const uint32_t row = uint32_t((z * size.y() + y) * width);
+                T* out = data + row;
+                for (size_t x = 0; x < width; ++x)
+                {
+                    const uint32_t index = row + uint32_t(x);
+                    const float keep =
+                        (getRandom(key, index) >> 8) < threshold ? 1.f : 0.f;
+                    const float intensity =
+                        pattern(index, origin.x() + x * step.x(), posY, posZ);
+                    out[x] = toValue<T>(keep * intensity, maxValue);
+                }
+            }
         }
-        else
-            dstData[i] = value;
     }
-    return memoryUnit;
-}
+
+    // Gives the position of the first voxel of the brick of a node, and the
+    // distance between its voxels, in the volume normalized to [0, 1]
+    void getPositions(const LODNode& node, Vector3f& origin,
+                      Vector3f& step) const
+    {
+        const Vector3ui& overlap = _volumeInfo.overlap;
+        const uint32_t shift =
+            _volumeInfo.rootNode.getDepth() - 1 - node.getRefLevel();
+        const Vector3ui& voxelOrigin = node.getVoxelBox().getMin();
+        for (size_t i = 0; i < 3; ++i)
+        {
+            step[i] = float(1u << shift) / float(_volumeInfo.voxels[i]);
+            origin[i] = (float(voxelOrigin[i]) - float(overlap[i]) + 0.5f) *
+                        step[i];
+        }
+    }
+
+    // The blobs stay in their cells, a subtree is empty if its bricks do not
+    // reach an occupied cell. The bricks of the descendants lie within the
+    // brick of a node, extended by half a voxel.
+    bool getValueRange(const LODNode& node, Range& range) const
+    {
+        if (_pattern != PATTERN_BLOBS)
+            return false;
+
+        const Vector3ui size = node.getBlockSize() + _volumeInfo.overlap * 2;
+        Vector3f origin;
+        Vector3f step;
+        getPositions(node, origin, step);
+
+        Vector3i first;
+        Vector3i last;
+        for (size_t i = 0; i < 3; ++i)
+        {
+            const float begin = origin[i] - .5f * step[i];
+            const float end = origin[i] + (float(size[i]) - .5f) * step[i];
+            first[i] = std::max(int32_t(std::floor(begin * nBlobCells)), 0);
+            last[i] = std::min(int32_t(std::floor(end * nBlobCells)),
+                               int32_t(nBlobCells) - 1);
+        }
+
+        const uint32_t key = uint32_t(splitMix64(_seed));
+        range = Range{{0.f, 0.f}};
+        for (int32_t z = first.z(); z <= last.z(); ++z)
+            for (int32_t y = first.y(); y <= last.y(); ++y)
+                for (int32_t x = first.x(); x <= last.x(); ++x)
+                {
+                    const uint32_t cell =
+                        5 * uint32_t((z * nBlobCells + y) * nBlobCells + x);
+                    if (uniform(key, cell) < _sparsity)
+                    {
+                        range[1] = getFullValue();
+                        return true;
+                    }
+                }
+        return true;
+    }
+
+    float getFullValue() const
+    {
+        switch (_volumeInfo.dataType)
+        {
+        case DT_UINT8:
+            return livre::getMaxValue<uint8_t>();
+        case DT_UINT16:
+            return livre::getMaxValue<uint16_t>();
+        case DT_UINT32:
+            return livre::getMaxValue<uint32_t>();
+        case DT_INT8:
+            return livre::getMaxValue<int8_t>();
+        case DT_INT16:
+            return livre::getMaxValue<int16_t>();
+        case DT_INT32:
+            return livre::getMaxValue<int32_t>();
+        case DT_FLOAT:
+        default:
+            return 1.f;
+        }
+    }
+
+    uint32_t getKey(const LODNode& node) const
+    {
+        return uint32_t(
+            splitMix64(_seed ^ splitMix64(node.getNodeId().getId())));
+    }
+
+    MemoryUnitPtr getData(const LODNode& node) const
+    {
+        switch (_volumeInfo.dataType)
+        {
+        case DT_UINT8:
+            return getData<uint8_t>(node);
+        case DT_UINT16:
+            return getData<uint16_t>(node);
+        case DT_UINT32:
+            return getData<uint32_t>(node);
+        case DT_INT8:
+            return getData<int8_t>(node);
+        case DT_INT16:
+            return getData<int16_t>(node);
+        case DT_INT32:
+            return getData<int32_t>(node);
+        case DT_FLOAT:
+            return getData<float>(node);
+        default:
+            LBTHROW(std::runtime_error("Unimplemented data type."));
+        }
+    }
+
+    template <class T>
+    T getConstant(const LODNode& node) const
+    {
+        const Identifier nodeId = node.getNodeId().getId();
+        const uint8_t* id = reinterpret_cast<const uint8_t*>(&nodeId);
+        return (id[0] ^ id[1] ^ id[2] ^ id[3]) + 16 +
+               127 * std::sin(((float)node.getNodeId().getTimeStep() + 1) /
+                              200.f);
+    }
+
+    // @return the intensity of the blob in the grid cell of the position
+    static float getBlob(const uint32_t key, const float sparsity,
+                         const float x, const float y, const float z)
+    {
+        const float cellX = std::floor(x * nBlobCells);
+        const float cellY = std::floor(y * nBlobCells);
+        const float cellZ = std::floor(z * nBlobCells);
+        if (std::min(std::min(cellX, cellY), cellZ) < 0.f ||
+            std::max(std::max(cellX, cellY), cellZ) >= nBlobCells)
+        {
+            return 0.f;
+        }
+
+        const uint32_t cell =
+            5 * uint32_t((cellZ * nBlobCells + cellY) * nBlobCells + cellX);
+        if (uniform(key, cell) >= sparsity)
+            return 0.f;
+
+        // A center and a radius in the cell, the blob stays in its cell
+        const float radius = .1f + .15f * uniform(key, cell + 4);
+        const float centerX = cellX + .25f + .5f * uniform(key, cell + 1);
+        const float centerY = cellY + .25f + .5f * uniform(key, cell + 2);
+        const float centerZ = cellZ + .25f + .5f * uniform(key, cell + 3);
+        const float dx = x * nBlobCells - centerX;
+        const float dy = y * nBlobCells - centerY;
+        const float dz = z * nBlobCells - centerZ;
+        const float distance =
+            (dx * dx + dy * dy + dz * dz) / (radius * radius);
+        return distance < 1.f ? (1.f - distance) * (1.f - distance) : 0.f;
+    }
+
+    const VolumeInformation& _volumeInfo;
+    float _sparsity;
+    Pattern _pattern;
+    uint64_t _seed;
+};
 
 MemoryDataSource::MemoryDataSource(const DataSourcePluginData& initData)
+    : _impl(new Impl(initData.getURI(), _volumeInfo))
 {
     _volumeInfo.overlap = Vector3ui(4);
 
@@ -70,29 +420,21 @@ MemoryDataSource::MemoryDataSource(const DataSourcePluginData& initData)
                             boost::is_any_of(","));
 
     using boost::lexical_cast;
-    try
-    {
-        servus::URI::ConstKVIter i = uri.findQuery("sparsity");
-        _sparsity = i == uri.queryEnd() ? 1.0f : lexical_cast<float>(i->second);
-
-        i = uri.findQuery("datatype");
-        if (i == uri.queryEnd() || i->second == "uint8")
-            _volumeInfo.dataType = DT_UINT8;
-        else if (i->second == "uint16")
-            _volumeInfo.dataType = DT_UINT16;
-        else if (i->second == "uint32")
-            _volumeInfo.dataType = DT_UINT32;
-        else if (i->second == "int8" || i->second == "char")
-            _volumeInfo.dataType = DT_INT8;
-        else if (i->second == "int16" || i->second == "short")
-            _volumeInfo.dataType = DT_INT16;
-        else if (i->second == "int32")
-            _volumeInfo.dataType = DT_INT32;
-        else if (i->second == "float")
-            _volumeInfo.dataType = DT_FLOAT;
-    }
-    catch (boost::bad_lexical_cast& except)
-        LBTHROW(std::runtime_error(except.what()));
+    servus::URI::ConstKVIter i = uri.findQuery("datatype");
+    if (i == uri.queryEnd() || i->second == "uint8")
+        _volumeInfo.dataType = DT_UINT8;
+    else if (i->second == "uint16")
+        _volumeInfo.dataType = DT_UINT16;
+    else if (i->second == "uint32")
+        _volumeInfo.dataType = DT_UINT32;
+    else if (i->second == "int8" || i->second == "char")
+        _volumeInfo.dataType = DT_INT8;
+    else if (i->second == "int16" || i->second == "short")
+        _volumeInfo.dataType = DT_INT16;
+    else if (i->second == "int32")
+        _volumeInfo.dataType = DT_INT32;
+    else if (i->second == "float")
+        _volumeInfo.dataType = DT_FLOAT;
 
     if (parameters.size() < 4) // use defaults
     {
@@ -125,29 +467,18 @@ MemoryDataSource::~MemoryDataSource()
 
 MemoryUnitPtr MemoryDataSource::getData(const LODNode& node)
 {
-    const Vector3ui blockSize = node.getBlockSize() + _volumeInfo.overlap * 2;
-    const size_t dataSize = blockSize.product() * _volumeInfo.compCount *
-                            _volumeInfo.getBytesPerVoxel();
+    return _impl->getData(node);
+}
 
-    switch (_volumeInfo.dataType)
-    {
-    case DT_UINT8:
-        return computeData<uint8_t>(node, dataSize, _sparsity, blockSize);
-    case DT_UINT16:
-        return computeData<uint16_t>(node, dataSize, _sparsity, blockSize);
-    case DT_UINT32:
-        return computeData<uint32_t>(node, dataSize, _sparsity, blockSize);
-    case DT_INT8:
-        return computeData<int8_t>(node, dataSize, _sparsity, blockSize);
-    case DT_INT16:
-        return computeData<int16_t>(node, dataSize, _sparsity, blockSize);
-    case DT_INT32:
-        return computeData<int32_t>(node, dataSize, _sparsity, blockSize);
-    case DT_FLOAT:
-        return computeData<float>(node, dataSize, _sparsity, blockSize);
-    default:
-        LBTHROW(std::runtime_error("Unimplemented data type."));
-    }
+bool MemoryDataSource::getValueRange(const LODNode& node, Range& range) const
+{
+    return _impl->getValueRange(node, range);
+}
+
+std::future<void> MemoryDataSource::getDataAsync(const LODNodes& nodes,
+                                                 const DataCallback& callback)
+{
+    return getDataParallel(nodes, callback);
 }
 
 bool MemoryDataSource::handles(const DataSourcePluginData& initData)
@@ -159,7 +490,9 @@ std::string MemoryDataSource::getDescription()
 {
     return R"(Memory dummy volume: mem://[?query parameters][#fragment]
   with optional query parameters:
+    pattern=constant, noise, gradient, spheres, blobs
     sparsity=<float>
+    seed=<integer>
     datatype=(u)int(8,16,32), float
   and optional fragment:
     <width>,<height>,<depth>,<blocksize>)";
@@ -29,9 +29,20 @@ namespace livre
 /**
  * Generates in-memory volume data.
  *
+ * The "pattern" parameter selects the generated data:
+ * - constant: one value per node (default)
+ * - noise: uniformly distributed random values
+ * - gradient: a linear ramp along the volume diagonal
+ * - spheres: concentric spherical shells around the volume center
+ * - blobs: sparse round blobs, one per occupied cell of an 8x8x8 grid
+ *
  * The "sparsity" parameter is the sparsity of the data between 0.0
  * and 1.0. 1.0 means no voxels will be empty. 0.0 means all voxels
- * will be empty. 0.001 means 99.9% of the voxels will be empty.
+ * will be empty. 0.001 means 99.9% of the voxels will be empty. For blobs, it
+ * is the fraction of the occupied cells.
+ *
+ * The random numbers are a hash of the "seed" parameter, the node and the
+ * voxel, so the data is reproducible and bricks are generated in parallel.
  *
  * The "datatype" parameter sets the volume data type.
  *
@@ -51,11 +62,27 @@ public:
      */
     MemoryUnitPtr getData(const LODNode& node) final;
 
+    /**
+     * @copydoc DataSourcePlugin::getDataAsync()
+     *
+     * The bricks are generated from several threads.
+     */
+    std::future<void> getDataAsync(const LODNodes& nodes,
+                                   const DataCallback& callback) final;
+
+    /**
+     * @copydoc DataSourcePlugin::getValueRange()
+     *
+     * Known for the blobs pattern only.
+     */
+    bool getValueRange(const LODNode& node, Range& range) const final;
+
     static bool handles(const DataSourcePluginData& initData);
     static std::string getDescription();
 
 private:
-    float _sparsity;
+    struct Impl;
+    std::unique_ptr<Impl> _impl;
 };
 }
 
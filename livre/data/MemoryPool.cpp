@@ -0,0 +1,270 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/data/MemoryPool.h>
+
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <sys/mman.h>
+
+namespace livre
+{
+namespace
+{
+typedef boost::unique_lock<boost::mutex> ScopedLock;
+
+const size_t slotAlignment = 64;
+const size_t pageSize = 4096;
+const size_t hugePageSize = 2 * 1024 * 1024;
+const size_t slabSize = 16 * 1024 * 1024;
+
+size_t roundUp(const size_t size, const size_t alignment)
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+// Maps anonymous memory, aligned to the huge page size if it is backed by
+// huge pages
+uint8_t* mapSlab(const size_t size, const bool hugePages)
+{
+    const size_t mapSize = hugePages ? size + hugePageSize : size;
+    void* ptr = ::mmap(nullptr, mapSize, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED)
+        LBTHROW(std::bad_alloc());
+
+    uint8_t* data = static_cast<uint8_t*>(ptr);
+    if (!hugePages)
+        return data;
+
+    uint8_t* aligned = reinterpret_cast<uint8_t*>(
+        roundUp(reinterpret_cast<uintptr_t>(data), hugePageSize));
+    if (aligned > data)
+        ::munmap(data, aligned - data);
+    if (data + mapSize > aligned + size)
+        ::munmap(aligned + size, data + mapSize - (aligned + size));
+#ifdef MADV_HUGEPAGE
+    ::madvise(aligned, size, MADV_HUGEPAGE);
+#endif
+    return aligned;
+}
+
+struct Slab
+{
+    uint8_t* data;
+    size_t size;
+    size_t slotSize;
+    size_t slots;
+    size_t freeSlots;
+    bool hugePages;
+};
+}
+
+struct MemoryPool::Impl
+{
+    explicit Impl(const bool hugePages_)
+        : hugePages(hugePages_)
+        , usedBytes(0)
+        , allocations(0)
+        , reuses(0)
+    {
+    }
+
+    ~Impl()
+    {
+        for (const auto& slab : slabs)
+            ::munmap(slab.second.data, slab.second.size);
+    }
+
+    // The slab of a slot is the last one starting at or before it
+    Slab& findSlab(uint8_t* slot)
+    {
+        auto i = slabs.upper_bound(slot);
+        LBASSERT(i != slabs.begin());
+        return (--i)->second;
+    }
+
+    // The slabs of a size grow geometrically up to the slab size
+    void addSlab(const size_t slotSize)
+    {
+        const size_t maxSlots = std::max(slabSize / slotSize, size_t(1));
+        size_t& next = nextSlots[slotSize];
+        const size_t nSlots = std::min(std::max(next, size_t(1)), maxSlots);
+
+        // The rounding to pages gives room for additional slots
+        const size_t size =
+            roundUp(nSlots * slotSize, hugePages ? hugePageSize : pageSize);
+        const Slab slab = {mapSlab(size, hugePages), size,
+                           slotSize, size / slotSize,
+                           size / slotSize, hugePages};
+        next = std::min(2 * nSlots, maxSlots);
+
+        // The first slot of the slab is the next one to be used
+        std::vector<uint8_t*>& slots = freeSlots[slotSize];
+        for (size_t i = slab.slots; i > 0; --i)
+            slots.push_back(slab.data + (i - 1) * slotSize);
+        slabs[slab.data] = slab;
+    }
+
+    uint8_t* allocate(const size_t slotSize)
+    {
+        ScopedLock lock(mutex);
+        std::vector<uint8_t*>& slots = freeSlots[slotSize];
+        if (slots.empty())
+            addSlab(slotSize);
+        else
+            ++reuses;
+
+        uint8_t* slot = slots.back();
+        slots.pop_back();
+        --findSlab(slot).freeSlots;
+        usedBytes += slotSize;
+        ++allocations;
+        return slot;
+    }
+
+    void deallocate(uint8_t* slot, const size_t slotSize)
+    {
+        ScopedLock lock(mutex);
+        freeSlots[slotSize].push_back(slot);
+        ++findSlab(slot).freeSlots;
+        usedBytes -= slotSize;
+    }
+
+    size_t trim()
+    {
+        ScopedLock lock(mutex);
+        size_t freed = 0;
+        for (auto i = slabs.begin(); i != slabs.end();)
+        {
+            const Slab& slab = i->second;
+            if (slab.freeSlots < slab.slots)
+            {
+                ++i;
+                continue;
+            }
+
+            std::vector<uint8_t*>& slots = freeSlots[slab.slotSize];
+            slots.erase(std::remove_if(slots.begin(), slots.end(),
+                                       [&slab](const uint8_t* slot) {
+                                           return slot >= slab.data &&
+                                                  slot < slab.data + slab.size;
+                                       }),
+                        slots.end());
+            ::munmap(slab.data, slab.size);
+            freed += slab.size;
+            i = slabs.erase(i);
+        }
+        return freed;
+    }
+
+    Statistics getStatistics() const
+    {
+        ScopedLock lock(mutex);
+        Statistics statistics = {slabs.size(), 0, usedBytes, 0, allocations,
+                                 reuses};
+        for (const auto& slab : slabs)
+        {
+            statistics.reservedBytes += slab.second.size;
+            if (slab.second.hugePages)
+                statistics.hugePageBytes += slab.second.size;
+        }
+        return statistics;
+    }
+
+    mutable boost::mutex mutex;
+    bool hugePages;
+    std::map<uint8_t*, Slab> slabs; // by address
+    std::map<size_t, std::vector<uint8_t*>> freeSlots; // by slot size
+    std::map<size_t, size_t> nextSlots; // of the next slab, by slot size
+    size_t usedBytes;
+    size_t allocations;
+    size_t reuses;
+};
+
+MemoryPool::MemoryPool(const bool hugePages)
+    : _impl(new Impl(hugePages))
+{
+}
+
+MemoryPool::~MemoryPool()
+{
+}
+
+MemoryPool& MemoryPool::getInstance()
+{
+    // Never destroyed, buffers may still be released at static destruction
+    static MemoryPool* pool = new MemoryPool;
+    return *pool;
+}
+
+uint8_t* MemoryPool::allocate(const size_t size)
+{
+    if (size < pageSize)
+    {
+        void* buffer = nullptr;
+        if (::posix_memalign(&buffer, slotAlignment, std::max(size, size_t(1))))
+            LBTHROW(std::bad_alloc());
+        return static_cast<uint8_t*>(buffer);
+    }
+    return _impl->allocate(roundUp(size, slotAlignment));
+}
+
+void MemoryPool::deallocate(uint8_t* buffer, const size_t size)
+{
+    if (size < pageSize)
+        ::free(buffer);
+    else
+        _impl->deallocate(buffer, roundUp(size, slotAlignment));
+}
+
+void MemoryPool::setHugePages(const bool hugePages)
+{
+    ScopedLock lock(_impl->mutex);
+    _impl->hugePages = hugePages;
+}
+
+size_t MemoryPool::trim()
+{
+    return _impl->trim();
+}
+
+MemoryPool::Statistics MemoryPool::getStatistics() const
+{
+    return _impl->getStatistics();
+}
+
+std::ostream& operator<<(std::ostream& stream,
+                         const MemoryPool::Statistics& statistics)
+{
+    const float reuse =
+        statistics.allocations > 0
+            ? 100.f * statistics.reuses / statistics.allocations
+            : 0.f;
+    return stream << "Memory pool: " << statistics.usedBytes / LB_1MB
+                  << " MB used of " << statistics.reservedBytes / LB_1MB
+                  << " MB in " << statistics.slabs << " slabs ("
+                  << statistics.hugePageBytes / LB_1MB
+                  << " MB huge pages), " << int(reuse + .5f) << "% reused";
+}
+}
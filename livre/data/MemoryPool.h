@@ -0,0 +1,107 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _MemoryPool_h_
+#define _MemoryPool_h_
+
+#include <livre/data/api.h>
+#include <livre/data/types.h>
+
+namespace livre
+{
+/**
+ * The MemoryPool class recycles the buffers of the volume data. Almost all
+ * bricks of a volume have the same size, so the pool carves fixed-size slots
+ * out of large slabs and keeps the slots of released buffers for the next
+ * allocation of the same size, instead of allocating every brick on the
+ * heap. This avoids heap fragmentation and the page faults of fresh memory
+ * while streaming bricks.
+ *
+ * The first slab of a size holds one slot, and each further slab twice as
+ * many up to 16 MB, so rarely used sizes only reserve what they use. The
+ * slabs may be backed by transparent huge pages. Slabs are only given back
+ * to the operating system by trim(). Buffers smaller than a page are
+ * allocated on the heap and are not part of the statistics. All methods
+ * are thread safe.
+ */
+class MemoryPool
+{
+public:
+    /** The usage of the pool */
+    struct Statistics
+    {
+        size_t slabs;         //!< Number of slabs
+        size_t reservedBytes; //!< Size of the slabs
+        size_t usedBytes;     //!< Size of the slots in use
+        size_t hugePageBytes; //!< Size of the slabs backed by huge pages
+        size_t allocations;   //!< Number of slot allocations
+        size_t reuses;        //!< Allocations served by a released slot
+    };
+
+    /**
+     * @param hugePages back new slabs by transparent huge pages.
+     */
+    LIVREDATA_API explicit MemoryPool(bool hugePages = false);
+
+    /** Frees the slabs, all buffers have to be deallocated before. */
+    LIVREDATA_API ~MemoryPool();
+
+    /** @return the pool of the volume data of the process. */
+    LIVREDATA_API static MemoryPool& getInstance();
+
+    /**
+     * @param size the size of the buffer in bytes.
+     * @return a buffer aligned to 64 bytes.
+     * @throw std::bad_alloc if no memory is available.
+     */
+    LIVREDATA_API uint8_t* allocate(size_t size);
+
+    /**
+     * Releases a buffer for reuse.
+     * @param buffer the buffer returned by allocate().
+     * @param size the size given to allocate().
+     */
+    LIVREDATA_API void deallocate(uint8_t* buffer, size_t size);
+
+    /** Backs slabs allocated from now on by transparent huge pages. */
+    LIVREDATA_API void setHugePages(bool hugePages);
+
+    /**
+     * Gives the slabs without buffers in use back to the operating system.
+     * @return the number of bytes freed.
+     */
+    LIVREDATA_API size_t trim();
+
+    /** @return the usage of the pool. */
+    LIVREDATA_API Statistics getStatistics() const;
+
+private:
+    MemoryPool(const MemoryPool&) = delete;
+    MemoryPool& operator=(const MemoryPool&) = delete;
+
+    struct Impl;
+    std::unique_ptr<Impl> _impl;
+};
+
+/** Outputs the usage of a pool. */
+LIVREDATA_API std::ostream& operator<<(
+    std::ostream& stream, const MemoryPool::Statistics& statistics);
+}
+
+#endif // _MemoryPool_h_
@@ -19,8 +19,26 @@
 
 #include <livre/data/MemoryUnit.h>
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 namespace livre
 {
+namespace
+{
+size_t getPageSize()
+{
+#ifdef _WIN32
+    return 4096;
+#else
+    static const size_t pageSize = ::sysconf(_SC_PAGESIZE);
+    return pageSize;
+#endif
+}
+}
+
 MemoryUnit::MemoryUnit()
 {
 }
@@ -29,9 +47,11 @@ MemoryUnit::~MemoryUnit()
 {
 }
 
-ConstMemoryUnit::ConstMemoryUnit(const uint8_t* ptr, const size_t size)
+ConstMemoryUnit::ConstMemoryUnit(const uint8_t* ptr, const size_t size,
+                                 std::shared_ptr<const void> owner)
     : ptr_(ptr)
     , size_(size)
+    , owner_(owner)
 {
 }
 
@@ -40,6 +60,26 @@ const uint8_t* ConstMemoryUnit::_getData() const
     return ptr_;
 }
 
+void ConstMemoryUnit::prefetch() const
+{
+    if (size_ == 0)
+        return;
+
+    const size_t pageSize = getPageSize();
+#ifndef _WIN32
+    const size_t offset = uintptr_t(ptr_) % pageSize;
+    ::posix_madvise(const_cast<uint8_t*>(ptr_ - offset), size_ + offset,
+                    POSIX_MADV_WILLNEED);
+#endif
+    uint8_t sum = 0;
+    for (size_t i = 0; i < size_; i += pageSize)
+        sum ^= ptr_[i];
+    sum ^= ptr_[size_ - 1];
+
+    static volatile uint8_t sink;
+    sink = sum;
+}
+
 size_t AllocMemoryUnit::getAllocSize() const
 {
     return _rawData.getMaxSize();
@@ -65,4 +105,58 @@ uint8_t* AllocMemoryUnit::_getData()
 {
     return _rawData.getData();
 }
+
+VectorMemoryUnit::VectorMemoryUnit(std::vector<uint8_t>&& data)
+    : _data(std::move(data))
+{
+}
+
+size_t VectorMemoryUnit::getAllocSize() const
+{
+    return _data.size();
+}
+
+const uint8_t* VectorMemoryUnit::_getData() const
+{
+    return _data.data();
+}
+
+uint8_t* VectorMemoryUnit::_getData()
+{
+    return _data.data();
+}
+
+PooledMemoryUnit::PooledMemoryUnit(const size_t size, MemoryPool& pool)
+    : _pool(pool)
+    , _size(size)
+    , _data(pool.allocate(size))
+{
+}
+
+PooledMemoryUnit::PooledMemoryUnit(const void* sourceData, const size_t size,
+                                   MemoryPool& pool)
+    : PooledMemoryUnit(size, pool)
+{
+    ::memcpy(_data, sourceData, size);
+}
+
+PooledMemoryUnit::~PooledMemoryUnit()
+{
+    _pool.deallocate(_data, _size);
+}
+
+size_t PooledMemoryUnit::getAllocSize() const
+{
+    return _size;
+}
+
+const uint8_t* PooledMemoryUnit::_getData() const
+{
+    return _data;
+}
+
+uint8_t* PooledMemoryUnit::_getData()
+{
+    return _data;
+}
 }
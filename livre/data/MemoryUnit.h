@@ -20,6 +20,7 @@
 #ifndef _MemoryUnit_h_
 #define _MemoryUnit_h_
 
+#include <livre/data/MemoryPool.h> // default pool
 #include <livre/data/api.h>
 #include <livre/data/types.h>
 #include <lunchbox/buffer.h> // member
@@ -53,6 +54,17 @@ public:
     /** @return The allocated heap size. */
     virtual size_t getAllocSize() const = 0;
 
+    /**
+     * @return true if the memory is not owned by the unit but references the
+     *         memory of the data source, e.g. a file mapping.
+     */
+    virtual bool isMapped() const { return false; }
+    /**
+     * Faults in the pages of referenced memory, which the OS may have
+     * reclaimed since the data was read. No-op for owned memory.
+     */
+    virtual void prefetch() const {}
+
 protected:
     /** @return The unsigned char memory ptr to data */
     virtual const uint8_t* _getData() const = 0;
@@ -89,8 +101,19 @@ private:
 class ConstMemoryUnit : public MemoryUnit
 {
 public:
-    ConstMemoryUnit(const uint8_t* ptr, size_t size);
+    /**
+     * @param ptr the memory.
+     * @param size the size of the memory in bytes.
+     * @param owner optional owner of the memory, e.g. a file mapping, which
+     * is kept alive as long as the memory unit.
+     */
+    LIVREDATA_API ConstMemoryUnit(const uint8_t* ptr, size_t size,
+                                  std::shared_ptr<const void> owner = nullptr);
     ~ConstMemoryUnit() {}
+    bool isMapped() const final { return true; }
+    /** Advises the kernel to read the pages and touches each of them. */
+    LIVREDATA_API void prefetch() const final;
+
 protected:
     size_t getAllocSize() const final { return size_; }
     const uint8_t* _getData() const final;
@@ -101,6 +124,7 @@ protected:
     }
     const uint8_t* const ptr_;
     const size_t size_;
+    const std::shared_ptr<const void> owner_;
 };
 
 /**
@@ -165,6 +189,65 @@ private:
     lunchbox::Bufferb _rawData;
     LB_TS_VAR(thread_);
 };
+
+/**
+ * The VectorMemoryUnit class takes over the memory of a vector, e.g. the
+ * result of livre::compress(), without copying it.
+ */
+class VectorMemoryUnit : public MemoryUnit
+{
+public:
+    /** @param data the data, which is moved into the memory unit. */
+    LIVREDATA_API explicit VectorMemoryUnit(std::vector<uint8_t>&& data);
+    LIVREDATA_API size_t getAllocSize() const final;
+
+private:
+    const uint8_t* _getData() const final;
+    uint8_t* _getData() final;
+
+    std::vector<uint8_t> _data;
+};
+
+/**
+ * The PooledMemoryUnit class holds a buffer of a \see MemoryPool, which is
+ * returned to the pool for reuse on destruction. Data sources allocate their
+ * bricks from the pool of the process.
+ */
+class PooledMemoryUnit : public MemoryUnit
+{
+public:
+    /**
+     * Allocates memory in bytes in given size from a pool.
+     * @param size memory size
+     * @param pool the pool, which has to outlive the memory unit.
+     */
+    LIVREDATA_API explicit PooledMemoryUnit(
+        size_t size, MemoryPool& pool = MemoryPool::getInstance());
+
+    /**
+     * Allocates memory from a pool and copies the data from the given source
+     * @param sourceData Source data ptr.
+     * @param size Number of the bytes in the source data ptr.
+     * @param pool the pool, which has to outlive the memory unit.
+     */
+    LIVREDATA_API PooledMemoryUnit(
+        const void* sourceData, size_t size,
+        MemoryPool& pool = MemoryPool::getInstance());
+
+    LIVREDATA_API ~PooledMemoryUnit();
+    LIVREDATA_API size_t getAllocSize() const final;
+
+private:
+    PooledMemoryUnit(const PooledMemoryUnit&) = delete;
+    PooledMemoryUnit& operator=(const PooledMemoryUnit&) = delete;
+
+    const uint8_t* _getData() const final;
+    uint8_t* _getData() final;
+
+    MemoryPool& _pool;
+    const size_t _size;
+    uint8_t* const _data;
+};
 }
 
 #endif // _MemoryUnit_h_
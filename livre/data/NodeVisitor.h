@@ -47,6 +47,27 @@ public:
 
     /** Called after all traversal. */
     virtual void visitPost(){};
+
+    /**
+     * Create a visitor for a part of the tree traversed in parallel.
+     *
+     * Only visit() is called on the returned visitor, its results are merged
+     * back with join(). Only called if canFork() is true.
+     * @return the new visitor, or an empty pointer if not supported.
+     */
+    virtual std::unique_ptr<NodeVisitor> fork() const { return nullptr; }
+    /**
+     * @return true if fork() is implemented, false by default, which makes
+     *         parallel traversals serial.
+     */
+    virtual bool canFork() const { return false; }
+    /**
+     * Merge the results of a visitor created by fork(). The forked visitors
+     * are joined in the order of a serial traversal.
+     * @param visitor the forked visitor, after its part of the tree has been
+     *        traversed.
+     */
+    virtual void join(NodeVisitor& /*visitor*/) {}
 };
 }
 
@@ -19,18 +19,27 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <livre/data/Downsample.h>
 #include <livre/data/LODNode.h>
 #include <livre/data/MemoryUnit.h>
 #include <livre/data/RawDataSource.h>
+#include <livre/data/ValueRange.h>
 
 #include <lunchbox/memoryMap.h>
 #include <lunchbox/pluginRegisterer.h>
+#include <lunchbox/thread.h>
 
 #include "nrrd/nrrd.hxx"
 
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <mutex>
 
 namespace livre
 {
@@ -38,6 +47,13 @@ namespace
 {
 lunchbox::PluginRegisterer<RawDataSource> registerer;
 
+const uint32_t defaultBrickSize = 128;
+const uint32_t defaultOverlap = 2;
+
+// The initial range of a cell, the first value replaces it
+const Range EMPTY_RANGE = {{std::numeric_limits<float>::max(),
+                            std::numeric_limits<float>::lowest()}};
+
 template <class I, class O>
 void _scale(
     const I* in, O* out, const ssize_t nElems,
@@ -50,16 +66,72 @@ void _scale(
 }
 
 template <class I, class O>
-MemoryUnitPtr _scale(const uint8_t* ptr, const size_t size)
+MemoryUnitPtr _scale(const uint8_t* ptr, const size_t nElems)
 {
-    const ssize_t nElems = size / sizeof(O);
-    auto memory = MemoryUnitPtr(new AllocMemoryUnit(size));
+    auto memory = MemoryUnitPtr(new PooledMemoryUnit(nElems * sizeof(O)));
     const I* in = reinterpret_cast<const I*>(ptr);
     O* out = memory->getData<O>();
 
     _scale(in, out, nElems);
     return memory;
 }
+
+// Copies a box of a level to a brick, voxels outside of the level are 0
+void _copyBrick(const uint8_t* level, const Vector3ui& levelSize,
+                const int32_t (&origin)[3], const Vector3ui& size,
+                const size_t bytesPerVoxel, uint8_t* brick)
+{
+    const int32_t x0 = std::max(origin[0], 0);
+    const int32_t x1 =
+        std::min(origin[0] + int32_t(size.x()), int32_t(levelSize.x()));
+    const size_t rowBytes = size.x() * bytesPerVoxel;
+    for (uint32_t z = 0; z < size.z(); ++z)
+    {
+        for (uint32_t y = 0; y < size.y(); ++y)
+        {
+            uint8_t* row = brick + (size_t(z) * size.y() + y) * rowBytes;
+            const int32_t levelY = origin[1] + int32_t(y);
+            const int32_t levelZ = origin[2] + int32_t(z);
+            if (x0 >= x1 || levelY < 0 || levelZ < 0 ||
+                levelY >= int32_t(levelSize.y()) ||
+                levelZ >= int32_t(levelSize.z()))
+            {
+                ::memset(row, 0, rowBytes);
+                continue;
+            }
+
+            const size_t lead = (x0 - origin[0]) * bytesPerVoxel;
+            const size_t count = (x1 - x0) * bytesPerVoxel;
+            const size_t index =
+                (size_t(levelZ) * levelSize.y() + levelY) * levelSize.x() + x0;
+            ::memset(row, 0, lead);
+            ::memcpy(row + lead, level + index * bytesPerVoxel, count);
+            ::memset(row + lead + count, 0, rowBytes - lead - count);
+        }
+    }
+}
+
+uint32_t _getQuery(const servus::URI& uri, const std::string& key,
+                   const uint32_t defaultValue)
+{
+    const auto i = uri.findQuery(key);
+    if (i == uri.queryEnd())
+        return defaultValue;
+    try
+    {
+        return boost::lexical_cast<uint32_t>(i->second);
+    }
+    catch (const boost::bad_lexical_cast& except)
+    {
+        LBTHROW(std::runtime_error(key + ": " + except.what()));
+    }
+}
+
+size_t _getIndex(const Vector3ui& size, const uint32_t x, const uint32_t y,
+                 const uint32_t z)
+{
+    return (size_t(z) * size.y() + y) * size.x() + x;
+}
 }
 
 using boost::lexical_cast;
@@ -69,7 +141,14 @@ struct RawDataSource::Impl
     Impl(const DataSourcePluginData& initData, VolumeInformation& volInfo)
         : _headerSize(0)
         , _inputType(DT_UINT8)
+        , _filter(DF_BOX)
         , _outputType(DT_UINT8)
+        , _bytesPerVoxel(0)
+        , _outputShift(0)
+        , _depth(1)
+        , _brickSize(0)
+        , _rangesReady(false)
+        , _stopRanges(false)
     {
         const servus::URI& uri = initData.getURI();
         const std::string& path = uri.getPath();
@@ -88,14 +167,14 @@ struct RawDataSource::Impl
 
         volInfo.frameRange = Vector2ui(0u, 1u);
         volInfo.compCount = 1;
-        volInfo.worldSpacePerVoxel = 1.0f / float(volInfo.voxels.find_max());
-        volInfo.worldSize =
-            Vector3f(volInfo.voxels[0], volInfo.voxels[1], volInfo.voxels[2]) *
-            volInfo.worldSpacePerVoxel;
+        _bytesPerVoxel = volInfo.getBytesPerVoxel();
+        if (_mmap.getSize() < _headerSize + volInfo.voxels.product() *
+                                                _bytesPerVoxel)
+        {
+            LBTHROW(std::runtime_error("Volume file is too small"));
+        }
 
-        volInfo.overlap = Vector3ui(0u);
-        volInfo.rootNode = RootNode(1, Vector3ui(1));
-        volInfo.maximumBlockSize = volInfo.voxels;
+        setupBricks(uri, volInfo);
 
         _inputType = volInfo.dataType;
         const auto output = uri.findQuery("output");
@@ -105,28 +184,392 @@ struct RawDataSource::Impl
         {
             _outputType = getDataType(output->second);
             volInfo.dataType = _outputType;
+            if (_bytesPerVoxel > volInfo.getBytesPerVoxel())
+                _outputShift =
+                    (_bytesPerVoxel - volInfo.getBytesPerVoxel()) * 8;
+        }
+    }
+
+    ~Impl()
+    {
+        _stopRanges = true;
+        if (_rangeThread.joinable())
+            _rangeThread.join();
+    }
+
+    // Volumes larger than a brick are cut into an octree of bricks, whose
+    // coarser levels are downsampled on demand
+    void setupBricks(const servus::URI& uri, VolumeInformation& volInfo)
+    {
+        const uint32_t brickSize = _getQuery(uri, "brick", defaultBrickSize);
+        if (brickSize == 0)
+            LBTHROW(std::runtime_error("Invalid brick size"));
+        _brickSize = brickSize;
+
+        _voxels = volInfo.voxels;
+        if (volInfo.voxels.find_max() <= brickSize)
+        {
+            volInfo.worldSpacePerVoxel =
+                1.0f / float(volInfo.voxels.find_max());
+            volInfo.worldSize = Vector3f(volInfo.voxels[0], volInfo.voxels[1],
+                                         volInfo.voxels[2]) *
+                                volInfo.worldSpacePerVoxel;
+            volInfo.overlap = Vector3ui(0u);
+            volInfo.rootNode = RootNode(1, Vector3ui(1));
+            volInfo.maximumBlockSize = volInfo.voxels;
+        }
+        else
+        {
+            volInfo.overlap =
+                Vector3ui(_getQuery(uri, "overlap", defaultOverlap));
+            volInfo.maximumBlockSize =
+                Vector3ui(brickSize) + volInfo.overlap * 2;
+            fillRegularVolumeInfo(volInfo);
+
+            // The bricks of the finest level cover more than the volume, the
+            // world size covers the bricks to keep them cubic
+            const Vector3ui extent =
+                volInfo.rootNode.getBlockSize(volInfo.rootNode.getDepth() -
+                                              1) *
+                brickSize;
+            volInfo.worldSpacePerVoxel = 1.0f / float(extent.find_max());
+            volInfo.worldSize = Vector3f(extent[0], extent[1], extent[2]) *
+                                volInfo.worldSpacePerVoxel;
         }
+
+        _depth = volInfo.rootNode.getDepth();
+        _overlap = volInfo.overlap;
+        _levels.resize(_depth);
+        _levelLoaded.reset(new std::once_flag[_depth]);
+
+        _levelDirectory = getLevelDirectory(uri);
+        const auto filter = uri.findQuery("filter");
+        if (filter != uri.queryEnd())
+            _filter = getFilter(filter->second);
+        _levelPrefix = getLevelPrefix(uri.getPath(), volInfo);
+    }
+
+    // The levels are kept next to the volume by default, so later runs reuse
+    // them, unless its directory is read-only
+    boost::filesystem::path getLevelDirectory(const servus::URI& uri) const
+    {
+        namespace fs = boost::filesystem;
+        const auto directory = uri.findQuery("lod-dir");
+        if (directory != uri.queryEnd())
+            return fs::path(directory->second);
+
+        const fs::path volumeDirectory = fs::absolute(_dataFile).parent_path();
+        const fs::path probe =
+            fs::unique_path(volumeDirectory / "livre-%%%%%%.probe");
+        const bool writable = !!std::ofstream(probe.string());
+        boost::system::error_code error;
+        fs::remove(probe, error);
+        if (writable)
+            return volumeDirectory;
+
+        LBWARN << "Cannot write to " << volumeDirectory << ", storing the "
+               << "levels of detail in " << fs::temp_directory_path()
+               << std::endl;
+        return fs::temp_directory_path();
+    }
+
+    // Identifies the volume, the downsampled levels of another version of
+    // the file are not reused
+    std::string getLevelPrefix(const std::string& path,
+                               const VolumeInformation& volInfo) const
+    {
+        namespace fs = boost::filesystem;
+        std::stringstream signature;
+        signature << fs::absolute(_dataFile).string() << " "
+                  << _mmap.getSize() << " " << fs::last_write_time(_dataFile)
+                  << " " << _headerSize
+                  << " " << volInfo.voxels << " " << volInfo.dataType << " "
+                  << _filter;
+
+        std::stringstream prefix;
+        prefix << "livre-" << fs::path(path).stem().string() << "-" << std::hex
+               << std::hash<std::string>()(signature.str()) << "-";
+        return prefix.str();
     }
 
-    ~Impl() {}
     MemoryUnitPtr getData(const LODNode& node)
     {
-        const size_t size = node.getBlockSize().product();
-        const uint8_t* ptr = _mmap.getAddress<uint8_t>() + _headerSize;
+        const uint32_t shift = _depth - 1 - node.getRefLevel();
+        const Vector3ui size = node.getBlockSize() + _overlap * 2;
+        const size_t nElems = size.product();
+
+        const uint8_t* ptr = nullptr;
+        MemoryUnitPtr brick;
+        if (_depth == 1)
+            ptr = getLevel(0);
+        else
+        {
+            const Vector3ui position =
+                node.getAbsolutePosition() * node.getBlockSize();
+            const int32_t origin[] = {int32_t(position[0] - _overlap[0]),
+                                      int32_t(position[1] - _overlap[1]),
+                                      int32_t(position[2] - _overlap[2])};
+            brick.reset(new PooledMemoryUnit(nElems * _bytesPerVoxel));
+            _copyBrick(getLevel(shift), getLevelSize(shift), origin, size,
+                       _bytesPerVoxel, brick->getData<uint8_t>());
+            ptr = brick->getData<uint8_t>();
+        }
+
         if (_inputType == _outputType)
-            return MemoryUnitPtr(new ConstMemoryUnit(ptr, size));
+        {
+            if (brick)
+                return brick;
+            return MemoryUnitPtr(
+                new ConstMemoryUnit(ptr, nElems * _bytesPerVoxel));
+        }
 
         // only unsigned integer conversions are supported!
         if (_inputType == DT_UINT16 && _outputType == DT_UINT8)
-            return _scale<uint16_t, uint8_t>(ptr, size);
+            return _scale<uint16_t, uint8_t>(ptr, nElems);
         if (_inputType == DT_UINT32 && _outputType == DT_UINT8)
-            return _scale<uint32_t, uint8_t>(ptr, size);
+            return _scale<uint32_t, uint8_t>(ptr, nElems);
         if (_inputType == DT_UINT32 && _outputType == DT_UINT16)
-            return _scale<uint32_t, uint16_t>(ptr, size);
+            return _scale<uint32_t, uint16_t>(ptr, nElems);
 
         LBTHROW(std::runtime_error("Unsupported data conversion"));
     }
 
+    Vector3ui getLevelSize(const uint32_t shift) const
+    {
+        const uint32_t round = (1u << shift) - 1;
+        return Vector3ui((_voxels[0] + round) >> shift,
+                         (_voxels[1] + round) >> shift,
+                         (_voxels[2] + round) >> shift);
+    }
+
+    // The cells of the range grid have the size of a brick at each level
+    Vector3ui getGridSize(const uint32_t shift) const
+    {
+        const Vector3ui levelSize = getLevelSize(shift);
+        const uint32_t round = _brickSize - 1;
+        return Vector3ui((levelSize[0] + round) / _brickSize,
+                         (levelSize[1] + round) / _brickSize,
+                         (levelSize[2] + round) / _brickSize);
+    }
+
+    // The voxels of a level of detail are computed from the voxels of the
+    // finer levels at the same place, the descendants of a node are within
+    // its brick. The range of a node is the range of the cells overlapping
+    // its brick, and 0 for the voxels of the brick outside of the volume.
+    bool getValueRange(const LODNode& node, Range& range)
+    {
+        std::call_once(_rangesStarted, [this] {
+            _rangeThread = boost::thread([this] { loadRanges(); });
+        });
+        if (!_rangesReady)
+            return false;
+
+        const uint32_t shift = _depth - 1 - node.getRefLevel();
+        const Vector3ui levelSize = getLevelSize(shift);
+        const Vector3ui gridSize = getGridSize(shift);
+        const Vector3ui& blockSize = node.getBlockSize();
+        const Vector3ui position = node.getAbsolutePosition() * blockSize;
+
+        bool outside = false;
+        Vector3ui first;
+        Vector3ui last;
+        for (size_t i = 0; i < 3; ++i)
+        {
+            const int64_t begin = int64_t(position[i]) - _overlap[i];
+            const int64_t end =
+                int64_t(position[i]) + blockSize[i] + _overlap[i];
+            outside = outside || begin < 0 || end > int64_t(levelSize[i]);
+            first[i] = uint32_t(std::max(begin, int64_t(0)) / _brickSize);
+            last[i] = uint32_t(std::min(end, int64_t(levelSize[i])) - 1) /
+                      _brickSize;
+        }
+
+        const std::vector<Range>& cells = _ranges[shift];
+        range = outside ? Range{{0.f, 0.f}} : EMPTY_RANGE;
+        for (uint32_t z = first.z(); z <= last.z(); ++z)
+            for (uint32_t y = first.y(); y <= last.y(); ++y)
+                for (uint32_t x = first.x(); x <= last.x(); ++x)
+                    range = uniteValueRanges(range,
+                                             cells[_getIndex(gridSize, x, y,
+                                                             z)]);
+
+        // Same as the conversion of the values in getData()
+        if (_outputShift > 0)
+        {
+            const float scale = float(uint64_t(1) << _outputShift);
+            range = Range{{std::floor(range[0] / scale),
+                           std::floor(range[1] / scale)}};
+        }
+        return true;
+    }
+
+    // The ranges of the cells of the volume are computed once and kept in a
+    // file, the coarser levels unite 2x2x2 cells of the next finer level
+    void loadRanges()
+    {
+        namespace fs = boost::filesystem;
+        lunchbox::Thread::setName("RawRanges");
+
+        const Vector3ui gridSize = getGridSize(0);
+        std::vector<Range> cells(gridSize.product(), EMPTY_RANGE);
+        const fs::path filename =
+            _levelDirectory /
+            (_levelPrefix + std::to_string(_brickSize) + ".ranges");
+        if (!readRanges(filename, cells))
+        {
+            if (!computeRanges(gridSize, cells))
+                return;
+            writeRanges(filename, cells);
+        }
+
+        std::vector<std::vector<Range>> ranges(_depth);
+        ranges[0] = std::move(cells);
+        for (uint32_t shift = 1; shift < _depth; ++shift)
+        {
+            const Vector3ui finerSize = getGridSize(shift - 1);
+            const Vector3ui size = getGridSize(shift);
+            ranges[shift].resize(size.product(), EMPTY_RANGE);
+            for (uint32_t z = 0; z < finerSize.z(); ++z)
+                for (uint32_t y = 0; y < finerSize.y(); ++y)
+                    for (uint32_t x = 0; x < finerSize.x(); ++x)
+                    {
+                        Range& range =
+                            ranges[shift][_getIndex(size, x / 2, y / 2, z / 2)];
+                        range = uniteValueRanges(
+                            range,
+                            ranges[shift - 1][_getIndex(finerSize, x, y, z)]);
+                    }
+        }
+        _ranges = std::move(ranges);
+        _rangesReady = true;
+    }
+
+    // Reads the volume once, returns false if the data source is destroyed
+    // meanwhile
+    bool computeRanges(const Vector3ui& gridSize, std::vector<Range>& cells)
+    {
+        const uint8_t* volume = getLevel(0);
+        const ssize_t nRows = ssize_t(gridSize.z()) * gridSize.y();
+#pragma omp parallel for schedule(dynamic)
+        for (ssize_t row = 0; row < nRows; ++row)
+        {
+            Range* rowCells = cells.data() + row * gridSize.x();
+            const uint32_t y0 = (row % gridSize.y()) * _brickSize;
+            const uint32_t z0 = (row / gridSize.y()) * _brickSize;
+            const uint32_t y1 = std::min(y0 + _brickSize, _voxels.y());
+            const uint32_t z1 = std::min(z0 + _brickSize, _voxels.z());
+            for (uint32_t z = z0; z < z1 && !_stopRanges; ++z)
+                for (uint32_t y = y0; y < y1; ++y)
+                {
+                    const uint8_t* voxels =
+                        volume + _getIndex(_voxels, 0, y, z) * _bytesPerVoxel;
+                    for (uint32_t x = 0; x < gridSize.x(); ++x)
+                    {
+                        const uint32_t begin = x * _brickSize;
+                        const uint32_t count =
+                            std::min(_brickSize, _voxels.x() - begin);
+                        rowCells[x] = uniteValueRanges(
+                            rowCells[x],
+                            computeValueRange(_inputType,
+                                              voxels + begin * _bytesPerVoxel,
+                                              count * _bytesPerVoxel));
+                    }
+                }
+        }
+        return !_stopRanges;
+    }
+
+    bool readRanges(const boost::filesystem::path& filename,
+                    std::vector<Range>& cells) const
+    {
+        boost::system::error_code error;
+        const size_t bytes = cells.size() * sizeof(Range);
+        if (boost::filesystem::file_size(filename, error) != bytes || error)
+            return false;
+
+        std::ifstream file(filename.string(), std::ios::binary);
+        return bool(file.read(reinterpret_cast<char*>(cells.data()), bytes));
+    }
+
+    void writeRanges(const boost::filesystem::path& filename,
+                     const std::vector<Range>& cells) const
+    {
+        namespace fs = boost::filesystem;
+        const fs::path tmpFilename =
+            fs::unique_path(filename.string() + ".%%%%%%");
+        boost::system::error_code error;
+        {
+            std::ofstream file(tmpFilename.string(), std::ios::binary);
+            file.write(reinterpret_cast<const char*>(cells.data()),
+                       cells.size() * sizeof(Range));
+            if (!file)
+                error = boost::system::errc::make_error_code(
+                    boost::system::errc::io_error);
+        }
+        if (!error)
+            fs::rename(tmpFilename, filename, error);
+        if (error)
+        {
+            LBWARN << "Cannot store " << filename << ": " << error.message()
+                   << std::endl;
+            fs::remove(tmpFilename, error);
+        }
+    }
+
+    // Downsampled levels are computed once, from the next finer level, and
+    // kept in files which are reused by later runs
+    const uint8_t* getLevel(const uint32_t shift)
+    {
+        if (shift == 0)
+            return _mmap.getAddress<uint8_t>() + _headerSize;
+
+        // Each level waits only for itself and the finer levels it is
+        // computed from
+        std::call_once(_levelLoaded[shift],
+                       [this, shift] { _levels[shift] = loadLevel(shift); });
+        return _levels[shift]->getAddress<uint8_t>();
+    }
+
+    std::unique_ptr<lunchbox::MemoryMap> loadLevel(const uint32_t shift)
+    {
+        namespace fs = boost::filesystem;
+        const Vector3ui size = getLevelSize(shift);
+        const size_t bytes = size.product() * _bytesPerVoxel;
+        const fs::path filename =
+            _levelDirectory / (_levelPrefix + std::to_string(shift) + ".raw");
+
+        std::unique_ptr<lunchbox::MemoryMap> level(new lunchbox::MemoryMap);
+        if (fs::exists(filename) && level->map(filename.string()) &&
+            level->getSize() == bytes)
+        {
+            return level;
+        }
+
+        // Written under a unique name, concurrent processes may compute the
+        // same level
+        const fs::path tmpFilename =
+            fs::unique_path(filename.string() + ".%%%%%%");
+        uint8_t* data =
+            static_cast<uint8_t*>(level->create(tmpFilename.string(), bytes));
+        if (!data)
+            LBTHROW(std::runtime_error("Cannot create " +
+                                       tmpFilename.string()));
+
+        const uint8_t* finer = getLevel(shift - 1);
+        downsample(_inputType, _filter, finer, getLevelSize(shift - 1), data,
+                   size);
+
+        boost::system::error_code error;
+        fs::rename(tmpFilename, filename, error);
+        if (error)
+        {
+            LBWARN << "Cannot store " << filename << ": " << error.message()
+                   << std::endl;
+            fs::remove(tmpFilename, error);
+        }
+        return level;
+    }
+
     DataType getDataType(const std::string& dataType)
     {
         if (dataType == "char" || dataType == "int8")
@@ -146,11 +589,24 @@ struct RawDataSource::Impl
         LBTHROW(std::runtime_error("Unsupported data format " + dataType));
     }
 
+    DownsampleFilter getFilter(const std::string& filter)
+    {
+        if (filter == "box")
+            return DF_BOX;
+        if (filter == "max")
+            return DF_MAX;
+        if (filter == "mode")
+            return DF_MODE;
+        LBTHROW(std::runtime_error("Unsupported downsampling filter " +
+                                   filter));
+    }
+
     void parseRawData(const std::string& filename, VolumeInformation& volInfo,
                       const std::string& fragment)
     {
         if (!_mmap.map(filename))
             LBTHROW(std::runtime_error("Cannot mmap file"));
+        _dataFile = filename;
 
         std::vector<std::string> parameters;
         boost::algorithm::split(parameters, fragment, boost::is_any_of(","));
@@ -193,10 +649,14 @@ struct RawDataSource::Impl
                 boost::filesystem::path(filename).parent_path();
             dataFilePath /= dataInfo["datafile"];
             dataFile = dataFilePath.string();
+
+            // The header size is the offset of inline data only
+            _headerSize = 0;
         }
 
         if (!_mmap.map(dataFile))
             LBTHROW(std::runtime_error("Cannot mmap file"));
+        _dataFile = dataFile;
 
         volInfo.dataType = getDataType(dataInfo["type"]);
 
@@ -219,9 +679,28 @@ struct RawDataSource::Impl
     }
 
     lunchbox::MemoryMap _mmap;
+    std::string _dataFile;
     size_t _headerSize;
     DataType _inputType;
+    DownsampleFilter _filter;
     DataType _outputType;
+    size_t _bytesPerVoxel; // of the input type
+    size_t _outputShift;   // of the values converted to the output type
+    Vector3ui _voxels;
+    Vector3ui _overlap;
+    uint32_t _depth;
+    uint32_t _brickSize;
+
+    boost::filesystem::path _levelDirectory;
+    std::string _levelPrefix;
+    std::vector<std::unique_ptr<lunchbox::MemoryMap>> _levels; // by shift
+    std::unique_ptr<std::once_flag[]> _levelLoaded;            // by shift
+
+    std::once_flag _rangesStarted;
+    boost::thread _rangeThread;
+    std::atomic<bool> _rangesReady;
+    std::atomic<bool> _stopRanges;
+    std::vector<std::vector<Range>> _ranges; // of the cells, by shift
 };
 
 RawDataSource::RawDataSource(const DataSourcePluginData& initData)
@@ -238,6 +717,17 @@ MemoryUnitPtr RawDataSource::getData(const LODNode& node)
     return _impl->getData(node);
 }
 
+bool RawDataSource::getValueRange(const LODNode& node, Range& range) const
+{
+    return _impl->getValueRange(node, range);
+}
+
+std::future<void> RawDataSource::getDataAsync(const LODNodes& nodes,
+                                              const DataCallback& callback)
+{
+    return getDataParallel(nodes, callback);
+}
+
 bool RawDataSource::handles(const DataSourcePluginData& initData)
 {
     const servus::URI& uri = initData.getURI();
@@ -254,9 +744,13 @@ bool RawDataSource::handles(const DataSourcePluginData& initData)
 
 std::string RawDataSource::getDescription()
 {
-    return R"(Raw volume: [raw://]/filename.[raw|img|nrrd](?output=format)#1024,1024,1024(,input format)
+    return R"(Raw volume: [raw://]/filename.[raw|img|nrrd](?output=format&brick=128&overlap=2&lod-dir=/path&filter=box)#1024,1024,1024(,input format)
   with formats being one of: char, int8, unsigned char, uint8, short, int16, unsigned short, uint16, int, int32, unsigned int, uint32, float
   The default input format is uint8, the default output format is the input
-  format.)";
+  format. Volumes larger than the brick size are split into bricks with the
+  given overlap, the levels of detail are downsampled with the box, max or mode
+  filter and stored in lod-dir, the directory of the volume by default. The
+  value ranges of the bricks are computed in the background on first use and
+  stored in lod-dir as well.)";
 }
 }
@@ -27,8 +27,10 @@ namespace livre
 /**
  * Data source for *.[raw|img] data with given details or nrrd volume
  *
- * Volumes need to fit into the GPU memory. If the data does not
- * fit GPU memory, texture upload will fail with OpenGL error number 1281.
+ * Volumes larger than the brick size are served as an octree of bricks cut
+ * from the memory mapped file. The coarser levels of detail are downsampled
+ * once on first use and stored in files, which are reused as long as the
+ * volume file does not change.
  *
  */
 class RawDataSource : public DataSourcePlugin
@@ -43,6 +45,23 @@ public:
      * @return The block data for the node.
      */
     MemoryUnitPtr getData(const LODNode& node) final;
+
+    /**
+     * @copydoc DataSourcePlugin::getDataAsync()
+     *
+     * The bricks are read from several threads.
+     */
+    std::future<void> getDataAsync(const LODNodes& nodes,
+                                   const DataCallback& callback) final;
+
+    /**
+     * @copydoc DataSourcePlugin::getValueRange()
+     *
+     * The ranges are computed in the background on the first call, which
+     * returns false until they are available.
+     */
+    bool getValueRange(const LODNode& node, Range& range) const final;
+
     static bool handles(const DataSourcePluginData& initData);
     static std::string getDescription();
 
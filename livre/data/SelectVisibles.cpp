@@ -21,16 +21,114 @@
 
 #include <livre/data/LODNode.h>
 #include <livre/data/types.h>
+
+#include <algorithm>
+#include <limits>
 //#define LIVRE_STATIC_DECOMPOSITION
 
 namespace livre
 {
+namespace
+{
+enum Selection
+{
+    SELECTION_CULLED,
+    SELECTION_VISIBLE,
+    SELECTION_REFINE
+};
+
+// Share of the size of a node its box is grown or shrunk by, to find a camera
+// motion its frustum classification holds for
+const float FRUSTUM_SLACK = 0.25f;
+
+// Camera motions above this share of the volume size select from the root
+const float MAX_MOTION = 0.25f;
+
+const float UNBOUNDED = std::numeric_limits<float>::max();
+
+// A node visited by the selection
+struct CutNode
+{
+    NodeId nodeId;
+    uint32_t end; // index after the subtree of the node in the cut
+    Selection selection;
+    bool hasValues;
+    bool unknownValues; // the selection needed the values, they were unknown
+    bool transparent;   // for the transfer function of the last evaluation
+    Range values;
+    float budget; // world space camera motion the selection holds for
+    float extent; // sqrt(r^2 + 1), r the farthest distance of the node from 0
+};
+typedef std::vector<CutNode> CutNodes;
+
+struct Cut
+{
+    CutNodes nodes; // in DFS order
+    CutNodes next;  // filled by the selection, then swapped with nodes
+    size_t nEvaluated = 0;
+    NodeId unknownValues; // a node of the cut with unknownValues
+
+    // The parameters the nodes are selected for
+    const DataSource* dataSource = nullptr;
+    uint32_t timeStep = 0;
+    uint32_t depth = 0;
+    Matrix4f mvMatrix;
+    Matrix4f invMVMatrix;
+    Matrix4f projMatrix;
+    uint32_t windowHeight = 0;
+    float screenSpaceError = 0.f;
+    uint32_t minLOD = 0;
+    uint32_t maxLOD = 0;
+    ClipPlanes clipPlanes;
+};
+
+// The distance a point p moves with the camera is at most the returned value
+// times sqrt(|p|^2 + 1), given the transform from the previous to the current
+// camera. It is the norm of the difference of the transform to the identity.
+float getMotion(const Matrix4f& transform)
+{
+    float sum = 0.f;
+    for (size_t i = 0; i < 3; ++i)
+    {
+        for (size_t j = 0; j < 4; ++j)
+        {
+            const float delta = transform(i, j) - (i == j ? 1.f : 0.f);
+            sum += delta * delta;
+        }
+    }
+    return std::sqrt(sum);
+}
+}
+
+struct VisibleCut::Impl : public Cut
+{
+};
+
+VisibleCut::VisibleCut()
+    : _impl(new VisibleCut::Impl())
+{
+}
+
+VisibleCut::~VisibleCut()
+{
+}
+
+size_t VisibleCut::getEvaluated() const
+{
+    return _impl->nEvaluated;
+}
+
+void VisibleCut::clear()
+{
+    _impl->nodes.clear();
+}
+
 struct SelectVisibles::Impl
 {
     Impl(const DataSource& dataSource, const Frustum& frustum,
          const uint32_t windowHeight, const float screenSpaceError,
          const uint32_t minLOD, const uint32_t maxLOD, const Range& range,
-         const ClipPlanes& clipPlanes)
+         const ClipPlanes& clipPlanes, const TransparencyFunc& isTransparent)
         : _dataSource(dataSource)
         , _frustum(frustum)
         , _windowHeight(windowHeight)
@@ -39,7 +137,12 @@ struct SelectVisibles::Impl
         , _maxLOD(maxLOD)
         , _range(range)
         , _clipPlanes(clipPlanes)
+        , _isTransparent(isTransparent)
     {
+        if (!_isTransparent)
+            _isTransparent = [](const Range& values) {
+                return values[0] == 0.f && values[1] == 0.f;
+            };
     }
 
     bool isLODVisible(const Vector3f& worldCoord,
@@ -63,11 +166,94 @@ struct SelectVisibles::Impl
         return pixelPerVoxelInDistance <= _screenSpaceError;
     }
 
-    bool visit(const LODNode& lodNode)
+    // Camera motion until the frustum classification of a box may change
+    float getFrustumBudget(const Boxf& box, const bool inFrustum) const
+    {
+        const float slack = FRUSTUM_SLACK * box.getSize().find_min();
+        const Vector3f offset(inFrustum ? slack : -slack);
+        const Boxf tested(box.getMin() + offset, box.getMax() - offset);
+        return _frustum.isInFrustum(tested) == inFrustum ? slack : 0.f;
+    }
+
+    // Camera motion until the result of isLODVisible() may change, given the
+    // point of a node closest to the near plane
+    float getLODBudget(const Vector3f& worldCoord,
+                       const float worldSpacePerVoxel) const
+    {
+        const float t = _frustum.top();
+        const float b = _frustum.bottom();
+
+        const float worldSpacePerPixel = (t - b) / _windowHeight;
+        const float pixelPerVoxel = worldSpacePerVoxel / worldSpacePerPixel;
+
+        // isLODVisible() <=> distance >= threshold
+        const float n = _frustum.nearPlane();
+        const float threshold = n * (pixelPerVoxel / _screenSpaceError - 1.f);
+
+        const Plane& nearPlane = _frustum.getNearPlane();
+        Vector4f hWorldCoord = worldCoord;
+        hWorldCoord[3] = 1.0f;
+        const float distance = nearPlane.dot(hWorldCoord);
+        const float scale = std::sqrt(nearPlane[0] * nearPlane[0] +
+                                      nearPlane[1] * nearPlane[1] +
+                                      nearPlane[2] * nearPlane[2]);
+
+        // The node has to stay in front of the near plane as well
+        return std::min(std::abs(distance - threshold), distance) / scale;
+    }
+
+    // Selection of a node. The values of the cut node are used if known, and
+    // it gets the values and the camera motion the selection holds for.
+    Selection classify(const LODNode& lodNode, CutNode* cutNode) const
     {
         const Boxf& worldBox = lodNode.getWorldBox();
-        if (!_frustum.isInFrustum(worldBox) || _clipPlanes.isOutside(worldBox))
-            return false;
+        if (!_frustum.isInFrustum(worldBox))
+        {
+            if (cutNode)
+                cutNode->budget = getFrustumBudget(worldBox, false);
+            return SELECTION_CULLED;
+        }
+        if (_clipPlanes.isOutside(worldBox))
+        {
+            if (cutNode)
+                cutNode->budget = UNBOUNDED;
+            return SELECTION_CULLED;
+        }
+
+        // Transparent subtrees are skipped, uniform ones are not refined as
+        // they look the same at all levels of detail
+        Range values = {{0.f, 0.f}};
+        bool hasValues;
+        if (cutNode && cutNode->hasValues)
+        {
+            values = cutNode->values;
+            hasValues = true;
+        }
+        else
+            hasValues = _dataSource.getValueRange(lodNode, values);
+
+        if (cutNode)
+        {
+            cutNode->hasValues = hasValues;
+            cutNode->unknownValues = !hasValues;
+            cutNode->values = values;
+        }
+
+        if (hasValues)
+        {
+            if (_isTransparent(values))
+            {
+                if (cutNode)
+                    cutNode->budget = UNBOUNDED;
+                return SELECTION_CULLED;
+            }
+            if (values[0] == values[1])
+            {
+                if (cutNode)
+                    cutNode->budget = getFrustumBudget(worldBox, true);
+                return SELECTION_VISIBLE;
+            }
+        }
 
         Vector3f vmin, vmax;
         const Plane& nearPlane = _frustum.getNearPlane();
@@ -81,8 +267,9 @@ struct SelectVisibles::Impl
         hVmax[3] = 1.0f;
 
         // The bounding box intersects the plane
-        if (_frustum.getNearPlane().dot(hVmin) < 0 ||
-            _frustum.getNearPlane().dot(hVmax) < 0)
+        const bool intersectsNear = _frustum.getNearPlane().dot(hVmin) < 0 ||
+                                    _frustum.getNearPlane().dot(hVmax) < 0;
+        if (intersectsNear)
         {
             // Where eye direction intersects with near plane
             vmin = _frustum.getEyePos() -
@@ -96,14 +283,195 @@ struct SelectVisibles::Impl
 
         const VolumeInformation& volInfo = _dataSource.getVolumeInfo();
         const uint32_t depth = volInfo.rootNode.getDepth();
-        lodVisible = (lodVisible && lodNode.getRefLevel() >= _minLOD) ||
-                     (lodNode.getRefLevel() == _maxLOD) ||
-                     (lodNode.getRefLevel() == depth - 1);
+        const uint32_t level = lodNode.getRefLevel();
+        lodVisible = (lodVisible && level >= _minLOD) || (level == _maxLOD) ||
+                     (level == depth - 1);
 
-        if (lodVisible)
+        if (cutNode)
+        {
+            cutNode->budget = getFrustumBudget(worldBox, true);
+            if (level >= _minLOD && level != _maxLOD && level != depth - 1)
+            {
+                const float lodBudget =
+                    intersectsNear
+                        ? 0.f
+                        : getLODBudget(vmin, worldSpacePerVoxel.find_min());
+                cutNode->budget = std::min(cutNode->budget, lodBudget);
+            }
+        }
+        return lodVisible ? SELECTION_VISIBLE : SELECTION_REFINE;
+    }
+
+    bool visit(const LODNode& lodNode)
+    {
+        const Selection selection = classify(lodNode, nullptr);
+        if (selection == SELECTION_VISIBLE)
             _visibles.push_back(lodNode.getNodeId());
+        return selection == SELECTION_REFINE;
+    }
+
+    // Evaluates a node of the cut being built
+    void evaluate(Cut& cut, CutNode& node) const
+    {
+        ++cut.nEvaluated;
+        node.unknownValues = false;
+        const LODNode& lodNode = _dataSource.getNode(node.nodeId);
+        if (!lodNode.isValid())
+        {
+            node.selection = SELECTION_CULLED;
+            node.budget = UNBOUNDED;
+            node.extent = 1.f;
+            return;
+        }
+
+        const Boxf& worldBox = lodNode.getWorldBox();
+        const float radius = worldBox.getCenter().length() +
+                             0.5f * worldBox.getSize().length();
+        node.extent = std::sqrt(radius * radius + 1.f);
+        node.selection = classify(lodNode, &node);
+        node.transparent = node.hasValues && _isTransparent(node.values);
+    }
+
+    // Evaluates a node and its subtree, appending them to the cut being built
+    void add(Cut& cut, const NodeId& nodeId)
+    {
+        const size_t index = cut.next.size();
+        CutNode node = CutNode();
+        node.nodeId = nodeId;
+        cut.next.push_back(node);
+
+        evaluate(cut, cut.next[index]);
+        if (cut.next[index].selection == SELECTION_REFINE)
+            addChildren(cut, nodeId);
+        cut.next[index].end = cut.next.size();
+    }
 
-        return !lodVisible;
+    void addChildren(Cut& cut, const NodeId& nodeId)
+    {
+        const uint32_t level = nodeId.getLevel() + 1;
+        if (level >= cut.depth)
+            return;
+
+        const Vector3ui position = nodeId.getPosition() * 2u;
+        for (uint32_t i = 0; i < 8; ++i)
+        {
+            const Vector3ui offset(i >> 2, (i >> 1) & 1, i & 1);
+            add(cut, NodeId(level, position + offset, nodeId.getTimeStep()));
+        }
+    }
+
+    // Appends the subtree at the given index of the previous cut to the one
+    // being built. Only the nodes whose selection may have changed since the
+    // previous frame are evaluated.
+    void update(Cut& cut, const size_t index, const float motion,
+                const bool valuesKnown)
+    {
+        const CutNode& node = cut.nodes[index];
+        const size_t next = cut.next.size();
+        cut.next.push_back(node);
+        cut.next[next].budget -= motion * node.extent;
+
+        if (cut.next[next].budget < 0.f ||
+            (node.hasValues &&
+             _isTransparent(node.values) != node.transparent) ||
+            (node.unknownValues && valuesKnown))
+        {
+            evaluate(cut, cut.next[next]);
+        }
+
+        if (cut.next[next].selection == SELECTION_REFINE)
+        {
+            if (node.selection == SELECTION_REFINE)
+            {
+                for (size_t i = index + 1; i < node.end; i = cut.nodes[i].end)
+                    update(cut, i, motion, valuesKnown);
+            }
+            else
+                addChildren(cut, node.nodeId);
+        }
+        cut.next[next].end = cut.next.size();
+    }
+
+    bool isSelected(const Cut& cut, const uint32_t timeStep) const
+    {
+        return !cut.nodes.empty() && cut.dataSource == &_dataSource &&
+               cut.timeStep == timeStep &&
+               cut.depth == _dataSource.getVolumeInfo().rootNode.getDepth() &&
+               cut.projMatrix == _frustum.getProjMatrix() &&
+               cut.windowHeight == _windowHeight &&
+               cut.screenSpaceError == _screenSpaceError &&
+               cut.minLOD == _minLOD && cut.maxLOD == _maxLOD &&
+               cut.clipPlanes == _clipPlanes;
+    }
+
+    // Values which were unknown may become known, e.g. once a data source has
+    // computed them in the background. This is checked on one of the nodes,
+    // and all nodes which were selected without their values are evaluated
+    // again then.
+    bool areValuesKnown(const Cut& cut) const
+    {
+        if (!cut.unknownValues.isValid())
+            return false;
+        Range values;
+        return _dataSource.getValueRange(
+            _dataSource.getNode(cut.unknownValues), values);
+    }
+
+    void select(Cut& cut, const uint32_t timeStep)
+    {
+        const VolumeInformation& volInfo = _dataSource.getVolumeInfo();
+        bool incremental = isSelected(cut, timeStep);
+        float motion = 0.f;
+        if (incremental)
+        {
+            const Matrix4f& mvMatrix = _frustum.getMVMatrix();
+            if (!(mvMatrix == cut.mvMatrix))
+                motion = getMotion(cut.invMVMatrix * mvMatrix);
+            const Vector3f& size = volInfo.worldSize;
+            const float radius = 0.5f * size.length();
+            incremental = motion * std::sqrt(radius * radius + 1.f) <=
+                          MAX_MOTION * size.find_max();
+        }
+
+        cut.next.clear();
+        cut.nEvaluated = 0;
+        if (incremental)
+        {
+            const bool valuesKnown = areValuesKnown(cut);
+            for (size_t i = 0; i < cut.nodes.size(); i = cut.nodes[i].end)
+                update(cut, i, motion, valuesKnown);
+        }
+        else
+        {
+            cut.depth = volInfo.rootNode.getDepth();
+            const Vector3ui& blockSize = volInfo.rootNode.getBlockSize();
+            for (uint32_t x = 0; x < blockSize.x(); ++x)
+                for (uint32_t y = 0; y < blockSize.y(); ++y)
+                    for (uint32_t z = 0; z < blockSize.z(); ++z)
+                        add(cut, NodeId(0, Vector3ui(x, y, z), timeStep));
+        }
+        cut.nodes.swap(cut.next);
+
+        cut.dataSource = &_dataSource;
+        cut.timeStep = timeStep;
+        cut.mvMatrix = _frustum.getMVMatrix();
+        cut.invMVMatrix = _frustum.getInvMVMatrix();
+        cut.projMatrix = _frustum.getProjMatrix();
+        cut.windowHeight = _windowHeight;
+        cut.screenSpaceError = _screenSpaceError;
+        cut.minLOD = _minLOD;
+        cut.maxLOD = _maxLOD;
+        cut.clipPlanes = _clipPlanes;
+
+        _visibles.clear();
+        cut.unknownValues = NodeId();
+        for (const CutNode& node : cut.nodes)
+        {
+            if (node.selection == SELECTION_VISIBLE)
+                _visibles.push_back(node.nodeId);
+            if (node.unknownValues)
+                cut.unknownValues = node.nodeId;
+        }
     }
 
     void visitPre() { _visibles.clear(); }
@@ -139,6 +507,7 @@ struct SelectVisibles::Impl
     const Range _range;
     NodeIds _visibles;
     const ClipPlanes _clipPlanes;
+    TransparencyFunc _isTransparent;
 };
 
 SelectVisibles::SelectVisibles(const DataSource& dataSource,
@@ -146,11 +515,12 @@ SelectVisibles::SelectVisibles(const DataSource& dataSource,
                                const uint32_t windowHeight,
                                const float screenSpaceError,
                                const uint32_t minLOD, const uint32_t maxLOD,
-                               const Range& range, const ClipPlanes& clipPlanes)
+                               const Range& range, const ClipPlanes& clipPlanes,
+                               const TransparencyFunc& isTransparent)
     : DataSourceVisitor(dataSource)
     , _impl(new SelectVisibles::Impl(dataSource, frustum, windowHeight,
                                      screenSpaceError, minLOD, maxLOD, range,
-                                     clipPlanes))
+                                     clipPlanes, isTransparent))
 {
 }
 
@@ -177,4 +547,28 @@ void SelectVisibles::visitPost()
 {
     _impl->visitPost();
 }
+
+std::unique_ptr<NodeVisitor> SelectVisibles::fork() const
+{
+    return std::unique_ptr<NodeVisitor>(
+        new SelectVisibles(_impl->_dataSource, _impl->_frustum,
+                           _impl->_windowHeight, _impl->_screenSpaceError,
+                           _impl->_minLOD, _impl->_maxLOD, _impl->_range,
+                           _impl->_clipPlanes, _impl->_isTransparent));
+}
+
+size_t SelectVisibles::select(VisibleCut& cut, const uint32_t timeStep)
+{
+    _impl->select(*cut._impl, timeStep);
+    _impl->visitPost();
+    return cut._impl->nEvaluated;
+}
+
+void SelectVisibles::join(NodeVisitor& visitor)
+{
+    const NodeIds& visibles =
+        static_cast<const SelectVisibles&>(visitor).getVisibles();
+    _impl->_visibles.insert(_impl->_visibles.end(), visibles.begin(),
+                            visibles.end());
+}
 }
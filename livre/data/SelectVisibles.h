@@ -26,7 +26,37 @@
 
 namespace livre
 {
-/** Selects all visible rendering nodes */
+/**
+ * The cut through the LOD tree selected for a frame, to select the visible
+ * nodes of the next frames incrementally.
+ * @see SelectVisibles::select()
+ */
+class VisibleCut
+{
+public:
+    VisibleCut();
+    ~VisibleCut();
+
+    /** @return the number of nodes evaluated by the last selection. */
+    size_t getEvaluated() const;
+
+    /** Forget the cut, the next selection traverses the whole tree. */
+    void clear();
+
+private:
+    friend class SelectVisibles;
+    struct Impl;
+    std::unique_ptr<Impl> _impl;
+};
+
+/**
+ * Selects all visible rendering nodes
+ *
+ * Subtrees whose value range is transparent are skipped, the refinement stops
+ * at the root of subtrees with a single value. Supports parallel traversals,
+ * the range of the data is selected from the joined visibles.
+ * @see DataSourcePlugin::getValueRange()
+ */
 class SelectVisibles : public DataSourceVisitor
 {
 public:
@@ -40,11 +70,14 @@ public:
      * @param maxLOD maximum level of detail
      * @param range range of the data
      * @param ClipPlanes clip planes
+     * @param isTransparent tells whether a value range is transparent, by
+     *        default only [0, 0] is
      */
     SelectVisibles(const DataSource& dataSource, const Frustum& frustum,
                    const uint32_t windowHeight, const float screenSpaceError,
                    const uint32_t minLOD, const uint32_t maxLOD,
-                   const Range& range, const ClipPlanes& clipPlanes);
+                   const Range& range, const ClipPlanes& clipPlanes,
+                   const TransparencyFunc& isTransparent = TransparencyFunc());
 
     ~SelectVisibles();
 
@@ -53,10 +86,27 @@ public:
      */
     const NodeIds& getVisibles() const;
 
+    /**
+     * Select the visible nodes by updating the cut of the previous frame.
+     *
+     * Only the nodes whose selection may have changed with the camera motion
+     * or the transparency of their values are evaluated, as well as the ones
+     * selected without values once the values are known. Other parameter
+     * changes and large camera motions select from the root. The visibles are
+     * the same as with a DFSTraversal.
+     * @param cut the cut of the previous frame, updated to this one.
+     * @param timeStep the temporal position of the node tree.
+     * @return the number of nodes evaluated.
+     */
+    size_t select(VisibleCut& cut, const uint32_t timeStep);
+
 protected:
     void visitPre() final;
     bool visit(const LODNode& lodNode) final;
     void visitPost() final;
+    std::unique_ptr<NodeVisitor> fork() const final;
+    bool canFork() const final { return true; }
+    void join(NodeVisitor& visitor) final;
 
 private:
     struct Impl;
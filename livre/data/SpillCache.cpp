@@ -0,0 +1,413 @@
+/* Copyright (c) 2017, EPFL/Blue Brain Project
+ *                     bbp-open-source@googlegroups.com
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <livre/data/Compression.h>
+#include <livre/data/MemoryUnit.h>
+#include <livre/data/NodeId.h>
+#include <livre/data/SpillCache.h>
+#include <livre/data/VolumeInformation.h>
+
+#include <lunchbox/memoryMap.h>
+#include <lunchbox/mtQueue.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/thread.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <list>
+#include <unordered_map>
+
+namespace livre
+{
+namespace fs = boost::filesystem;
+
+namespace
+{
+typedef boost::unique_lock<boost::mutex> ScopedLock;
+
+const std::string manifestName = "manifest";
+const std::string brickExtension = ".brick";
+const size_t maxPendingWrites = 64;
+const size_t formatVersion = 1;
+
+// Identifies the volume and the layout of its bricks, a spill directory is
+// only reused if it matches
+std::string getSignature(const servus::URI& uri,
+                         const VolumeInformation& volumeInfo)
+{
+    std::stringstream signature;
+    signature << "Livre spill cache " << formatVersion << std::endl
+              << uri << std::endl
+              << volumeInfo.dataType << " " << volumeInfo.compCount << " "
+              << volumeInfo.bigEndian << std::endl
+              << volumeInfo.voxels << " " << volumeInfo.maximumBlockSize << " "
+              << volumeInfo.overlap << std::endl
+              << volumeInfo.rootNode.getDepth() << " "
+              << volumeInfo.rootNode.getBlockSize() << std::endl
+              << volumeInfo.frameRange << std::endl;
+
+    boost::system::error_code error;
+    const std::time_t modified = fs::last_write_time(uri.getPath(), error);
+    if (!error)
+        signature << modified << std::endl;
+    return signature.str();
+}
+
+/** Maps a brick file, the mapping stays valid if the file is removed */
+class MappedMemoryUnit : public MemoryUnit
+{
+public:
+    bool map(const std::string& filename)
+    {
+        return _map.map(filename) && _map.getSize() > 0;
+    }
+
+    size_t getAllocSize() const final { return _map.getSize(); }
+private:
+    const uint8_t* _getData() const final
+    {
+        return _map.getAddress<uint8_t>();
+    }
+
+    uint8_t* _getData() final
+    {
+        LBDONTCALL;
+        return 0;
+    }
+
+    lunchbox::MemoryMap _map;
+};
+}
+
+struct SpillCache::Impl
+{
+    struct Write
+    {
+        NodeId nodeId;
+        ConstMemoryUnitPtr data;
+        size_t size; // uncompressed, 0 if the data is not compressed
+    };
+
+    struct Entry
+    {
+        size_t size;
+        std::list<Identifier>::iterator position;
+    };
+
+    Impl(const std::string& directory, const size_t maxMemBytes,
+         const servus::URI& uri, const VolumeInformation& volumeInfo)
+        : _directory(directory)
+        , _maxMemBytes(maxMemBytes)
+        , _usedMemBytes(0)
+        , _pendingWrites(0)
+        , _hits(0)
+        , _misses(0)
+    {
+        open(getSignature(uri, volumeInfo));
+        _writeThread = boost::thread(boost::bind(&Impl::writeLoop, this));
+    }
+
+    ~Impl()
+    {
+        _writes.push(Write()); // an empty write ends the loop
+        _writeThread.join();
+    }
+
+    void open(const std::string& signature)
+    {
+        boost::system::error_code error;
+        fs::create_directories(_directory, error);
+        if (error || !fs::is_directory(_directory))
+            LBTHROW(std::runtime_error("Cannot create spill directory " +
+                                       _directory.string()));
+
+        const fs::path manifest = _directory / manifestName;
+        std::ifstream manifestFile(manifest.string());
+        const std::string existing(
+            (std::istreambuf_iterator<char>(manifestFile)),
+            std::istreambuf_iterator<char>());
+        const bool isValid = existing == signature;
+
+        // Restore the least recently used order from the modification times
+        // of the bricks, which are updated on every load
+        std::vector<std::pair<std::time_t, fs::path>> bricks;
+        for (fs::directory_iterator it(_directory);
+             it != fs::directory_iterator(); ++it)
+        {
+            const fs::path& path = it->path();
+            if (path.filename() == manifestName)
+                continue;
+            if (!isValid || path.extension() != brickExtension)
+                fs::remove(path, error); // includes interrupted writes
+            else
+                bricks.emplace_back(fs::last_write_time(path, error), path);
+        }
+        std::sort(bricks.begin(), bricks.end());
+
+        for (const auto& brick : bricks)
+        {
+            Identifier id;
+            std::stringstream stem(brick.second.stem().string());
+            if (!(stem >> std::hex >> id))
+                continue;
+            add(id, fs::file_size(brick.second, error));
+        }
+        evict(0);
+
+        if (!isValid)
+        {
+            std::ofstream file(manifest.string(), std::ios::trunc);
+            file << signature;
+            if (!file)
+                LBTHROW(std::runtime_error("Cannot write spill manifest " +
+                                           manifest.string()));
+        }
+    }
+
+    fs::path getPath(const Identifier id) const
+    {
+        std::stringstream name;
+        name << std::hex << std::setw(16) << std::setfill('0') << id
+             << brickExtension;
+        return _directory / name.str();
+    }
+
+    void add(const Identifier id, const size_t size)
+    {
+        _lru.push_back(id);
+        _index[id] = {size, std::prev(_lru.end())};
+        _usedMemBytes += size;
+    }
+
+    // Removes the least recently used bricks until size more bytes fit
+    void evict(const size_t size)
+    {
+        while (!_lru.empty() && _usedMemBytes + size > _maxMemBytes)
+        {
+            const Identifier id = _lru.front();
+            boost::system::error_code error;
+            fs::remove(getPath(id), error);
+            _usedMemBytes -= _index[id].size;
+            _index.erase(id);
+            _lru.pop_front();
+        }
+    }
+
+    ConstMemoryUnitPtr load(const NodeId& nodeId)
+    {
+        const Identifier id = nodeId.getId();
+        {
+            ScopedLock lock(_mutex);
+            auto it = _index.find(id);
+            if (it == _index.end())
+            {
+                ++_misses;
+                return ConstMemoryUnitPtr();
+            }
+            _lru.splice(_lru.end(), _lru, it->second.position);
+        }
+
+        // The brick may be removed meanwhile, then the mapping fails
+        const fs::path path = getPath(id);
+        std::shared_ptr<MappedMemoryUnit> data(new MappedMemoryUnit);
+        if (!data->map(path.string()))
+        {
+            ScopedLock lock(_mutex);
+            ++_misses;
+            return ConstMemoryUnitPtr();
+        }
+
+        boost::system::error_code error;
+        fs::last_write_time(path, std::time(0), error);
+
+        ScopedLock lock(_mutex);
+        ++_hits;
+        return data;
+    }
+
+    bool store(const NodeId& nodeId, ConstMemoryUnitPtr data,
+               const size_t uncompressedSize)
+    {
+        if (!data)
+            return false;
+        const size_t size =
+            uncompressedSize > 0 ? uncompressedSize : data->getAllocSize();
+        {
+            ScopedLock lock(_mutex);
+            if (_index.count(nodeId.getId()))
+                return true;
+            if (size == 0 || size > _maxMemBytes ||
+                _pendingWrites >= maxPendingWrites)
+            {
+                return false;
+            }
+            ++_pendingWrites;
+        }
+        _writes.push({nodeId, data, uncompressedSize});
+        return true;
+    }
+
+    void writeLoop()
+    {
+        lunchbox::Thread::setName("SpillWriter");
+        std::vector<uint8_t> buffer; // for decompression, reused
+        for (;;)
+        {
+            const Write write = _writes.pop();
+            if (!write.data)
+                return;
+
+            const Identifier id = write.nodeId.getId();
+            if (write.size == 0)
+                this->write(id, write.data->getData<uint8_t>(),
+                            write.data->getAllocSize());
+            else
+            {
+                buffer.resize(write.size);
+                if (decompress(write.data->getData<uint8_t>(),
+                               write.data->getAllocSize(), buffer.data(),
+                               write.size))
+                {
+                    this->write(id, buffer.data(), write.size);
+                }
+                else
+                    LBWARN << "Cannot spill corrupted compressed data of node "
+                           << write.nodeId << std::endl;
+            }
+
+            ScopedLock lock(_mutex);
+            --_pendingWrites;
+            _condition.notify_all();
+        }
+    }
+
+    // Writes to a temporary file first, so a brick file is always complete
+    void write(const Identifier id, const uint8_t* data, const size_t size)
+    {
+        {
+            ScopedLock lock(_mutex);
+            if (_index.count(id))
+                return;
+            evict(size);
+        }
+
+        const fs::path path = getPath(id);
+        fs::path tmpPath = path;
+        tmpPath.replace_extension(".tmp");
+        std::ofstream file(tmpPath.string(), std::ios::binary);
+        file.write(reinterpret_cast<const char*>(data), size);
+        file.close();
+        const bool written = !file.fail();
+
+        // A failed write leaves no file outside of the size bound
+        boost::system::error_code error;
+        if (written)
+            fs::rename(tmpPath, path, error);
+        if (!written || error)
+        {
+            LBWARN << "Cannot write spill file " << tmpPath << std::endl;
+            fs::remove(tmpPath, error);
+            return;
+        }
+
+        ScopedLock lock(_mutex);
+        evict(size); // concurrent loads do not change the size, but be safe
+        add(id, size);
+    }
+
+    void flush()
+    {
+        ScopedLock lock(_mutex);
+        while (_pendingWrites > 0)
+            _condition.wait(lock);
+    }
+
+    const fs::path _directory;
+    const size_t _maxMemBytes;
+    size_t _usedMemBytes;
+    size_t _pendingWrites;
+    size_t _hits;
+    size_t _misses;
+    std::list<Identifier> _lru;
+    std::unordered_map<Identifier, Entry> _index;
+    lunchbox::MTQueue<Write> _writes;
+    mutable boost::mutex _mutex;
+    boost::condition_variable _condition;
+    boost::thread _writeThread;
+};
+
+SpillCache::SpillCache(const std::string& directory, const size_t maxMemBytes,
+                       const servus::URI& uri,
+                       const VolumeInformation& volumeInfo)
+    : _impl(new SpillCache::Impl(directory, maxMemBytes, uri, volumeInfo))
+{
+}
+
+SpillCache::~SpillCache()
+{
+}
+
+ConstMemoryUnitPtr SpillCache::load(const NodeId& nodeId)
+{
+    return _impl->load(nodeId);
+}
+
+bool SpillCache::store(const NodeId& nodeId, ConstMemoryUnitPtr data,
+                       const size_t size)
+{
+    return _impl->store(nodeId, data, size);
+}
+
+void SpillCache::flush()
+{
+    _impl->flush();
+}
+
+size_t SpillCache::getCount() const
+{
+    ScopedLock lock(_impl->_mutex);
+    return _impl->_index.size();
+}
+
+size_t SpillCache::getUsedMemory() const
+{
+    ScopedLock lock(_impl->_mutex);
+    return _impl->_usedMemBytes;
+}
+
+size_t SpillCache::getMaximumMemory() const
+{
+    return _impl->_maxMemBytes;
+}
+
+size_t SpillCache::getHits() const
+{
+    ScopedLock lock(_impl->_mutex);
+    return _impl->_hits;
+}
+
+size_t SpillCache::getMisses() const
+{
+    ScopedLock lock(_impl->_mutex);
+    return _impl->_misses;
+}
+}
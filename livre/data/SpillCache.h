@@ -0,0 +1,109 @@
+/* Copyright (c) 2017, EPFL/Blue Brain Project
+ *                     bbp-open-source@googlegroups.com
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _SpillCache_h_
+#define _SpillCache_h_
+
+#include <livre/data/api.h>
+#include <livre/data/types.h>
+
+namespace livre
+{
+/**
+ * The SpillCache class is a persistent second level cache for the volume data
+ * on a local disk. Bricks evicted from the data cache are stored in a
+ * directory with one file per brick, and memory mapped again when they are
+ * needed, which is much faster than reading them from a remote file system.
+ *
+ * The size of the directory is bounded, least recently used bricks are
+ * removed first. The directory stays valid across restarts as long as the
+ * volume URI and version match; the version is derived from the volume
+ * information and, for local files, the modification time of the volume.
+ *
+ * Bricks are written asynchronously by a background thread, all methods are
+ * thread safe.
+ */
+class SpillCache
+{
+public:
+    /**
+     * Opens or creates the spill directory. Bricks of another volume or
+     * version are removed.
+     * @param directory the spill directory.
+     * @param maxMemBytes maximum size of the bricks in the directory.
+     * @param uri the volume URI.
+     * @param volumeInfo the volume information.
+     * @throw std::runtime_error if the directory cannot be created.
+     */
+    LIVREDATA_API SpillCache(const std::string& directory, size_t maxMemBytes,
+                             const servus::URI& uri,
+                             const VolumeInformation& volumeInfo);
+
+    /** Finishes the pending writes. */
+    LIVREDATA_API ~SpillCache();
+
+    /**
+     * Maps the data of a node from the spill directory.
+     * @param nodeId the node.
+     * @return the data or an empty pointer if it is not in the directory.
+     */
+    LIVREDATA_API ConstMemoryUnitPtr load(const NodeId& nodeId);
+
+    /**
+     * Queues the data of a node for writing. The write is dropped if the node
+     * is already stored, or too many writes are pending.
+     * @param nodeId the node.
+     * @param data the data of the node.
+     * @param size the uncompressed size if the data is compressed by
+     *        livre::compress(), then the writer thread decompresses it; 0 if
+     *        the data is not compressed.
+     * @return true if the data is queued or already stored, false if it was
+     *         dropped.
+     */
+    LIVREDATA_API bool store(const NodeId& nodeId, ConstMemoryUnitPtr data,
+                             size_t size = 0);
+
+    /** Waits until all queued writes are finished. */
+    LIVREDATA_API void flush();
+
+    /** @return the number of bricks in the directory. */
+    LIVREDATA_API size_t getCount() const;
+
+    /** @return the size of the bricks in the directory. */
+    LIVREDATA_API size_t getUsedMemory() const;
+
+    /** @return the maximum size of the bricks in the directory. */
+    LIVREDATA_API size_t getMaximumMemory() const;
+
+    /** @return the number of loads which found their brick. */
+    LIVREDATA_API size_t getHits() const;
+
+    /** @return the number of loads which did not find their brick. */
+    LIVREDATA_API size_t getMisses() const;
+
+private:
+    SpillCache(const SpillCache&) = delete;
+    SpillCache& operator=(const SpillCache&) = delete;
+
+    struct Impl;
+    std::unique_ptr<Impl> _impl;
+};
+}
+
+#endif // _SpillCache_h_
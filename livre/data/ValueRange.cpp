@@ -0,0 +1,89 @@
+/* Copyright (c) 2017, EPFL/Blue Brain Project
+ *                     bbp-open-source@googlegroups.com
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "ValueRange.h"
+
+#include <lunchbox/debug.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace livre
+{
+namespace
+{
+// The float nearest to an integer may lie on the other side of it above
+// 2^24, the range is rounded outwards to keep containing the values.
+template <class T>
+float _roundDown(const T value)
+{
+    const float result = float(value);
+    return double(result) > double(value)
+               ? std::nextafter(result, std::numeric_limits<float>::lowest())
+               : result;
+}
+
+template <class T>
+float _roundUp(const T value)
+{
+    const float result = float(value);
+    return double(result) < double(value)
+               ? std::nextafter(result, std::numeric_limits<float>::max())
+               : result;
+}
+
+template <class T>
+Range _computeValueRange(const uint8_t* data, const size_t size)
+{
+    const T* values = reinterpret_cast<const T*>(data);
+    const size_t nValues = size / sizeof(T);
+    if (nValues == 0)
+        return Range{{0.f, 0.f}};
+
+    const auto range = std::minmax_element(values, values + nValues);
+    return Range{{_roundDown(*range.first), _roundUp(*range.second)}};
+}
+}
+
+Range computeValueRange(const DataType dataType, const uint8_t* data,
+                        const size_t size)
+{
+    switch (dataType)
+    {
+    case DT_UINT8:
+        return _computeValueRange<uint8_t>(data, size);
+    case DT_UINT16:
+        return _computeValueRange<uint16_t>(data, size);
+    case DT_UINT32:
+        return _computeValueRange<uint32_t>(data, size);
+    case DT_INT8:
+        return _computeValueRange<int8_t>(data, size);
+    case DT_INT16:
+        return _computeValueRange<int16_t>(data, size);
+    case DT_INT32:
+        return _computeValueRange<int32_t>(data, size);
+    case DT_FLOAT:
+        return _computeValueRange<float>(data, size);
+    case DT_UNDEFINED:
+        break;
+    }
+    LBTHROW(std::runtime_error("Undefined data type"));
+}
+}
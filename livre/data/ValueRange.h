@@ -0,0 +1,61 @@
+/* Copyright (c) 2017, EPFL/Blue Brain Project
+ *                     bbp-open-source@googlegroups.com
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _ValueRange_h_
+#define _ValueRange_h_
+
+#include <livre/data/VolumeInformation.h> // DataType
+#include <livre/data/api.h>
+#include <livre/data/types.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace livre
+{
+/** The range of a node whose values are unknown, it contains all values. */
+const Range UNKNOWN_VALUE_RANGE = {{std::numeric_limits<float>::lowest(),
+                                    std::numeric_limits<float>::max()}};
+
+/**
+ * @param dataType the type of the values.
+ * @param data the values.
+ * @param size the size of the data in bytes.
+ * @return the minimum and maximum of the values, rounded outwards to the
+ *         nearest floats, [0, 0] without values.
+ * @throw std::runtime_error if the data type is undefined.
+ */
+LIVREDATA_API Range computeValueRange(DataType dataType, const uint8_t* data,
+                                      size_t size);
+
+/** @return the smallest range containing both ranges. */
+inline Range uniteValueRanges(const Range& a, const Range& b)
+{
+    return Range{{std::min(a[0], b[0]), std::max(a[1], b[1])}};
+}
+
+/** @return true if the range is UNKNOWN_VALUE_RANGE. */
+inline bool isUnknown(const Range& range)
+{
+    return range[0] == UNKNOWN_VALUE_RANGE[0] &&
+           range[1] == UNKNOWN_VALUE_RANGE[1];
+}
+}
+
+#endif // _ValueRange_h_
@@ -21,6 +21,7 @@
 #pragma once
 
 #include <array>
+#include <functional>
 #include <memory>
 #include <stdint.h>
 #include <vector>
@@ -35,6 +36,7 @@ namespace livre
 {
 class AllocMemoryUnit;
 class LODNode;
+class MemoryPool;
 class MemoryUnit;
 class NodeId;
 class NodeVisitor;
@@ -43,6 +45,8 @@ class VisitState;
 class DataSource;
 class DataSourcePlugin;
 class DataSourcePluginData;
+class SpillCache;
+class VisibleCut;
 
 struct VolumeInformation;
 
@@ -50,6 +54,7 @@ typedef uint64_t Identifier;
 typedef std::array<float, 2> Range;
 
 using vmml::Vector2ui;
+using vmml::Vector3i;
 using vmml::Vector3ui;
 using vmml::Vector3f;
 using vmml::Vector4f;
@@ -64,6 +69,7 @@ typedef Vector4f Plane;
 using ::lexis::render::ClipPlanes;
 
 typedef std::vector<NodeId> NodeIds;
+typedef std::vector<LODNode> LODNodes;
 
 enum AccessMode
 {
@@ -76,6 +82,12 @@ typedef std::shared_ptr<AllocMemoryUnit> AllocMemoryUnitPtr;
 typedef std::shared_ptr<MemoryUnit> MemoryUnitPtr;
 typedef std::shared_ptr<const MemoryUnit> ConstMemoryUnitPtr;
 
+/** Receives the data of a node, or an empty pointer if it cannot be read. */
+typedef std::function<void(const NodeId&, MemoryUnitPtr)> DataCallback;
+
+/** Tells whether all values of a range are transparent. */
+typedef std::function<bool(const Range&)> TransparencyFunc;
+
 // Constants
 const Identifier INVALID_NODE_ID = -1; //!< Invalid node ID.
 
@@ -43,9 +43,12 @@
 #include <livre/core/cache/Cache.h>
 #include <livre/core/cache/CacheStatistics.h>
 #include <livre/core/render/FrameInfo.h>
+#include <livre/core/render/OpacityLUT.h>
 #include <livre/data/DFSTraversal.h>
 #include <livre/data/DataSource.h>
 #include <livre/data/Frustum.h>
+#include <livre/data/MemoryPool.h>
+#include <livre/data/SelectVisibles.h>
 
 #include <livre/core/pipeline/Filter.h>
 #include <livre/core/pipeline/FutureMap.h>
@@ -298,17 +301,26 @@ public:
         const livre::Window* window =
             static_cast<const livre::Window*>(_channel->getWindow());
         const RenderPipeline& renderPipeline = window->getRenderPipeline();
-
+        const livre::Node* node =
+            static_cast<const livre::Node*>(_channel->getNode());
+        const OpacityLUT opacityLUT(
+            getFrameData().getRenderSettings().getTransferFunction(),
+            node->getDataSource().getVolumeInfo().dataType);
+
+        const VolumeRendererParameters& vrParams =
+            getFrameData().getVRParameters();
         _renderer->update(getFrameData());
         renderPipeline.render(
-            {getFrameData().getVRParameters(),
+            {vrParams,
              _frameInfo,
              {{_drawRange.start, _drawRange.end}},
              getFrameData().getVolumeSettings().getDataSourceRange(),
              PixelViewport(pvp.x, pvp.y, pvp.w, pvp.h),
              Viewport(vp.x, vp.y, vp.w, vp.h),
              getFrameData().getRenderSettings().getClipPlanes(),
-             getFrameData().getFrameSettings().isIdle()},
+             getFrameData().getFrameSettings().isIdle(),
+             opacityLUT,
+             vrParams.getIncrementalVisibles() ? &_visibleCut : nullptr},
             PipeFilterT<RedrawFilter>("RedrawFilter", _channel),
             PipeFilterT<SendHistogramFilter>("SendHistogramFilter", _channel),
             *_renderer, _availability);
@@ -321,7 +333,6 @@ public:
                            frustum.top(), frustum.nearPlane(),
                            frustum.farPlane(), {xfm.data(), xfm.data() + 16}));
 
-        livre::Node* node = static_cast<livre::Node*>(_channel->getNode());
         const auto& dataSource = node->getDataSource();
         for (const auto& id : _renderer->getVisibleNodes())
         {
@@ -394,8 +405,11 @@ public:
         const size_t nBricks = _renderer->getVisibleNodes().size();
         const float mbBricks = float(info.maximumBlockSize.product()) / 1024.f /
                                1024.f * float(nBricks);
-        os << nBricks << " bricks / " << mbBricks << " MB rendered" << std::endl
-           << "Total resolution " << info.voxels << " depth "
+        os << nBricks << " bricks / " << mbBricks << " MB rendered"
+           << std::endl;
+        if (getFrameData().getVRParameters().getIncrementalVisibles())
+            os << _visibleCut.getEvaluated() << " nodes evaluated" << std::endl;
+        os << "Total resolution " << info.voxels << " depth "
            << info.rootNode.getDepth() << std::endl
            << "Block resolution " << info.maximumBlockSize << std::endl;
 
@@ -445,7 +459,8 @@ public:
         std::ostringstream os;
         os << node->getDataCache().getStatistics() << "  "
            << int(100.f * done + .5f) << "% loaded" << std::endl
-           << window->getTextureCache().getStatistics();
+           << window->getTextureCache().getStatistics()
+           << MemoryPool::getInstance().getStatistics() << std::endl;
 
         float y = 260.f;
         std::string text = os.str();
@@ -618,6 +633,7 @@ public:
     FrameGrabber _frameGrabber;
     FrameInfo _frameInfo;
     NodeAvailability _availability;
+    VisibleCut _visibleCut;
     std::unique_ptr<RayCastRenderer> _renderer;
     ::lexis::data::Progress _progress;
 #ifdef LIVRE_USE_ZEROEQ
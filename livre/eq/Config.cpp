@@ -29,6 +29,7 @@
 #include <livre/eq/settings/RenderSettings.h>
 #include <livre/lib/configuration/ApplicationParameters.h>
 #include <livre/lib/configuration/VolumeRendererParameters.h>
+#include <livre/lib/zerobuf/cacheBudgets.h>
 
 #include <livre/core/util/FrameUtils.h>
 #include <livre/data/VolumeInformation.h>
@@ -78,6 +79,7 @@ public:
 
     eq::Layout* activeLayout = nullptr;
     Histogram _histogram;
+    CacheBudgets cacheBudgets;
 };
 
 Config::Config(eq::ServerPtr parent)
@@ -136,6 +138,16 @@ const Histogram& Config::getHistogram() const
     return _impl->_histogram;
 }
 
+const CacheBudgets& Config::getCacheBudgets() const
+{
+    return _impl->cacheBudgets;
+}
+
+CacheBudgets& Config::getCacheBudgets()
+{
+    return _impl->cacheBudgets;
+}
+
 const VolumeInformation& Config::getVolumeInformation() const
 {
     return _impl->volumeInfo;
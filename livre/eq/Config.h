@@ -118,6 +118,10 @@ public:
     /** @internal */
     void setHistogram(const Histogram& histogram);
 
+    /** @return the shares of the CPU memory of the last reporting node. */
+    const CacheBudgets& getCacheBudgets() const;
+    CacheBudgets& getCacheBudgets();
+
 private:
     LIVREEQ_API virtual ~Config();
 
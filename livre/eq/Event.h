@@ -31,7 +31,8 @@ enum ConfigEventType
     GRAB_IMAGE = eq::EVENT_USER,
     VOLUME_INFO,
     REDRAW,
-    HISTOGRAM_DATA
+    HISTOGRAM_DATA,
+    CACHE_BUDGETS
 };
 }
 
@@ -28,6 +28,7 @@
 #include <livre/eq/settings/CameraSettings.h>
 #include <livre/eq/settings/FrameSettings.h>
 #include <livre/lib/configuration/VolumeRendererParameters.h>
+#include <livre/lib/zerobuf/cacheBudgets.h>
 
 namespace livre
 {
@@ -213,6 +214,11 @@ bool EventHandler<C>::handleEvent(const eq::EventType type,
         frameSettings.toggleInfo();
         return true;
 
+    case 'm':
+    case 'M':
+        frameSettings.requestCacheManifest();
+        return true;
+
     case 'l':
         _impl->config.switchLayout(1);
         return true;
@@ -286,6 +292,10 @@ bool EventHandler<C>::handleEvent(eq::EventICommand command)
         command >> _impl->config.getVolumeInformation();
         return false;
 
+    case CACHE_BUDGETS:
+        _impl->config.getCacheBudgets().fromJSON(command.read<std::string>());
+        return false;
+
     case REDRAW:
         _impl->config.postRedraw();
         return true;
@@ -29,17 +29,26 @@
 #include <livre/eq/FrameData.h>
 #include <livre/eq/Pipe.h>
 #include <livre/eq/serialization.h>
+#include <livre/eq/settings/FrameSettings.h>
 #include <livre/eq/settings/VolumeSettings.h>
 
 #include <livre/lib/cache/DataObject.h>
 #include <livre/lib/cache/HistogramObject.h>
 #include <livre/lib/configuration/VolumeRendererParameters.h>
+#include <livre/lib/zerobuf/cacheBudgets.h>
 
 #include <livre/core/cache/Cache.h>
+#include <livre/core/cache/CacheArbiter.h>
+#include <livre/core/cache/CachePrefetcher.h>
+#include <livre/core/util/MemoryPressureMonitor.h>
 #include <livre/data/DataSource.h>
+#include <livre/data/MemoryPool.h>
+#include <livre/data/SpillCache.h>
+#include <livre/data/VolumeInformation.h>
 
 #include <eq/eq.h>
 #include <eq/gl.h>
+#include <lunchbox/clock.h>
 
 namespace livre
 {
@@ -49,6 +58,7 @@ public:
     explicit Impl(livre::Node* node)
         : _node(node)
         , _config(static_cast<livre::Config*>(node->getConfig()))
+        , _manifestRequests(0)
     {
     }
 
@@ -57,14 +67,114 @@ public:
         const VolumeRendererParameters& vrRenderParameters =
             _config->getFrameData().getVRParameters();
 
+        const std::string& spillDirectory =
+            vrRenderParameters.getDataSpillDirectoryString();
+        if (!spillDirectory.empty())
+        {
+            try
+            {
+                const VolumeSettings& volumeSettings =
+                    _config->getFrameData().getVolumeSettings();
+                _dataSpillCache.reset(new SpillCache(
+                    spillDirectory,
+                    vrRenderParameters.getDataSpillMemory() * LB_1MB,
+                    lunchbox::URI(volumeSettings.getURI()),
+                    _dataSource->getVolumeInfo()));
+            }
+            catch (const std::runtime_error& err)
+            {
+                LBWARN << err.what() << std::endl;
+            }
+        }
+
+        MemoryPool::getInstance().setHugePages(
+            vrRenderParameters.getDataHugePages());
+
+        // The data and histogram caches share the CPU memory budget. The
+        // histograms start with 32 MB, approx 16k histograms, and the arbiter
+        // moves memory to the cache whose misses cost more.
         const size_t maxMemBytes =
             vrRenderParameters.getMaxCpuCacheMemory() * LB_1MB;
-        _dataCache.reset(new CacheT<DataObject>("DataCache", maxMemBytes));
+        const size_t histCacheSize = std::min(32 * LB_1MB, maxMemBytes / 4);
+        _dataCache.reset(new CacheT<DataObject>(
+            "DataCache", maxMemBytes - histCacheSize,
+            CachePolicyType(vrRenderParameters.getDataCachePolicy())));
 
-        const size_t histCacheSize =
-            32 * LB_1MB; // Histogram cache is 32 MB. Can hold approx 16k hists
-        _histogramCache.reset(
-            new CacheT<HistogramObject>("HistogramCache", histCacheSize));
+        _histogramCache.reset(new CacheT<HistogramObject>(
+            "HistogramCache", histCacheSize,
+            CachePolicyType(vrRenderParameters.getHistogramCachePolicy())));
+
+        _cacheArbiter.reset(new CacheArbiter);
+        _cacheArbiter->add(*_dataCache, maxMemBytes / 2);
+        _cacheArbiter->add(*_histogramCache, histCacheSize / 8);
+
+        const std::string& cgroup = vrRenderParameters.getMemoryCgroupString();
+        if (!cgroup.empty())
+        {
+            try
+            {
+                _memoryMonitor.reset(new MemoryPressureMonitor(cgroup));
+            }
+            catch (const std::runtime_error& err)
+            {
+                LBWARN << err.what() << std::endl;
+            }
+        }
+
+        startPrefetching();
+    }
+
+    // Identifies the volume the manifest of the data cache was saved for
+    std::string getManifestSignature() const
+    {
+        const VolumeInformation& volumeInfo = _dataSource->getVolumeInfo();
+        std::stringstream signature;
+        signature << _config->getFrameData().getVolumeSettings().getURI()
+                  << " " << volumeInfo.voxels << " "
+                  << volumeInfo.maximumBlockSize << " "
+                  << volumeInfo.rootNode.getDepth();
+        return signature.str();
+    }
+
+    // Warms up the data cache with the hot set of the last session
+    void startPrefetching()
+    {
+        const VolumeRendererParameters& vrParams =
+            _config->getFrameData().getVRParameters();
+        const std::string& manifest = vrParams.getDataCacheManifestString();
+        if (manifest.empty())
+            return;
+
+        const CacheIds cacheIds =
+            loadCacheManifest(manifest, getManifestSignature());
+        if (cacheIds.empty())
+            return;
+
+        const bool compress = vrParams.getDataCacheCompression();
+        _prefetcher.reset(new CachePrefetcher(
+            *_dataCache, cacheIds, [this, compress](const CacheId& cacheId) {
+                return _dataCache->load<DataObject>(cacheId, *_dataSource,
+                                                    _dataSpillCache.get(),
+                                                    compress);
+            }));
+    }
+
+    void saveManifest()
+    {
+        const std::string& manifest = _config->getFrameData()
+                                          .getVRParameters()
+                                          .getDataCacheManifestString();
+        if (manifest.empty() || !_dataCache)
+            return;
+
+        try
+        {
+            saveCacheManifest(*_dataCache, manifest, getManifestSignature());
+        }
+        catch (const std::runtime_error& err)
+        {
+            LBWARN << err.what() << std::endl;
+        }
     }
 
     bool initializeVolume()
@@ -101,6 +211,75 @@ public:
     {
         if (!_node->isApplicationNode())
             _config->getFrameData().sync(frameId);
+
+        const uint32_t manifestRequests = _config->getFrameData()
+                                              .getFrameSettings()
+                                              .getCacheManifestRequests();
+        if (manifestRequests != _manifestRequests)
+        {
+            _manifestRequests = manifestRequests;
+            saveManifest();
+        }
+        rebalanceCaches();
+    }
+
+    // Rebalances the CPU memory every second and reports the budgets to
+    // the application, which serves them over HTTP
+    void rebalanceCaches()
+    {
+        if (!_cacheArbiter || _rebalanceClock.getTimef() < 1000.f)
+            return;
+
+        _rebalanceClock.reset();
+        adaptToMemoryPressure();
+        _cacheArbiter->rebalance();
+
+        CacheBudgets cacheBudgets;
+        cacheBudgets.setTotalMemory(_cacheArbiter->getMaximumMemory());
+        std::vector<v1::CacheBudget> caches;
+        for (const CacheArbiter::Budget& budget : _cacheArbiter->getBudgets())
+        {
+            v1::CacheBudget cache;
+            cache.setName(budget.name);
+            cache.setMaximumMemory(budget.maxMemBytes);
+            cache.setUsedMemory(budget.usedMemBytes);
+            cache.setHitRatio(budget.hitRatio);
+            cache.setLoadTime(budget.loadTime);
+            caches.push_back(cache);
+        }
+        cacheBudgets.setCaches(caches);
+        _config->sendEvent(CACHE_BUDGETS) << cacheBudgets.toJSON();
+    }
+
+    // Shrinks the CPU caches before the cgroup limit is hit, and grows them
+    // back up to --cpu-cache-mem when the memory is available again
+    void adaptToMemoryPressure()
+    {
+        if (!_memoryMonitor)
+            return;
+
+        const size_t maxMemBytes = _config->getFrameData()
+                                       .getVRParameters()
+                                       .getMaxCpuCacheMemory() *
+                                   LB_1MB;
+        const size_t budget = _cacheArbiter->getMaximumMemory();
+        const size_t newBudget =
+            _memoryMonitor->getBudget(budget, maxMemBytes / 8, maxMemBytes);
+        if (newBudget == budget)
+            return;
+
+        _cacheArbiter->setMaximumMemory(newBudget);
+        if (newBudget < budget)
+        {
+            MemoryPool::getInstance().trim();
+            MemoryPressureMonitor::releaseFreeMemory();
+        }
+    }
+
+    void configExit()
+    {
+        _prefetcher.reset();
+        saveManifest();
     }
 
     void updateDataSource()
@@ -115,8 +294,14 @@ public:
     livre::Node* const _node;
     livre::Config* const _config;
     std::unique_ptr<DataSource> _dataSource;
+    std::unique_ptr<SpillCache> _dataSpillCache; // outlives the data cache
     std::unique_ptr<Cache> _dataCache;
     std::unique_ptr<Cache> _histogramCache;
+    std::unique_ptr<CacheArbiter> _cacheArbiter;  // uses the caches
+    std::unique_ptr<CachePrefetcher> _prefetcher; // uses the caches
+    std::unique_ptr<MemoryPressureMonitor> _memoryMonitor;
+    lunchbox::Clock _rebalanceClock;
+    uint32_t _manifestRequests;
 };
 
 Node::Node(eq::Config* parent)
@@ -157,6 +342,7 @@ bool Node::configExit()
 {
     livre::Client* client = static_cast<livre::Client*>(getClient().get());
     client->setIdleFunction(IdleFunc());
+    _impl->configExit();
     if (!isApplicationNode())
     {
         Config* config = static_cast<Config*>(getConfig());
@@ -181,6 +367,11 @@ Cache& Node::getDataCache()
     return *_impl->_dataCache;
 }
 
+SpillCache* Node::getDataSpillCache()
+{
+    return _impl->_dataSpillCache.get();
+}
+
 livre::Cache& livre::Node::getHistogramCache()
 {
     return *_impl->_histogramCache;
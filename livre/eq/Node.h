@@ -51,6 +51,9 @@ public:
     /** @return The data cache. */
     Cache& getDataCache();
 
+    /** @return The second level of the data cache, nullptr if disabled. */
+    SpillCache* getDataSpillCache();
+
     /** @return The histogram cache. */
     Cache& getHistogramCache();
 
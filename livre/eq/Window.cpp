@@ -59,14 +59,17 @@ public:
 
         Node* node = static_cast<Node*>(_window->getNode());
         Pipe* pipe = static_cast<Pipe*>(_window->getPipe());
-        const size_t maxGpuMemory =
-            pipe->getFrameData().getVRParameters().getMaxGpuCacheMemory();
+        const VolumeRendererParameters& vrParams =
+            pipe->getFrameData().getVRParameters();
+        const size_t maxGpuMemory = vrParams.getMaxGpuCacheMemory();
 
         _texturePool.reset(new TexturePool(node->getDataSource()));
-        _textureCache.reset(
-            new CacheT<TextureObject>("TextureCache", maxGpuMemory * LB_1MB));
+        _textureCache.reset(new CacheT<TextureObject>(
+            "TextureCache", maxGpuMemory * LB_1MB,
+            CachePolicyType(vrParams.getTextureCachePolicy())));
         Caches caches = {node->getDataCache(), *_textureCache,
-                         node->getHistogramCache()};
+                         node->getHistogramCache(),
+                         node->getDataSpillCache()};
         _renderPipeline.reset(new RenderPipeline(node->getDataSource(), caches,
                                                  *_texturePool, _glContext));
     }
@@ -168,9 +168,9 @@ struct RayCastRenderer::Impl
         _drawAxis = frameData.getVRParameters().getShowAxes();
         _linearFiltering = frameData.getVRParameters().getLinearFiltering();
 
-        const auto& range =
-            frameData.getRenderSettings().getTransferFunction().getRange();
-        _dataSourceRange = {float(range[0]), float(range[1])};
+        _dataSourceRange =
+            frameData.getRenderSettings().getTransferFunction().getDataRange(
+                _volInfo.dataType);
     }
 
     void initTransferFunction(const TransferFunction1D& transferFunction)
@@ -234,43 +234,20 @@ struct RayCastRenderer::Impl
                 std::max(maxVoxelsAtLOD, (float)minSamplesPerRay);
         }
 
-        Vector2f dataSourceRange;
         uint32_t shaderDataType;
         switch (_dataSource.getVolumeInfo().dataType)
         {
         case DT_UINT8:
-            dataSourceRange = Vector2f(std::numeric_limits<uint8_t>::min(),
-                                       std::numeric_limits<uint8_t>::max());
-            shaderDataType = SH_UINT;
-            break;
         case DT_UINT16:
-            dataSourceRange = Vector2f(std::numeric_limits<uint16_t>::min(),
-                                       std::numeric_limits<uint16_t>::max());
-            shaderDataType = SH_UINT;
-            break;
         case DT_UINT32:
-            dataSourceRange = Vector2f(std::numeric_limits<uint32_t>::min(),
-                                       std::numeric_limits<uint32_t>::max());
             shaderDataType = SH_UINT;
             break;
         case DT_FLOAT:
-            dataSourceRange = Vector2f(std::numeric_limits<float>::min(),
-                                       std::numeric_limits<float>::max());
             shaderDataType = SH_FLOAT;
             break;
         case DT_INT8:
-            dataSourceRange = Vector2f(std::numeric_limits<int8_t>::min(),
-                                       std::numeric_limits<int8_t>::max());
-            shaderDataType = SH_INT;
-            break;
         case DT_INT16:
-            dataSourceRange = Vector2f(std::numeric_limits<int16_t>::min(),
-                                       std::numeric_limits<int16_t>::max());
-            shaderDataType = SH_INT;
-            break;
         case DT_INT32:
-            dataSourceRange = Vector2f(std::numeric_limits<int32_t>::min(),
-                                       std::numeric_limits<int32_t>::max());
             shaderDataType = SH_INT;
             break;
         case DT_UNDEFINED:
@@ -278,13 +255,6 @@ struct RayCastRenderer::Impl
             LBTHROW(std::runtime_error("Unsupported type in the shader."));
         }
 
-        // use materialLUT data range only if valid, otherwise full data range
-        if (_dataSourceRange[1] > 0 &&
-            _dataSourceRange[1] - _dataSourceRange[0] > 0)
-        {
-            dataSourceRange = _dataSourceRange;
-        }
-
         glEnable(GL_CULL_FACE);
         glDisable(GL_DEPTH_TEST);
         glDisable(GL_BLEND);
@@ -349,7 +319,7 @@ struct RayCastRenderer::Impl
         glUniform1ui(tParamNameGL, shaderDataType);
 
         tParamNameGL = glGetUniformLocation(program, "dataSourceRange");
-        glUniform2fv(tParamNameGL, 1, dataSourceRange.array);
+        glUniform2fv(tParamNameGL, 1, _dataSourceRange.array);
 
         if (nPlanes > 0)
         {
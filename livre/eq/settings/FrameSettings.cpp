@@ -42,12 +42,14 @@ void FrameSettings::reset()
 
 void FrameSettings::serialize(co::DataOStream& os, uint64_t)
 {
-    os << frameNumber_ << statistics_ << info_ << grabFrame_ << idle_;
+    os << frameNumber_ << statistics_ << info_ << grabFrame_ << idle_
+       << manifestRequests_;
 }
 
 void FrameSettings::deserialize(co::DataIStream& is, uint64_t)
 {
-    is >> frameNumber_ >> statistics_ >> info_ >> grabFrame_ >> idle_;
+    is >> frameNumber_ >> statistics_ >> info_ >> grabFrame_ >> idle_ >>
+        manifestRequests_;
 }
 
 void FrameSettings::setFrameNumber(uint32_t frame)
@@ -108,4 +110,10 @@ bool FrameSettings::isIdle() const
 {
     return idle_;
 }
+
+void FrameSettings::requestCacheManifest()
+{
+    ++manifestRequests_;
+    setDirty(DIRTY_ALL);
+}
 }
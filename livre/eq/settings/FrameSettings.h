@@ -86,6 +86,12 @@ public:
     /** @return true if idle rendering is active. */
     bool isIdle() const;
 
+    /** Requests the nodes to save the manifest of their data cache. */
+    void requestCacheManifest();
+
+    /** @return the number of cache manifest requests so far. */
+    uint32_t getCacheManifestRequests() const { return manifestRequests_; }
+
 private:
     void serialize(co::DataOStream& os, const uint64_t dirtyBits) final;
     void deserialize(co::DataIStream& is, const uint64_t dirtyBits) final;
@@ -95,6 +101,7 @@ private:
     bool info_;
     bool grabFrame_;
     bool idle_{true};
+    uint32_t manifestRequests_{0};
 };
 }
 
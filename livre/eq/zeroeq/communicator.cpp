@@ -30,6 +30,7 @@
 
 #include <livre/lib/configuration/ApplicationParameters.h>
 #include <livre/lib/configuration/VolumeRendererParameters.h>
+#include <livre/lib/zerobuf/cacheBudgets.h>
 
 #include <livre/data/DataSource.h>
 #include <livre/data/VolumeInformation.h>
@@ -212,6 +213,7 @@ private:
         _httpServer->handle(_getFrameData().getVRParameters());
         _httpServer->handle(_getRenderSettings().getTransferFunction());
         _httpServer->handle(_getRenderSettings().getClipPlanes());
+        _httpServer->handleGET(_config.getCacheBudgets());
 #endif
     }
 
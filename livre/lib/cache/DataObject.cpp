@@ -21,36 +21,146 @@
 #include <livre/lib/cache/DataObject.h>
 
 #include <livre/core/cache/Cache.h>
+#include <livre/core/cache/CacheStatistics.h>
+#include <livre/data/Compression.h>
 #include <livre/data/DataSource.h>
+#include <livre/data/MemoryUnit.h>
+#include <livre/data/SpillCache.h>
+
+#include <lunchbox/clock.h>
 
 namespace livre
 {
 struct DataObject::Impl
 {
 public:
-    Impl(const CacheId& cacheId, DataSource& dataSource)
+    Impl(const CacheId& cacheId, DataSource& dataSource,
+         SpillCache* spillCache, const bool compressed)
+        : _nodeId(cacheId)
+        , _spillCache(spillCache)
+        , _compressed(false)
+        , _size(0)
+    {
+        if (!load(dataSource))
+            LBTHROW(
+                CacheLoadException(cacheId,
+                                   "Unable to construct data cache object"));
+
+        _size = _data->getAllocSize();
+        if (compressed)
+            compress(dataSource.getVolumeInfo().getBytesPerVoxel());
+    }
+
+    Impl(const CacheId& cacheId, ConstMemoryUnitPtr data,
+         const size_t bytesPerVoxel, SpillCache* spillCache,
+         const bool compressed)
+        : _nodeId(cacheId)
+        , _spillCache(spillCache)
+        , _data(data)
+        , _compressed(false)
+        , _size(0)
     {
-        if (!load(cacheId, dataSource))
+        if (!_data)
             LBTHROW(
                 CacheLoadException(cacheId,
                                    "Unable to construct data cache object"));
+
+        _size = _data->getAllocSize();
+        if (compressed)
+            compress(bytesPerVoxel);
+    }
+
+    // Evicted data is spilled, unless it came from the spill cache or maps
+    // the data source. This runs under the lock of the cache, so compressed
+    // data is decompressed by the writer thread of the spill cache.
+    void evicted(CacheStatistics& statistics) const
+    {
+        if (!_spillCache || _data->isMapped())
+            return;
+        bool stored = false;
+        try
+        {
+            stored =
+                _spillCache->store(_nodeId, _data, _compressed ? _size : 0);
+        }
+        catch (const std::exception& e)
+        {
+            LBWARN << "Cannot spill node " << _nodeId << ": " << e.what()
+                   << std::endl;
+        }
+        statistics.notifySpill(stored);
+    }
+
+    const void* getDataPtr() const
+    {
+        return _compressed ? nullptr : _data->getData<void>();
     }
 
-    ~Impl() {}
-    const void* getDataPtr() const { return _data->getData<void>(); }
-    bool load(const CacheId& cacheId, DataSource& dataSource)
+    ConstMemoryUnitPtr getData(const CacheStatistics* statistics) const
     {
-        const NodeId nodeId(cacheId);
-        _data = dataSource.getData(nodeId);
+        if (!_compressed)
+            return _data;
+
+        const lunchbox::Clock clock;
+        MemoryUnitPtr data(new PooledMemoryUnit(_size));
+        if (!decompress(_data->getData<uint8_t>(), _data->getAllocSize(),
+                        data->getData<uint8_t>(), _size))
+        {
+            LBTHROW(std::runtime_error("Corrupted compressed data for node " +
+                                       std::to_string(_nodeId.getId())));
+        }
+        if (statistics)
+            statistics->notifyDecompressed(_size, clock.getTimef());
+        return data;
+    }
+
+    bool load(DataSource& dataSource)
+    {
+        if (_spillCache)
+        {
+            _data = _spillCache->load(_nodeId);
+            if (_data)
+            {
+                _spillCache = nullptr;
+                return true;
+            }
+        }
+
+        _data = dataSource.getData(_nodeId);
         return !!_data;
     }
 
+    void compress(const size_t bytesPerVoxel)
+    {
+        std::vector<uint8_t> compressed =
+            livre::compress(_data->getData<uint8_t>(), _size, bytesPerVoxel);
+
+        // Incompressible data is kept as is
+        if (compressed.size() >= _size)
+            return;
+        _data.reset(new VectorMemoryUnit(std::move(compressed)));
+        _compressed = true;
+    }
+
+    const NodeId _nodeId;
+    SpillCache* _spillCache;
     ConstMemoryUnitPtr _data;
+    bool _compressed;
+    size_t _size;
 };
 
-DataObject::DataObject(const CacheId& cacheId, DataSource& dataSource)
+DataObject::DataObject(const CacheId& cacheId, DataSource& dataSource,
+                       SpillCache* spillCache, const bool compress)
+    : CacheObject(cacheId)
+    , _impl(new Impl(cacheId, dataSource, spillCache, compress))
+{
+}
+
+DataObject::DataObject(const CacheId& cacheId, ConstMemoryUnitPtr data,
+                       const size_t bytesPerVoxel, SpillCache* spillCache,
+                       const bool compress)
     : CacheObject(cacheId)
-    , _impl(new Impl(cacheId, dataSource))
+    , _impl(new Impl(cacheId, data, bytesPerVoxel, spillCache, compress))
 {
 }
 
@@ -63,8 +173,29 @@ size_t DataObject::getSize() const
     return _impl->_data->getAllocSize();
 }
 
+size_t DataObject::getUncompressedSize() const
+{
+    return _impl->_size;
+}
+
 const void* DataObject::getDataPtr() const
 {
     return _impl->getDataPtr();
 }
+
+ConstMemoryUnitPtr DataObject::getData(
+    const CacheStatistics* statistics) const
+{
+    return _impl->getData(statistics);
+}
+
+void DataObject::evicted(CacheStatistics& statistics) const
+{
+    _impl->evicted(statistics);
+}
+
+bool DataObject::isCompressed() const
+{
+    return _impl->_compressed;
+}
 }
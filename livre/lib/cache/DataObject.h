@@ -1,4 +1,4 @@
-/* Copyright (c) 2011-2015, EPFL/Blue Brain Project
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
  *                     Ahmet Bilgili <ahmet.bilgili@epfl.ch>
  *                     Daniel Nachbaur <daniel.nachbaur@epfl.ch>
  *
@@ -38,18 +38,61 @@ public:
      * Constructor
      * @param cacheId is the unique identifier
      * @param dataSource the data source cache object is created from
+     * @param spillCache optional second level cache, which is checked before
+     * the data source and receives the data when the object is evicted
+     * @param compress keep the data compressed in memory, trading the time to
+     * decompress it on every use for a larger cache
      * @throws CacheLoadException when the data cache does not have the data for
      * cache id
      */
-    LIVRE_API DataObject(const CacheId& cacheId, DataSource& dataSource);
+    LIVRE_API DataObject(const CacheId& cacheId, DataSource& dataSource,
+                         SpillCache* spillCache = nullptr,
+                         bool compress = false);
+
+    /**
+     * Constructor for data which was read already, e.g. by
+     * DataSource::getDataAsync().
+     * @param cacheId is the unique identifier
+     * @param data the data of the node
+     * @param bytesPerVoxel the size of a voxel of the data
+     * @param spillCache optional second level cache, which receives the data
+     * when the object is evicted
+     * @param compress keep the data compressed in memory
+     * @throws CacheLoadException when the data is empty
+     */
+    LIVRE_API DataObject(const CacheId& cacheId, ConstMemoryUnitPtr data,
+                         size_t bytesPerVoxel, SpillCache* spillCache = nullptr,
+                         bool compress = false);
+
     LIVRE_API ~DataObject();
 
-    /** @return A pointer to the data or 0 if no data is loaded. */
+    /**
+     * @return A pointer to the data or 0 if no data is loaded or the data is
+     * compressed.
+     */
     LIVRE_API const void* getDataPtr() const;
 
+    /**
+     * @param statistics optional statistics the decompression is reported to
+     * @return the data, decompressed into a pooled buffer which is reused once
+     * the returned memory unit is released.
+     * @throws std::runtime_error if the compressed data is corrupted
+     */
+    LIVRE_API ConstMemoryUnitPtr
+        getData(const CacheStatistics* statistics = nullptr) const;
+
+    /** @return true if the data is kept compressed in memory */
+    LIVRE_API bool isCompressed() const;
+
     /** @copydoc livre::CacheObject::getSize */
     LIVRE_API size_t getSize() const final;
 
+    /** @copydoc livre::CacheObject::getUncompressedSize */
+    LIVRE_API size_t getUncompressedSize() const final;
+
+    /** Spills the data, see CacheObject::evicted(). */
+    LIVRE_API void evicted(CacheStatistics& statistics) const final;
+
 private:
     struct Impl;
     std::unique_ptr<Impl> _impl;
@@ -22,6 +22,7 @@
 
 #include <livre/core/cache/Cache.h>
 #include <livre/data/DataSource.h>
+#include <livre/data/MemoryUnit.h>
 
 namespace livre
 {
@@ -149,7 +150,9 @@ public:
         if (!data)
             return false;
 
-        const void* rawData = data->getDataPtr();
+        const ConstMemoryUnitPtr unit =
+            data->getData(&dataCache.getStatistics());
+        const void* rawData = unit->getData<void>();
         const LODNode& lodNode = dataSource.getNode(NodeId(cacheId));
         const Vector3ui& voxelBox = lodNode.getVoxelBox().getSize();
         const Vector3ui& padding = volumeInfo.overlap;
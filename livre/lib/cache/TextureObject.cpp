@@ -26,6 +26,7 @@
 #include <livre/core/render/TexturePool.h>
 #include <livre/data/DataSource.h>
 #include <livre/data/LODNode.h>
+#include <livre/data/MemoryUnit.h>
 
 #include <eq/gl.h>
 
@@ -69,13 +70,18 @@ struct TextureObject::Impl
         if (!data)
             return false;
 
-        initialize(cacheId, dataSource, texturePool, data);
+        // Mapped data may have been paged out while it was cached, and a page
+        // fault in the texture upload stalls the driver
+        const ConstMemoryUnitPtr memoryUnit =
+            data->getData(&dataCache.getStatistics());
+        memoryUnit->prefetch();
+        initialize(cacheId, dataSource, texturePool, memoryUnit);
         return true;
     }
 
     void initialize(const CacheId& cacheId, const DataSource& dataSource,
                     const TexturePool& texturePool,
-                    const ConstDataObjectPtr& data)
+                    const ConstMemoryUnitPtr& data)
     {
         // TODO: The internal format size should be calculated correctly
         const Vector3f& overlap = dataSource.getVolumeInfo().overlap;
@@ -93,7 +99,7 @@ struct TextureObject::Impl
 
     bool loadTextureToGPU(const LODNode& lodNode, const DataSource& dataSource,
                           const TexturePool& texturePool,
-                          const ConstDataObjectPtr& data) const
+                          const ConstMemoryUnitPtr& data) const
     {
 #ifdef LIVRE_DEBUG_RENDERING
         std::cout << "Upload " << lodNode.getNodeId().getLevel() << ' '
@@ -106,7 +112,7 @@ struct TextureObject::Impl
 
         glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, 0, voxSizeVec[0], voxSizeVec[1],
                         voxSizeVec[2], texturePool.getFormat(),
-                        texturePool.getTextureType(), data->getDataPtr());
+                        texturePool.getTextureType(), data->getData<void>());
 
         const GLenum glErr = glGetError();
         if (glErr != GL_NO_ERROR)
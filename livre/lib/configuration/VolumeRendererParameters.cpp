@@ -20,6 +20,8 @@
 
 #include "VolumeRendererParameters.h"
 
+#include <livre/core/cache/CachePolicy.h>
+
 namespace livre
 {
 const std::string SCREENSPACEERROR_PARAM = "sse";
@@ -30,6 +32,27 @@ const std::string MINLOD_PARAM = "min-lod";
 const std::string MAXLOD_PARAM = "max-lod";
 const std::string SAMPLESPERRAY_PARAM = "samples-per-ray";
 const std::string LINEARFILTERING_PARAM = "linear-filtering";
+const std::string DATACACHEPOLICY_PARAM = "data-cache-policy";
+const std::string TEXTURECACHEPOLICY_PARAM = "texture-cache-policy";
+const std::string HISTOGRAMCACHEPOLICY_PARAM = "histogram-cache-policy";
+const std::string DATASPILLDIR_PARAM = "data-spill-dir";
+const std::string DATASPILLMEM_PARAM = "data-spill-mem";
+const std::string DATACOMPRESSION_PARAM = "data-cache-compression";
+const std::string DATAMANIFEST_PARAM = "data-cache-manifest";
+const std::string MEMORYCGROUP_PARAM = "memory-cgroup";
+const std::string DATAHUGEPAGES_PARAM = "data-huge-pages";
+const std::string INCREMENTALVISIBLES_PARAM = "incremental-visibles";
+
+namespace
+{
+uint32_t getPolicy(const Configuration& configuration, const std::string& key,
+                   const uint32_t defaultValue)
+{
+    const std::string name = configuration.getValue(
+        key, getCachePolicyName(CachePolicyType(defaultValue)));
+    return getCachePolicyType(name);
+}
+}
 
 VolumeRendererParameters::VolumeRendererParameters()
     : Parameters("Volume Renderer Parameters")
@@ -65,6 +88,49 @@ VolumeRendererParameters::VolumeRendererParameters()
     configuration_.addDescription(
         configGroupName_, LINEARFILTERING_PARAM,
         "Use linear texture filtering instead of nearest", false);
+    configuration_.addDescription(
+        configGroupName_, DATACACHEPOLICY_PARAM,
+        "Eviction policy of the CPU data cache (lru, arc, cost, octree)",
+        getCachePolicyName(CachePolicyType(getDataCachePolicy())));
+    configuration_.addDescription(
+        configGroupName_, TEXTURECACHEPOLICY_PARAM,
+        "Eviction policy of the GPU texture cache (lru, arc, cost, octree)",
+        getCachePolicyName(CachePolicyType(getTextureCachePolicy())));
+    configuration_.addDescription(
+        configGroupName_, HISTOGRAMCACHEPOLICY_PARAM,
+        "Eviction policy of the histogram cache (lru, arc, cost, octree)",
+        getCachePolicyName(CachePolicyType(getHistogramCachePolicy())));
+    configuration_.addDescription(
+        configGroupName_, DATASPILLDIR_PARAM,
+        "Directory on a local disk for the volume data evicted from the CPU "
+        "cache, reused across restarts (disabled if empty)",
+        getDataSpillDirectoryString());
+    configuration_.addDescription(configGroupName_, DATASPILLMEM_PARAM,
+                                  "Maximum size of the data spill directory "
+                                  "(MB)",
+                                  getDataSpillMemory());
+    configuration_.addDescription(configGroupName_, DATACOMPRESSION_PARAM,
+                                  "Keep the volume data compressed in the CPU "
+                                  "cache to fit more of it",
+                                  getDataCacheCompression());
+    configuration_.addDescription(
+        configGroupName_, DATAMANIFEST_PARAM,
+        "File listing the CPU cache contents, saved on exit and prefetched "
+        "on startup (disabled if empty)",
+        getDataCacheManifestString());
+    configuration_.addDescription(
+        configGroupName_, MEMORYCGROUP_PARAM,
+        "cgroup v2 directory whose memory limit and pressure shrink the CPU "
+        "caches, 'auto' for the cgroup of the process (disabled if empty)",
+        getMemoryCgroupString());
+    configuration_.addDescription(configGroupName_, DATAHUGEPAGES_PARAM,
+                                  "Back the volume data memory pool by "
+                                  "transparent huge pages",
+                                  getDataHugePages());
+    configuration_.addDescription(configGroupName_, INCREMENTALVISIBLES_PARAM,
+                                  "Select the visible bricks incrementally "
+                                  "from the ones of the previous frame",
+                                  getIncrementalVisibles());
 }
 
 void VolumeRendererParameters::initialize_()
@@ -83,6 +149,27 @@ void VolumeRendererParameters::initialize_()
         configuration_.getValue(SAMPLESPERRAY_PARAM, getSamplesPerRay()));
     setLinearFiltering(
         configuration_.getValue(LINEARFILTERING_PARAM, getLinearFiltering()));
+    setDataCachePolicy(getPolicy(configuration_, DATACACHEPOLICY_PARAM,
+                                 getDataCachePolicy()));
+    setTextureCachePolicy(getPolicy(configuration_, TEXTURECACHEPOLICY_PARAM,
+                                    getTextureCachePolicy()));
+    setHistogramCachePolicy(getPolicy(configuration_,
+                                      HISTOGRAMCACHEPOLICY_PARAM,
+                                      getHistogramCachePolicy()));
+    setDataSpillDirectory(configuration_.getValue(
+        DATASPILLDIR_PARAM, getDataSpillDirectoryString()));
+    setDataSpillMemory(
+        configuration_.getValue(DATASPILLMEM_PARAM, getDataSpillMemory()));
+    setDataCacheCompression(configuration_.getValue(DATACOMPRESSION_PARAM,
+                                                    getDataCacheCompression()));
+    setDataCacheManifest(configuration_.getValue(
+        DATAMANIFEST_PARAM, getDataCacheManifestString()));
+    setMemoryCgroup(configuration_.getValue(MEMORYCGROUP_PARAM,
+                                            getMemoryCgroupString()));
+    setDataHugePages(
+        configuration_.getValue(DATAHUGEPAGES_PARAM, getDataHugePages()));
+    setIncrementalVisibles(configuration_.getValue(INCREMENTALVISIBLES_PARAM,
+                                                   getIncrementalVisibles()));
 }
 
 } // Livre
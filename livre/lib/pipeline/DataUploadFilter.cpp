@@ -24,50 +24,116 @@
 
 #include <livre/core/cache/Cache.h>
 #include <livre/core/pipeline/Pipeline.h>
+#include <livre/data/DataSource.h>
 #include <livre/data/NodeId.h>
+#include <livre/data/SpillCache.h>
 
 #include <eq/gl.h>
+#include <lunchbox/mtQueue.h>
 
 namespace livre
 {
+namespace
+{
+// The data read and uploaded per frame in asynchronous mode
+const size_t maxAsyncLoadBytes = 16 * LB_1MB;
+
+// The interval at which a reading is checked for having dropped nodes, ms
+const unsigned arrivalTimeout = 100;
+
+// The data of a node read by the data source, empty if the read failed
+typedef std::pair<NodeId, MemoryUnitPtr> Arrival;
+typedef lunchbox::MTQueue<Arrival> Arrivals;
+
+// Waits for the callbacks of a reading to return when leaving a scope, they
+// refer to the arrivals of the scope
+struct ReadingGuard
+{
+    explicit ReadingGuard(std::future<void>& reading_)
+        : reading(reading_)
+    {
+    }
+    ~ReadingGuard()
+    {
+        if (reading.valid())
+            reading.wait();
+    }
+    std::future<void>& reading;
+};
+}
+
 struct DataUploadFilter::Impl
 {
 public:
     Impl(Cache& dataCache, Cache& textureCache, DataSource& dataSource,
-         TexturePool& texturePool)
+         TexturePool& texturePool, SpillCache* dataSpillCache)
         : _dataCache(dataCache)
         , _textureCache(textureCache)
         , _dataSource(dataSource)
         , _texturePool(texturePool)
+        , _dataSpillCache(dataSpillCache)
     {
     }
 
-    ConstCacheObjects load(const NodeIds& visibles) const
+    // Textures are uploaded from the cached data and, in the order of their
+    // arrival, from the data which is missing in the caches. The missing data
+    // is read in one batch, in parallel to the uploads; the reader threads
+    // only queue it, it is cached and uploaded by this thread.
+    ConstCacheObjects load(const NodeIds& visibles,
+                           const bool compressData) const
     {
         ConstCacheObjects cacheObjects;
         cacheObjects.reserve(visibles.size());
-        bool isTextureUploaded = false;
+        NodeIds cached;
+        NodeIds missing;
         for (const NodeId& nodeId : visibles)
         {
             ConstTextureObjectPtr texture =
                 _textureCache.get<TextureObject>(nodeId.getId());
-            if (!texture)
-            {
-                if (!_dataCache.load<DataObject>(nodeId.getId(), _dataSource))
-                    continue;
+            if (texture)
+                cacheObjects.push_back(texture);
+            else if (isCached(nodeId, compressData))
+                cached.push_back(nodeId);
+            else
+                missing.push_back(nodeId);
+        }
 
-                texture =
-                    _textureCache.load<TextureObject>(nodeId.getId(),
-                                                      _dataCache, _dataSource,
-                                                      _texturePool);
-                if (!texture)
-                    continue;
+        Arrivals arrived;
+        std::future<void> reading;
+        const ReadingGuard guard(reading);
+        if (!missing.empty())
+        {
+            reading = _dataSource.getDataAsync(
+                missing, [&arrived](const NodeId& nodeId, MemoryUnitPtr data) {
+                    arrived.push(Arrival(nodeId, data));
+                });
+        }
 
-                cacheObjects.push_back(texture);
-                isTextureUploaded = true;
+        bool isTextureUploaded = false;
+        for (const NodeId& nodeId : cached)
+            isTextureUploaded |= upload(nodeId, compressData, cacheObjects);
+        for (size_t pending = missing.size(); pending > 0; --pending)
+        {
+            Arrival arrival;
+            if (!waitForArrival(arrived, reading, arrival))
+            {
+                LBWARN << pending << " nodes were not read" << std::endl;
+                break;
+            }
+            if (cache(arrival, compressData))
+                isTextureUploaded |=
+                    upload(arrival.first, compressData, cacheObjects);
+        }
+        if (reading.valid())
+        {
+            try
+            {
+                reading.get();
+            }
+            catch (const std::exception& e)
+            {
+                LBWARN << "Cannot read data: " << e.what() << std::endl;
             }
-            else
-                cacheObjects.push_back(texture);
         }
 
         if (isTextureUploaded)
@@ -76,6 +142,93 @@ public:
         return cacheObjects;
     }
 
+    // @return false if the reading has finished without calling back for the
+    // remaining nodes, e.g. after a failure in the data source
+    static bool waitForArrival(Arrivals& arrived, std::future<void>& reading,
+                               Arrival& arrival)
+    {
+        while (!arrived.timedPop(arrivalTimeout, arrival))
+        {
+            if (reading.valid() &&
+                reading.wait_for(std::chrono::seconds(0)) ==
+                    std::future_status::timeout)
+            {
+                continue;
+            }
+            if (reading.valid())
+                reading.wait(); // runs a deferred reading
+            return arrived.tryPop(arrival);
+        }
+        return true;
+    }
+
+    // @return true if the data of the node is in the data cache, after moving
+    // it there from the spill cache if needed
+    bool isCached(const NodeId& nodeId, const bool compressData) const
+    {
+        if (_dataCache.get<DataObject>(nodeId.getId()))
+            return true;
+        if (!_dataSpillCache)
+            return false;
+
+        // Not spilled again, as in the DataObject loaded by the cache
+        const ConstMemoryUnitPtr data = _dataSpillCache->load(nodeId);
+        return data &&
+               _dataCache.load<DataObject>(
+                   nodeId.getId(), data,
+                   _dataSource.getVolumeInfo().getBytesPerVoxel(),
+                   nullptr, compressData);
+    }
+
+    // @return true if the data read for a node is in the data cache
+    bool cache(const Arrival& arrival, const bool compressData) const
+    {
+        const NodeId& nodeId = arrival.first;
+        if (!arrival.second)
+            return false;
+        try
+        {
+            return bool(_dataCache.load<DataObject>(
+                nodeId.getId(), ConstMemoryUnitPtr(arrival.second),
+                _dataSource.getVolumeInfo().getBytesPerVoxel(),
+                _dataSpillCache, compressData));
+        }
+        catch (const std::exception& e)
+        {
+            LBWARN << "Cannot cache node " << nodeId << ": " << e.what()
+                   << std::endl;
+        }
+        return false;
+    }
+
+    // @return true if the texture was uploaded. The data is read again if it
+    // was evicted from the data cache in the meantime.
+    bool upload(const NodeId& nodeId, const bool compressData,
+                ConstCacheObjects& cacheObjects) const
+    {
+        try
+        {
+            if (!_dataCache.load<DataObject>(nodeId.getId(), _dataSource,
+                                             _dataSpillCache, compressData))
+                return false;
+
+            ConstTextureObjectPtr texture =
+                _textureCache.load<TextureObject>(nodeId.getId(), _dataCache,
+                                                  _dataSource, _texturePool);
+            if (!texture)
+                return false;
+
+            cacheObjects.push_back(texture);
+            return true;
+        }
+        catch (const std::exception& e)
+        {
+            LBWARN << "Cannot upload node " << nodeId << ": " << e.what()
+                   << std::endl;
+        }
+        return false;
+    }
+
     ConstCacheObjects get(const NodeIds& visibles) const
     {
         ConstCacheObjects cacheObjects;
@@ -100,26 +253,34 @@ public:
         const auto& visibles = uniqueInputs.get<NodeIds>("VisibleNodes");
 
         const bool isAsync = !vrParams.getSynchronousMode();
+        const bool compressData = vrParams.getDataCacheCompression();
 
         if (isAsync)
         {
             output.set("CacheObjects", get(visibles)); // Already loaded ones
 
-            // only load 1 missing texture at a time aka per frame. This might
-            // seem a waste of bandwidth but leads to a more responsive
-            // application as blocks which are not visible anymore won't still
-            // be queued for uploading.
+            // only load a bounded batch of missing textures per frame. The
+            // batch is read in parallel, but the frame stays short, and blocks
+            // which are not visible anymore won't still be queued for
+            // uploading.
+            const VolumeInformation& info = _dataSource.getVolumeInfo();
+            const size_t brickSize = std::max(
+                info.maximumBlockSize.product() * info.getBytesPerVoxel(),
+                size_t(1));
+            NodeIds missing;
             for (const auto& node : visibles)
             {
-                if (!_textureCache.get<TextureObject>(node.getId()))
-                {
-                    load(NodeIds(1, node)); // load
+                if (missing.size() * brickSize >= maxAsyncLoadBytes)
                     break;
-                }
+                if (!_textureCache.get<TextureObject>(node.getId()))
+                    missing.push_back(node);
             }
+            if (!missing.empty())
+                load(missing, compressData);
         }
         else
-            output.set("CacheObjects", load(visibles)); // load all
+            output.set("CacheObjects",
+                       load(visibles, compressData)); // load all
     }
 
     DataInfos getInputDataInfos() const
@@ -141,13 +302,15 @@ public:
     Cache& _textureCache;
     DataSource& _dataSource;
     TexturePool& _texturePool;
+    SpillCache* const _dataSpillCache;
 };
 
 DataUploadFilter::DataUploadFilter(Cache& dataCache, Cache& textureCache,
                                    DataSource& dataSource,
-                                   TexturePool& texturePool)
+                                   TexturePool& texturePool,
+                                   SpillCache* dataSpillCache)
     : _impl(new DataUploadFilter::Impl(dataCache, textureCache, dataSource,
-                                       texturePool))
+                                       texturePool, dataSpillCache))
 {
 }
 
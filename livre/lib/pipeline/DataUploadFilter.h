@@ -38,9 +38,11 @@ public:
      * @param textureCache texture cache
      * @param dataSource data source
      * @param texturePool the pool for 3D textures
+     * @param dataSpillCache optional second level of the data cache
      */
     DataUploadFilter(Cache& dataCache, Cache& textureCache,
-                     DataSource& dataSource, TexturePool& texturePool);
+                     DataSource& dataSource, TexturePool& texturePool,
+                     SpillCache* dataSpillCache = nullptr);
     ~DataUploadFilter();
 
     /**
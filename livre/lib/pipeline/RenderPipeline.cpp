@@ -25,6 +25,7 @@
 #include <livre/lib/pipeline/VisibleSetGeneratorFilter.h>
 
 #include <livre/core/cache/Cache.h>
+#include <livre/core/cache/CacheLease.h>
 #include <livre/core/pipeline/Pipeline.h>
 #include <livre/core/pipeline/SimpleExecutor.h>
 #include <livre/data/DataSource.h>
@@ -51,6 +52,7 @@ struct RenderPipeline::Impl
         , _dataCache(caches.dataCache)
         , _textureCache(caches.textureCache)
         , _histogramCache(caches.histogramCache)
+        , _dataSpillCache(caches.dataSpillCache)
         , _texturePool(texturePool)
         , _renderExecutor("Render", nRenderThreads, glContext)
         , _computeExecutor("Compute", nComputeThreads, glContext)
@@ -77,6 +79,8 @@ struct RenderPipeline::Impl
             .set(renderParams.pixelViewPort);
         visibleSetGenerator.getPromise("ClipPlanes")
             .set(renderParams.clipPlanes);
+        visibleSetGenerator.getPromise("OpacityLUT")
+            .set(renderParams.opacityLUT);
     }
 
     void setupRenderFilter(PipeFilter& renderFilter,
@@ -94,7 +98,7 @@ struct RenderPipeline::Impl
                     NodeAvailability& availability) const
     {
         PipeFilterT<VisibleSetGeneratorFilter> visibleSetGenerator(
-            "VisibleSetGenerator", _dataSource);
+            "VisibleSetGenerator", _dataSource, renderParams.visibleCut);
         setupVisibleGeneratorFilter(visibleSetGenerator, renderParams);
         visibleSetGenerator.execute();
 
@@ -184,8 +188,8 @@ struct RenderPipeline::Impl
                                                renderer);
 
         PipeFilter visibleSetGenerator =
-            renderPipeline.add<VisibleSetGeneratorFilter>("VisibleSetGenerator",
-                                                          _dataSource);
+            renderPipeline.add<VisibleSetGeneratorFilter>(
+                "VisibleSetGenerator", _dataSource, renderParams.visibleCut);
         setupVisibleGeneratorFilter(visibleSetGenerator, renderParams);
 
         PipeFilter renderingSetGenerator =
@@ -204,7 +208,7 @@ struct RenderPipeline::Impl
         PipeFilter uploader =
             uploadPipeline.add<DataUploadFilter>("DataUploader", _dataCache,
                                                  _textureCache, _dataSource,
-                                                 _texturePool);
+                                                 _texturePool, _dataSpillCache);
 
         visibleSetGenerator.connect("VisibleNodes", uploader, "VisibleNodes");
         visibleSetGenerator.connect("Params", uploader, "Params");
@@ -251,18 +255,30 @@ struct RenderPipeline::Impl
         PipeFilter uploader =
             uploadPipeline.add<DataUploadFilter>("DataUploader", _dataCache,
                                                  _textureCache, _dataSource,
-                                                 _texturePool);
+                                                 _texturePool, _dataSpillCache);
 
         uploader.getPromise("VisibleNodes").set(nodeIds);
         uploader.getPromise("Params").set(renderParams.vrParams);
         uploader.connect("CacheObjects", renderFilter, "CacheObjects");
         uploader.connect("CacheObjects", histogramFilter, "CacheObjects");
 
+        // Loading the bricks of the pass must not evict the ones already
+        // loaded for it
+        const CacheLease dataLease(_dataCache, nodeIds);
+        const CacheLease textureLease(_textureCache, nodeIds);
+
         renderPipeline.schedule(_renderExecutor);
         uploadPipeline.schedule(_uploadExecutor);
         sendHistogramFilter.schedule(_computeExecutor);
         histogramFilter.schedule(_computeExecutor);
         renderFilter.execute();
+
+        const size_t nRejected = dataLease.getRejected().size() +
+                                 textureLease.getRejected().size();
+        if (nRejected > 0)
+            LBWARN << nRejected << " bricks of the render pass exceed the "
+                   << "cache memory and are not rendered, increase the "
+                   << "cache sizes" << std::endl;
     }
 
     void render(const RenderParams& renderParams, PipeFilter& redrawFilter,
@@ -281,6 +297,7 @@ struct RenderPipeline::Impl
     Cache& _dataCache;
     Cache& _textureCache;
     Cache& _histogramCache;
+    SpillCache* const _dataSpillCache;
     TexturePool& _texturePool;
     mutable SimpleExecutor _renderExecutor;
     mutable SimpleExecutor _computeExecutor;
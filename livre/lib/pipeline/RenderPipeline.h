@@ -24,6 +24,7 @@
 #include <livre/lib/types.h>
 
 #include <livre/core/render/FrameInfo.h>
+#include <livre/core/render/OpacityLUT.h> // member
 
 namespace livre
 {
@@ -33,6 +34,7 @@ struct Caches
     Cache& dataCache;
     Cache& textureCache;
     Cache& histogramCache;
+    SpillCache* dataSpillCache; //!< optional second level of the data cache
 };
 
 /** Parameters for rendering */
@@ -46,6 +48,8 @@ struct RenderParams
     Viewport viewport;
     ClipPlanes clipPlanes;
     bool idle;
+    OpacityLUT opacityLUT; //!< of the transfer function, for culling
+    VisibleCut* visibleCut; //!< optional, to select the visibles incrementally
 };
 
 /**
@@ -24,6 +24,7 @@
 #include <livre/core/pipeline/InputPort.h>
 #include <livre/core/pipeline/PortData.h>
 #include <livre/core/pipeline/Workers.h>
+#include <livre/core/render/OpacityLUT.h>
 #include <livre/data/DFSTraversal.h>
 #include <livre/data/DataSource.h>
 #include <livre/data/SelectVisibles.h>
@@ -32,8 +33,9 @@ namespace livre
 {
 struct VisibleSetGeneratorFilter::Impl
 {
-    explicit Impl(const DataSource& dataSource)
+    Impl(const DataSource& dataSource, VisibleCut* cut)
         : _dataSource(dataSource)
+        , _cut(cut)
     {
     }
 
@@ -48,18 +50,29 @@ struct VisibleSetGeneratorFilter::Impl
             uniqueInputs.get<VolumeRendererParameters>("Params");
         const auto& vp = uniqueInputs.get<PixelViewport>("Viewport");
         const auto& clipPlanes = uniqueInputs.get<ClipPlanes>("ClipPlanes");
+        const auto& opacityLUT = uniqueInputs.get<OpacityLUT>("OpacityLUT");
 
         const uint32_t windowHeight = vp[3];
         const float sse = params.getScreenSpaceError();
         const uint32_t minLOD = params.getMinLod();
         const uint32_t maxLOD = params.getMaxLod();
 
+        // The subtrees whose values are transparent under the transfer
+        // function are culled
         SelectVisibles visitor(_dataSource, frustum, windowHeight, sse, minLOD,
-                               maxLOD, range, clipPlanes);
-
-        DFSTraversal traverser;
-        traverser.traverse(_dataSource.getVolumeInfo().rootNode, visitor,
-                           frame);
+                               maxLOD, range, clipPlanes,
+                               [&opacityLUT](const Range& values) {
+                                   return opacityLUT.isTransparent(values);
+                               });
+
+        if (_cut)
+            visitor.select(*_cut, frame);
+        else
+        {
+            DFSTraversal traverser;
+            traverser.traverseParallel(_dataSource.getVolumeInfo().rootNode,
+                                       visitor, frame);
+        }
 
         output.set("VisibleNodes", visitor.getVisibles());
         output.set("Params", params);
@@ -72,7 +85,8 @@ struct VisibleSetGeneratorFilter::Impl
                 {"DataRange", getType<Range>()},
                 {"Params", getType<VolumeRendererParameters>()},
                 {"Viewport", getType<PixelViewport>()},
-                {"ClipPlanes", getType<ClipPlanes>()}};
+                {"ClipPlanes", getType<ClipPlanes>()},
+                {"OpacityLUT", getType<OpacityLUT>()}};
     }
 
     DataInfos getOutputDataInfos() const
@@ -82,11 +96,12 @@ struct VisibleSetGeneratorFilter::Impl
     }
 
     const DataSource& _dataSource;
+    VisibleCut* const _cut;
 };
 
 VisibleSetGeneratorFilter::VisibleSetGeneratorFilter(
-    const DataSource& dataSource)
-    : _impl(new VisibleSetGeneratorFilter::Impl(dataSource))
+    const DataSource& dataSource, VisibleCut* cut)
+    : _impl(new VisibleSetGeneratorFilter::Impl(dataSource, cut))
 {
 }
 
@@ -29,7 +29,8 @@ namespace livre
 {
 /**
  * Collects all the visibles for given inputs ( Frustums, Frames, Data Ranges,
- * Rendering params and Viewports )
+ * Rendering params, Viewports, Clip planes and the opacity of the transfer
+ * function )
  */
 class VisibleSetGeneratorFilter : public Filter
 {
@@ -37,8 +38,11 @@ public:
     /**
      * Constructor
      * @param dataSource the data source
+     * @param cut if given, the visibles are selected incrementally from the
+     *        cut of the previous frame, which is updated to this frame
      */
-    explicit VisibleSetGeneratorFilter(const DataSource& dataSource);
+    explicit VisibleSetGeneratorFilter(const DataSource& dataSource,
+                                       VisibleCut* cut = nullptr);
     ~VisibleSetGeneratorFilter();
 
     /**
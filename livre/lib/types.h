@@ -33,6 +33,12 @@ class VolumeRendererParameters;
 
 struct ApplicationParameters;
 
+namespace v1
+{
+class CacheBudgets;
+}
+typedef v1::CacheBudgets CacheBudgets;
+
 typedef std::shared_ptr<const DataObject> ConstDataObjectPtr;
 typedef std::shared_ptr<const TextureObject> ConstTextureObjectPtr;
 typedef std::shared_ptr<const HistogramObject> ConstHistogramObjectPtr;
@@ -39,6 +39,11 @@
 #include <boost/algorithm/string/predicate.hpp>
 #include <lunchbox/pluginRegisterer.h>
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #define MAX_ACCEPTABLE_BLOCK_SIZE 512
 
 extern "C" int LunchboxPluginGetVersion()
@@ -60,6 +65,28 @@ struct DontDeleteObject
 {
     void operator()(const T*) const {}
 };
+
+size_t getPageSize()
+{
+#ifdef _WIN32
+    return 4096;
+#else
+    static const size_t pageSize = ::sysconf(_SC_PAGESIZE);
+    return pageSize;
+#endif
+}
+
+// Asks the kernel to read the pages of a mapped range ahead
+void willNeed(const uint8_t* ptr, const size_t size)
+{
+#ifndef _WIN32
+    if (size == 0)
+        return;
+    const size_t offset = uintptr_t(ptr) % getPageSize();
+    ::posix_madvise(const_cast<uint8_t*>(ptr - offset), size + offset,
+                    POSIX_MADV_WILLNEED);
+#endif
+}
 }
 
 struct UVFDataSource::Impl
@@ -68,15 +95,26 @@ public:
     Impl(VolumeInformation& volumeInfo, const DataSourcePluginData& initData)
         : _uvfTOCBlock(0)
         , _volumeInfo(volumeInfo)
+        , _zeroCopy(false)
     {
+        const servus::URI& uri = initData.getURI();
+        const auto zeroCopy = uri.findQuery("zerocopy");
+        _zeroCopy = zeroCopy != uri.queryEnd() && zeroCopy->second != "0" &&
+                    zeroCopy->second != "false";
+
         try
         {
-            const std::string& path = initData.getURI().getPath();
+            const std::string& path = uri.getPath();
             _uvfDataSetPtr.reset(
                 new tuvok::UVFDataset(path, MAX_ACCEPTABLE_BLOCK_SIZE, false,
                                       false));
-            // For to use with MMap
-            _tuvokLargeMMapFilePtr.reset(new LargeFileMMap(path));
+            // For to use with MMap. The mapping is shared with the zero-copy
+            // bricks, and closed when the last of them is released.
+            _tuvokLargeMMapFilePtr.reset(new LargeFileMMap(path),
+                                         [](LargeFileMMap* mmap) {
+                                             mmap->close();
+                                             delete mmap;
+                                         });
 
             // Determine the depth of the LOD tree structure
             uint32_t depth = 0;
@@ -154,12 +192,6 @@ public:
             LBTHROW(std::runtime_error("UVF TOC block not found in data set"));
     }
 
-    ~Impl()
-    {
-        if (_tuvokLargeMMapFilePtr)
-            _tuvokLargeMMapFilePtr->close();
-    }
-
     void readTOCBlock(const std::string& uri)
     {
         const UVF* uvfFile = _uvfDataSetPtr->GetUVFFile();
@@ -202,7 +234,7 @@ public:
         filePtr->Close();
     }
 
-    MemoryUnitPtr getData(const LODNode& node)
+    uint32_t getBrickIndex(const LODNode& node) const
     {
         const Vector3ui& minPos = node.getAbsolutePosition();
         const UINTVECTOR3& tuvokBricksInThisLod =
@@ -213,43 +245,10 @@ public:
                                         tuvokBricksInThisLod.y,
                                         tuvokBricksInThisLod.z);
 
-        uint32_t brickIndex =
-            getBrickIndex(minPos[0], minPos[1], minPos[2], bricksInThisLod);
-
-        MemoryUnitPtr memUnitPtr;
-        switch (_volumeInfo.dataType)
-        {
-        case DT_FLOAT:
-            memUnitPtr = tuvokBrickToMemoryUnit<float>(node, brickIndex);
-            break;
-        case DT_UINT8:
-            memUnitPtr = tuvokBrickToMemoryUnit<uint8_t>(node, brickIndex);
-            break;
-        case DT_UINT16:
-            memUnitPtr = tuvokBrickToMemoryUnit<uint16_t>(node, brickIndex);
-            break;
-        case DT_UINT32:
-            memUnitPtr = tuvokBrickToMemoryUnit<uint32_t>(node, brickIndex);
-            break;
-        case DT_INT8:
-            memUnitPtr = tuvokBrickToMemoryUnit<int8_t>(node, brickIndex);
-            break;
-        case DT_INT16:
-            memUnitPtr = tuvokBrickToMemoryUnit<int16_t>(node, brickIndex);
-            break;
-        case DT_INT32:
-            memUnitPtr = tuvokBrickToMemoryUnit<int32_t>(node, brickIndex);
-            break;
-        case DT_UNDEFINED:
-            LBERROR << "Undefined data type" << std::endl;
-            break;
-        }
-        return memUnitPtr;
+        return getBrickIndex(minPos[0], minPos[1], minPos[2], bricksInThisLod);
     }
 
-    template <class T>
-    MemoryUnitPtr tuvokBrickToMemoryUnit(const LODNode& node,
-                                         const uint32_t brickIndex) const
+    TOCEntry getBrickInfo(const LODNode& node, const uint32_t brickIndex) const
     {
         const uint32_t frame = node.getNodeId().getTimeStep();
         const tuvok::BrickKey brickKey =
@@ -257,50 +256,120 @@ public:
                             brickIndex);
 
         const UINT64VECTOR4& coords = _uvfDataSetPtr->KeyToTOCVector(brickKey);
-        const TOCEntry& blockInfo = _uvfTOCBlock->GetBrickInfo(coords);
+        return _uvfTOCBlock->GetBrickInfo(coords);
+    }
 
-        if (blockInfo.m_eCompression == CT_NONE)
+    const uint8_t* getMappedBrick(const TOCEntry& blockInfo) const
+    {
+        return static_cast<const uint8_t*>(
+            _tuvokLargeMMapFilePtr
+                ->rd(_offset + blockInfo.m_iOffset, blockInfo.m_iLength)
+                .get());
+    }
+
+    // A brick located by the Tuvok metadata
+    struct Brick
+    {
+        TOCEntry info;
+        const uint8_t* data;
+        size_t size; // uncompressed
+    };
+
+    Brick getBrick(const LODNode& node) const
+    {
+        const TOCEntry info = getBrickInfo(node, getBrickIndex(node));
+        const Vector3ui dimensions =
+            node.getVoxelBox().getSize() + _volumeInfo.overlap * 2;
+        return {info, getMappedBrick(info),
+                dimensions.product() * _volumeInfo.compCount *
+                    _volumeInfo.getBytesPerVoxel()};
+    }
+
+    MemoryUnitPtr getData(const LODNode& node) const
+    {
+        return decode(getBrick(node));
+    }
+
+    // The Tuvok metadata of a batch, looked up serially. The kernel is asked
+    // to read the bricks ahead; a brick whose metadata cannot be found is
+    // reported without data.
+    std::vector<Brick> getBricks(const LODNodes& nodes) const
+    {
+        std::vector<Brick> bricks(nodes.size(), Brick{TOCEntry(), nullptr, 0});
+        for (size_t i = 0; i < nodes.size(); ++i)
         {
-            const std::uint64_t offset = _offset + blockInfo.m_iOffset;
-            const std::uint64_t length = blockInfo.m_iLength;
-            const unsigned char* dataPtr =
-                (const unsigned char*)_tuvokLargeMMapFilePtr->rd(offset, length)
-                    .get();
+            try
+            {
+                bricks[i] = getBrick(nodes[i]);
+                willNeed(bricks[i].data, bricks[i].info.m_iLength);
+            }
+            catch (const std::exception& e)
+            {
+                LBWARN << "Cannot locate node " << nodes[i].getNodeId() << ": "
+                       << e.what() << std::endl;
+            }
+        }
+        return bricks;
+    }
+
+    MemoryUnitPtr getData(const LODNode& node, const Brick& brick) const
+    {
+        if (!brick.data)
+            return MemoryUnitPtr();
+        try
+        {
+            return decode(brick);
+        }
+        catch (const std::exception& e)
+        {
+            LBWARN << "Cannot read node " << node.getNodeId() << ": "
+                   << e.what() << std::endl;
+        }
+        return MemoryUnitPtr();
+    }
+
+    MemoryUnitPtr decode(const Brick& brick) const
+    {
+        if (_volumeInfo.dataType == DT_UNDEFINED)
+        {
+            LBERROR << "Undefined data type" << std::endl;
+            return MemoryUnitPtr();
+        }
+
+        if (brick.info.m_eCompression == CT_NONE)
+        {
+            const std::uint64_t length = brick.info.m_iLength;
 
             // 'touch' aka copy the data first from mmap. Otherwise, the OpenGL
             // texture upload will do that for you which leads to a lock in the
             // driver and causes every other GL call to wait. This basically
             // means that your rendering can't continue and your entire
             // application is blocked.
-            auto memoryUnit = new AllocMemoryUnit(length);
-            memcpy(memoryUnit->getData<uint8_t>(), dataPtr, length);
-            return MemoryUnitPtr{memoryUnit};
-        }
+            if (!_zeroCopy)
+                return MemoryUnitPtr{new PooledMemoryUnit(brick.data, length)};
 
-        const Vector3ui dimensions =
-            node.getVoxelBox().getSize() + _volumeInfo.overlap * 2;
-        const size_t uncompressedSize = dimensions.product() *
-                                        _volumeInfo.compCount *
-                                        _volumeInfo.getBytesPerVoxel();
+            MemoryUnitPtr memoryUnit{new ConstMemoryUnit(
+                brick.data, length, _tuvokLargeMMapFilePtr)};
+            memoryUnit->prefetch();
+            return memoryUnit;
+        }
 
-        std::vector<T> tuvokData;
-        tuvokData.resize(uncompressedSize);
+        // Decompressed straight into the brick
+        MemoryUnitPtr memoryUnit{new PooledMemoryUnit(brick.size)};
+        uint8_t* tuvokData = memoryUnit->getData<uint8_t>();
 
-        if (blockInfo.m_eCompression == CT_ZLIB)
+        if (brick.info.m_eCompression == CT_ZLIB)
         {
-            const void* dataPtr =
-                _tuvokLargeMMapFilePtr
-                    ->rd(_offset + blockInfo.m_iOffset, blockInfo.m_iLength)
-                    .get();
-
-            std::shared_ptr<std::uint8_t> src((std::uint8_t*)dataPtr,
+            std::shared_ptr<std::uint8_t> src(
+                const_cast<uint8_t*>(brick.data),
+                DontDeleteObject<std::uint8_t>());
+            std::shared_ptr<std::uint8_t> dst(tuvokData,
                                               DontDeleteObject<std::uint8_t>());
-            std::shared_ptr<std::uint8_t> dst((std::uint8_t*)&tuvokData[0],
-                                              DontDeleteObject<std::uint8_t>());
-            zDecompress(src, dst, uncompressedSize);
+            zDecompress(src, dst, brick.size);
         }
-
-        return MemoryUnitPtr{new AllocMemoryUnit(tuvokData)};
+        else
+            ::memset(tuvokData, 0, brick.size);
+        return memoryUnit;
     }
 
     LODNode internalNodeToLODNode(const NodeId& internalNode) const
@@ -386,10 +455,11 @@ public:
     typedef std::unique_ptr<tuvok::UVFDataset> UVFDatasetPtr;
     UVFDatasetPtr _uvfDataSetPtr;
 
-    typedef std::unique_ptr<LargeFileMMap> LargeFileMMapPtr;
+    typedef std::shared_ptr<LargeFileMMap> LargeFileMMapPtr;
     LargeFileMMapPtr _tuvokLargeMMapFilePtr;
 
     VolumeInformation& _volumeInfo;
+    bool _zeroCopy;
 };
 
 UVFDataSource::UVFDataSource(const DataSourcePluginData& initData)
@@ -411,7 +481,9 @@ bool UVFDataSource::handles(const DataSourcePluginData& initData)
 
 std::string UVFDataSource::getDescription()
 {
-    return "Tuvok/UVF volume: [uvf://]/path/to/volume.uvf";
+    return R"(Tuvok/UVF volume: [uvf://]/path/to/volume.uvf(?zerocopy=1)
+  with the zerocopy query parameter to reference the uncompressed bricks in
+  the file mapping instead of copying them.)";
 }
 
 MemoryUnitPtr UVFDataSource::getData(const LODNode& node)
@@ -419,6 +491,22 @@ MemoryUnitPtr UVFDataSource::getData(const LODNode& node)
     return _impl->getData(node);
 }
 
+std::future<void> UVFDataSource::getDataAsync(const LODNodes& nodes,
+                                              const DataCallback& callback)
+{
+    // The bricks are located by the calling thread and copied, touched or
+    // decompressed by the reader threads.
+    const auto bricks =
+        std::make_shared<const std::vector<Impl::Brick>>(
+            _impl->getBricks(nodes));
+    const Impl* impl = _impl.get();
+    return runAsync(nodes.size(),
+                    [impl, nodes, bricks, callback](const size_t i) {
+                        callback(nodes[i].getNodeId(),
+                                 impl->getData(nodes[i], (*bricks)[i]));
+                    });
+}
+
 LODNode UVFDataSource::internalNodeToLODNode(const NodeId& internalNode) const
 {
     return _impl->internalNodeToLODNode(internalNode);
@@ -25,7 +25,14 @@
 
 namespace livre
 {
-/** Reads Tuvok Volumes and generates hierarchies. */
+/**
+ * Reads Tuvok Volumes and generates hierarchies.
+ *
+ * The uncompressed bricks are copied out of the file mapping by default. With
+ * the "zerocopy" parameter, they reference the mapping instead, and their
+ * pages are faulted in ahead of the texture upload. Compressed bricks are
+ * decompressed into pooled buffers, in parallel by getDataAsync().
+ */
 class UVFDataSource : public DataSourcePlugin
 {
 public:
@@ -37,6 +44,8 @@ public:
 
 private:
     MemoryUnitPtr getData(const LODNode& node) final;
+    std::future<void> getDataAsync(const LODNodes& nodes,
+                                   const DataCallback& callback) final;
     LODNode internalNodeToLODNode(const NodeId& internalNode) const final;
 
     struct Impl;
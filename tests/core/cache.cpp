@@ -24,7 +24,66 @@
 #include "cache/ValidCacheObject.h"
 
 #include <livre/core/cache/Cache.h>
+#include <livre/core/cache/CacheArbiter.h>
+#include <livre/core/cache/CacheLease.h>
+#include <livre/core/cache/CachePolicy.h>
+#include <livre/core/cache/CachePrefetcher.h>
 #include <livre/core/cache/CacheStatistics.h>
+#include <livre/data/NodeId.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <atomic>
+
+namespace
+{
+std::atomic<size_t> nConstructed(0);
+
+class SlowCacheObject : public livre::CacheObject
+{
+public:
+    explicit SlowCacheObject(const livre::CacheId& cacheId)
+        : livre::CacheObject(cacheId)
+    {
+        ++nConstructed;
+        boost::this_thread::sleep(boost::posix_time::milliseconds(200));
+    }
+
+    size_t getSize() const final { return test::OBJECT_SIZE; }
+};
+
+class CompressedCacheObject : public livre::CacheObject
+{
+public:
+    explicit CompressedCacheObject(const livre::CacheId& cacheId)
+        : livre::CacheObject(cacheId)
+    {
+    }
+
+    size_t getSize() const final { return test::OBJECT_SIZE / 4; }
+    size_t getUncompressedSize() const final { return test::OBJECT_SIZE; }
+};
+
+std::atomic<size_t> nEvicted(0);
+
+// Spills all objects but the first one
+class SpilledCacheObject : public livre::CacheObject
+{
+public:
+    explicit SpilledCacheObject(const livre::CacheId& cacheId)
+        : livre::CacheObject(cacheId)
+    {
+    }
+
+    size_t getSize() const final { return test::OBJECT_SIZE; }
+    void evicted(livre::CacheStatistics& statistics) const final
+    {
+        ++nEvicted;
+        statistics.notifySpill(getId() != 1);
+    }
+};
+}
 
 BOOST_AUTO_TEST_CASE(testCache)
 {
@@ -76,3 +135,480 @@ BOOST_AUTO_TEST_CASE(testCache)
     BOOST_CHECK_EQUAL(cache.getCount(), 0);
     BOOST_CHECK_EQUAL(cache.getStatistics().getUsedMemory(), 0);
 }
+
+BOOST_AUTO_TEST_CASE(testCacheLRU)
+{
+    // Room for three objects, the fourth one triggers the eviction
+    livre::CacheT<test::ValidCacheObject> cache("Test Cache",
+                                                3 * test::OBJECT_SIZE + 1);
+
+    cache.load<test::ValidCacheObject>(1);
+    cache.load<test::ValidCacheObject>(2);
+    cache.load<test::ValidCacheObject>(3);
+    BOOST_CHECK_EQUAL(cache.getCount(), 3);
+
+    // A hit makes 1 the most recently used, so 2 is evicted instead
+    BOOST_CHECK(cache.get(1));
+    cache.load<test::ValidCacheObject>(4);
+    BOOST_CHECK_EQUAL(cache.getCount(), 3);
+    BOOST_CHECK(cache.get(1));
+    BOOST_CHECK(!cache.get(2));
+    BOOST_CHECK(cache.get(3));
+    BOOST_CHECK(cache.get(4));
+
+    // Referenced objects are skipped
+    livre::ConstCacheObjectPtr held = cache.get(3);
+    cache.get(1);
+    cache.get(4);
+    cache.load<test::ValidCacheObject>(5);
+    BOOST_CHECK(cache.get(3));
+    BOOST_CHECK(!cache.get(1));
+    BOOST_CHECK_EQUAL(cache.getCount(), 3);
+
+    cache.purge(3);
+    BOOST_CHECK_EQUAL(cache.getCount(), 2);
+    BOOST_CHECK_EQUAL(cache.getStatistics().getUsedMemory(),
+                      2 * test::OBJECT_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(testCacheARC)
+{
+    livre::CacheT<test::ValidCacheObject> cache("Test Cache",
+                                                4 * test::OBJECT_SIZE + 1,
+                                                livre::CP_ARC);
+
+    // 1 and 2 are used repeatedly
+    cache.load<test::ValidCacheObject>(1);
+    cache.load<test::ValidCacheObject>(2);
+    BOOST_CHECK(cache.get(1));
+    BOOST_CHECK(cache.get(2));
+
+    // A scan over objects used only once does not flush them
+    for (livre::CacheId id = 3; id < 13; ++id)
+        cache.load<test::ValidCacheObject>(id);
+
+    BOOST_CHECK_EQUAL(cache.getCount(), 4);
+    BOOST_CHECK(cache.get(1));
+    BOOST_CHECK(cache.get(2));
+    BOOST_CHECK(cache.get(12));
+    BOOST_CHECK(!cache.get(3));
+}
+
+BOOST_AUTO_TEST_CASE(testCacheCost)
+{
+    livre::CacheT<test::ValidCacheObject> cache("Test Cache",
+                                                3 * test::OBJECT_SIZE + 1,
+                                                livre::CP_COST);
+
+    const livre::NodeId root(0, livre::Vector3ui(0));
+    cache.load<test::ValidCacheObject>(root.getId());
+    for (uint32_t i = 0; i < 3; ++i)
+        cache.load<test::ValidCacheObject>(
+            livre::NodeId(3, livre::Vector3ui(i, 0, 0)).getId());
+
+    // The coarse node is cheaper to keep than a leaf of the same size
+    BOOST_CHECK_EQUAL(cache.getCount(), 3);
+    BOOST_CHECK(cache.get(root.getId()));
+}
+
+BOOST_AUTO_TEST_CASE(testCacheCostRemoval)
+{
+    const livre::CachePolicyPtr policy =
+        livre::CachePolicy::create(livre::CP_COST, 3 * test::OBJECT_SIZE);
+    const test::ValidCacheObject root(
+        livre::NodeId(0, livre::Vector3ui(0)).getId());
+    const test::ValidCacheObject slow(
+        livre::NodeId(3, livre::Vector3ui(0)).getId());
+    const test::ValidCacheObject fast(
+        livre::NodeId(3, livre::Vector3ui(1, 0, 0)).getId());
+
+    // Removing an object does not age the others, evicting it does
+    policy->insert(root, 100.f);
+    policy->insert(slow, 2.f);
+    policy->remove(root.getId());
+    policy->insert(fast, 1.f);
+    BOOST_CHECK_EQUAL(policy->getFirst(), fast.getId());
+
+    policy->remove(fast.getId());
+    policy->insert(root, 100.f);
+    policy->evict(root.getId());
+    policy->insert(fast, 1.f);
+    BOOST_CHECK_EQUAL(policy->getFirst(), slow.getId());
+}
+
+BOOST_AUTO_TEST_CASE(testCacheOctree)
+{
+    livre::CacheT<test::ValidCacheObject> cache("Test Cache",
+                                                3 * test::OBJECT_SIZE + 1,
+                                                livre::CP_OCTREE);
+
+    const livre::NodeId root(0, livre::Vector3ui(0));
+    const livre::NodeId child(1, livre::Vector3ui(0));
+    const livre::NodeId leaf1(2, livre::Vector3ui(0));
+    const livre::NodeId leaf2(2, livre::Vector3ui(1, 0, 0));
+    const livre::NodeId leaf3(2, livre::Vector3ui(0, 1, 0));
+
+    cache.load<test::ValidCacheObject>(leaf1.getId());
+    cache.load<test::ValidCacheObject>(child.getId());
+    cache.load<test::ValidCacheObject>(root.getId());
+
+    // The parents are older than the leaf but stay as long as it is cached
+    cache.load<test::ValidCacheObject>(leaf2.getId());
+    BOOST_CHECK_EQUAL(cache.getCount(), 3);
+    BOOST_CHECK(!cache.get(leaf1.getId()));
+    BOOST_CHECK(cache.get(child.getId()));
+    BOOST_CHECK(cache.get(root.getId()));
+
+    cache.load<test::ValidCacheObject>(leaf3.getId());
+    BOOST_CHECK(!cache.get(leaf2.getId()));
+    BOOST_CHECK(cache.get(child.getId()));
+    BOOST_CHECK(cache.get(root.getId()));
+
+    // Once the last descendant is gone, the parent is a leaf again
+    BOOST_CHECK(cache.unload(leaf3.getId()));
+    cache.load<test::ValidCacheObject>(
+        livre::NodeId(1, livre::Vector3ui(1, 0, 0)).getId());
+    cache.load<test::ValidCacheObject>(
+        livre::NodeId(1, livre::Vector3ui(0, 1, 0)).getId());
+    BOOST_CHECK_EQUAL(cache.getCount(), 3);
+    BOOST_CHECK(!cache.get(child.getId()));
+    BOOST_CHECK(cache.get(root.getId()));
+}
+
+BOOST_AUTO_TEST_CASE(testCachePolicyNames)
+{
+    BOOST_CHECK_EQUAL(livre::getCachePolicyType("lru"), livre::CP_LRU);
+    BOOST_CHECK_EQUAL(livre::getCachePolicyType("arc"), livre::CP_ARC);
+    BOOST_CHECK_EQUAL(livre::getCachePolicyType("cost"), livre::CP_COST);
+    BOOST_CHECK_EQUAL(livre::getCachePolicyType("octree"), livre::CP_OCTREE);
+    BOOST_CHECK_EQUAL(livre::getCachePolicyName(livre::CP_ARC), "arc");
+    BOOST_CHECK_THROW(livre::getCachePolicyType("mru"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(testCacheSingleFlight)
+{
+    livre::CacheT<SlowCacheObject> cache("Test Cache", 4 * test::OBJECT_SIZE);
+
+    const size_t nThreads = 4;
+    boost::thread_group threads;
+    for (size_t i = 0; i < nThreads; ++i)
+        threads.create_thread([&cache] {
+            BOOST_CHECK(cache.load<SlowCacheObject>(1));
+        });
+    threads.join_all();
+
+    BOOST_CHECK_EQUAL(nConstructed, 1);
+    BOOST_CHECK_EQUAL(cache.getCount(), 1);
+    BOOST_CHECK_EQUAL(cache.getStatistics().getSavedLoads(), nThreads - 1);
+}
+
+BOOST_AUTO_TEST_CASE(testCacheLoadLatency)
+{
+    // The load time covers the construction of the object
+    livre::CacheT<SlowCacheObject> cache("Test Cache", 4 * test::OBJECT_SIZE);
+    BOOST_CHECK(cache.load<SlowCacheObject>(1));
+
+    const livre::CacheStatisticsSnapshot snapshot =
+        cache.getStatistics().getSnapshot();
+    BOOST_CHECK_EQUAL(snapshot.getLoadCount(), 1);
+    BOOST_CHECK_GE(snapshot.getLoadLatency(1.f), 200.f);
+    BOOST_CHECK_LT(snapshot.getLoadLatency(1.f), 400.f);
+    BOOST_CHECK_GT(snapshot.getLoadTime(), 150.f);
+}
+
+BOOST_AUTO_TEST_CASE(testCacheConcurrentAccess)
+{
+    // Lookups run without locks while other threads load and evict objects
+    const size_t maxObjects = 16;
+    livre::CacheT<test::ValidCacheObject> cache("Concurrent Cache",
+                                                maxObjects * test::OBJECT_SIZE +
+                                                    1);
+    std::atomic<size_t> nFound(0);
+    boost::thread_group threads;
+    for (size_t i = 0; i < 4; ++i)
+        threads.create_thread([&cache, &nFound, i] {
+            for (size_t j = 0; j < 10000; ++j)
+            {
+                const livre::CacheId cacheId = (j * 7 + i) % 64;
+                if (j % 4 == 0)
+                    cache.load<test::ValidCacheObject>(cacheId);
+                else if (cache.get(cacheId))
+                    ++nFound;
+            }
+        });
+    threads.join_all();
+
+    BOOST_CHECK(nFound > 0);
+    BOOST_CHECK(cache.getCount() <= maxObjects);
+    BOOST_CHECK_EQUAL(cache.getStatistics().getBlockCount(), cache.getCount());
+}
+
+BOOST_AUTO_TEST_CASE(testCacheStatistics)
+{
+    livre::CacheT<test::ValidCacheObject> cache("Test Cache",
+                                                2 * test::OBJECT_SIZE + 1);
+    const livre::CacheStatistics& statistics = cache.getStatistics();
+    const livre::CacheStatisticsSnapshot start = statistics.getSnapshot();
+
+    cache.load<test::ValidCacheObject>(1);
+    cache.load<test::ValidCacheObject>(2);
+    BOOST_CHECK(cache.get(1));
+    BOOST_CHECK(cache.get(2));
+    BOOST_CHECK(!cache.get(3));
+
+    // 1 is the least recently used but referenced, the policy has to skip it
+    livre::ConstCacheObjectPtr held = cache.get(1);
+    BOOST_CHECK(cache.get(2));
+    cache.load<test::ValidCacheObject>(3);
+    BOOST_CHECK_EQUAL(statistics.getEvictions(), 1);
+    BOOST_CHECK_EQUAL(statistics.getRejectedEvictions(), 1);
+
+    const livre::CacheStatisticsSnapshot end = statistics.getSnapshot();
+    const livre::CacheStatisticsSnapshot diff = end - start;
+    BOOST_CHECK_EQUAL(diff.hits, 4);
+    BOOST_CHECK_EQUAL(diff.misses, 4);
+    BOOST_CHECK_EQUAL(diff.hitBytes, 4 * test::OBJECT_SIZE);
+    BOOST_CHECK_EQUAL(diff.loadedBytes, 3 * test::OBJECT_SIZE);
+    BOOST_CHECK_CLOSE(diff.getByteHitRatio(), 4.f / 7.f, 0.001f);
+    BOOST_CHECK_EQUAL(diff.getLoadCount(), 3);
+    BOOST_CHECK_EQUAL(diff.blockCount, 2);
+    BOOST_CHECK(diff.time >= 0.f);
+
+    // A later diff only contains the new activity
+    BOOST_CHECK(cache.get(3));
+    const livre::CacheStatisticsSnapshot next =
+        statistics.getSnapshot() - end;
+    BOOST_CHECK_EQUAL(next.hits, 1);
+    BOOST_CHECK_EQUAL(next.misses, 0);
+    BOOST_CHECK_EQUAL(next.getHitRatio(), 1.f);
+    BOOST_CHECK_EQUAL(next.getLoadCount(), 0);
+    BOOST_CHECK_EQUAL(next.getLoadLatency(0.99f), 0.f);
+}
+
+BOOST_AUTO_TEST_CASE(testCacheEvicted)
+{
+    livre::CacheT<SpilledCacheObject> cache("Test Cache",
+                                            2 * test::OBJECT_SIZE + 1);
+    for (livre::CacheId cacheId = 1; cacheId <= 4; ++cacheId)
+        cache.load<SpilledCacheObject>(cacheId);
+    BOOST_CHECK_EQUAL(nEvicted, 2);
+
+    const livre::CacheStatisticsSnapshot snapshot =
+        cache.getStatistics().getSnapshot();
+    BOOST_CHECK_EQUAL(snapshot.spills, 2);
+    BOOST_CHECK_EQUAL(snapshot.droppedSpills, 1);
+
+    // Only the objects evicted by the policy are handed over
+    BOOST_CHECK(cache.unload(4));
+    cache.purge();
+    BOOST_CHECK_EQUAL(nEvicted, 2);
+}
+
+BOOST_AUTO_TEST_CASE(testCacheCompressionStatistics)
+{
+    livre::CacheT<CompressedCacheObject> cache("Test Cache",
+                                               test::OBJECT_SIZE + 1);
+    const livre::CacheStatistics& statistics = cache.getStatistics();
+    BOOST_CHECK_EQUAL(statistics.getSnapshot().getCompressionRatio(), 1.f);
+    BOOST_CHECK_EQUAL(statistics.getSnapshot().getDecompressionThroughput(),
+                      0.f);
+
+    // Compression fits four objects in the size of one
+    for (livre::CacheId cacheId = 1; cacheId <= 4; ++cacheId)
+        BOOST_CHECK(cache.load<CompressedCacheObject>(cacheId));
+    BOOST_CHECK_EQUAL(cache.getCount(), 4);
+
+    statistics.notifyDecompressed(LB_1MB, 2.f);
+    const livre::CacheStatisticsSnapshot snapshot = statistics.getSnapshot();
+    BOOST_CHECK_EQUAL(snapshot.uncompressedMemBytes, 4 * test::OBJECT_SIZE);
+    BOOST_CHECK_CLOSE(snapshot.getCompressionRatio(), 4.f, 0.001f);
+    BOOST_CHECK_CLOSE(snapshot.getDecompressionThroughput(), 500.f, 0.1f);
+
+    BOOST_CHECK(cache.unload(1));
+    BOOST_CHECK_EQUAL(statistics.getSnapshot().uncompressedMemBytes,
+                      3 * test::OBJECT_SIZE);
+}
+
+BOOST_AUTO_TEST_CASE(testCacheLatencyHistogram)
+{
+    typedef livre::CacheStatisticsSnapshot Snapshot;
+    BOOST_CHECK_EQUAL(Snapshot::getLatencyBucket(0.f), 0);
+    BOOST_CHECK_EQUAL(Snapshot::getLatencyBucket(0.0005f), 0);
+    BOOST_CHECK_EQUAL(Snapshot::getLatencyBucket(1e9f),
+                      Snapshot::nLatencyBuckets - 1);
+
+    // Every time is below the limit of its bucket and above the previous one
+    for (const float time : {0.001f, 0.0031f, 0.25f, 1.f, 17.f, 1234.5f})
+    {
+        const size_t bucket = Snapshot::getLatencyBucket(time);
+        BOOST_CHECK_GT(bucket, 0);
+        BOOST_CHECK_LT(time, Snapshot::getLatencyBucketLimit(bucket));
+        BOOST_CHECK_GE(time * 1.0001f,
+                       Snapshot::getLatencyBucketLimit(bucket - 1));
+        BOOST_CHECK_LE(Snapshot::getLatencyBucketLimit(bucket),
+                       1.25f * Snapshot::getLatencyBucketLimit(bucket - 1));
+    }
+
+    Snapshot snapshot;
+    snapshot.loadLatencies[Snapshot::getLatencyBucket(1.f)] = 99;
+    snapshot.loadLatencies[Snapshot::getLatencyBucket(100.f)] = 1;
+    BOOST_CHECK_EQUAL(snapshot.getLoadCount(), 100);
+    BOOST_CHECK_LT(snapshot.getLoadLatency(0.5f), 1.25f);
+    BOOST_CHECK_LT(snapshot.getLoadLatency(0.99f), 1.25f);
+    BOOST_CHECK_GT(snapshot.getLoadLatency(1.f), 100.f);
+}
+
+BOOST_AUTO_TEST_CASE(testCacheLease)
+{
+    livre::CacheT<test::ValidCacheObject> cache("Test Cache",
+                                                3 * test::OBJECT_SIZE + 1);
+    {
+        // Pinned objects survive loading the rest of the working set
+        const livre::CacheLease lease(cache, livre::CacheIds{1, 2});
+        cache.load<test::ValidCacheObject>(1);
+        cache.load<test::ValidCacheObject>(2);
+        for (livre::CacheId cacheId = 3; cacheId < 10; ++cacheId)
+            BOOST_CHECK(cache.load<test::ValidCacheObject>(cacheId));
+        BOOST_CHECK(cache.get(1));
+        BOOST_CHECK(cache.get(2));
+        BOOST_CHECK(!cache.unload(1));
+        BOOST_CHECK(lease.getRejected().empty());
+        BOOST_CHECK_EQUAL(cache.getCount(), 3);
+    }
+    BOOST_CHECK(cache.unload(1));
+
+    {
+        // The pinned set exceeds the cache, the exceeding objects are rejected
+        const livre::CacheLease lease(cache, livre::CacheIds{10, 11, 12, 13});
+        const livre::CacheLease overlap(cache, livre::CacheIds{13});
+        for (livre::CacheId cacheId = 10; cacheId < 13; ++cacheId)
+            BOOST_CHECK(cache.load<test::ValidCacheObject>(cacheId));
+        BOOST_CHECK(!cache.load<test::ValidCacheObject>(13));
+        BOOST_CHECK_EQUAL(cache.getCount(), 3);
+        BOOST_CHECK(lease.getRejected() == livre::CacheIds{13});
+        BOOST_CHECK(overlap.getRejected() == livre::CacheIds{13});
+        BOOST_CHECK_EQUAL(cache.getStatistics().getRejectedPins(), 1);
+    }
+
+    // Released objects can be evicted again
+    BOOST_CHECK(cache.load<test::ValidCacheObject>(13));
+    BOOST_CHECK_EQUAL(cache.getCount(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(testCacheIds)
+{
+    livre::CacheT<test::ValidCacheObject> cache("Test Cache",
+                                                3 * test::OBJECT_SIZE + 1);
+    for (livre::CacheId cacheId = 1; cacheId <= 3; ++cacheId)
+        cache.load<test::ValidCacheObject>(cacheId);
+    BOOST_CHECK(cache.get(1));
+
+    // Most recently used first
+    BOOST_CHECK(cache.getCacheIds() == (livre::CacheIds{1, 3, 2}));
+}
+
+BOOST_AUTO_TEST_CASE(testCacheManifest)
+{
+    const boost::filesystem::path filename =
+        boost::filesystem::temp_directory_path() /
+        boost::filesystem::unique_path();
+    livre::CacheT<test::ValidCacheObject> cache("Test Cache",
+                                                4 * test::OBJECT_SIZE + 1);
+    for (livre::CacheId cacheId = 1; cacheId <= 3; ++cacheId)
+        cache.load<test::ValidCacheObject>(cacheId);
+
+    BOOST_CHECK(livre::loadCacheManifest(filename.string(), "vol").empty());
+    livre::saveCacheManifest(cache, filename.string(), "vol");
+    const livre::CacheIds cacheIds =
+        livre::loadCacheManifest(filename.string(), "vol");
+    BOOST_CHECK(cacheIds == (livre::CacheIds{3, 2, 1}));
+    BOOST_CHECK(livre::loadCacheManifest(filename.string(), "other").empty());
+    boost::filesystem::remove(filename);
+
+    // Prefetching stops before the cache is full
+    livre::CacheT<test::ValidCacheObject> warmCache("Warm Cache",
+                                                    2 * test::OBJECT_SIZE + 1);
+    livre::CachePrefetcher prefetcher(warmCache, cacheIds,
+                                      [&](const livre::CacheId& cacheId) {
+                                          return warmCache.load<
+                                              test::ValidCacheObject>(cacheId);
+                                      },
+                                      1);
+    prefetcher.wait();
+    BOOST_CHECK_EQUAL(prefetcher.getLoadedCount(), 2);
+    BOOST_CHECK(warmCache.getCacheIds() == (livre::CacheIds{2, 3}));
+    BOOST_CHECK_EQUAL(warmCache.getStatistics().getEvictions(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(testCacheArbiter)
+{
+    typedef livre::CacheT<test::ValidCacheObject> TestCache;
+    TestCache busyCache("Busy Cache", 4 * test::OBJECT_SIZE + 1);
+    TestCache idleCache("Idle Cache", 4 * test::OBJECT_SIZE + 1);
+    livre::CacheArbiter arbiter(0.25f);
+    arbiter.add(busyCache, test::OBJECT_SIZE);
+    arbiter.add(idleCache, test::OBJECT_SIZE);
+    BOOST_CHECK_EQUAL(arbiter.getMaximumMemory(), 8 * test::OBJECT_SIZE + 2);
+    BOOST_CHECK(!arbiter.rebalance());
+
+    // The busy cache evicts, the idle cache gives up its unused memory
+    for (livre::CacheId cacheId = 1; cacheId <= 8; ++cacheId)
+        busyCache.load<test::ValidCacheObject>(cacheId);
+    BOOST_CHECK(arbiter.rebalance());
+    livre::CacheArbiter::Budgets budgets = arbiter.getBudgets();
+    BOOST_REQUIRE_EQUAL(budgets.size(), 2);
+    BOOST_CHECK_EQUAL(budgets[0].name, "Busy Cache");
+    BOOST_CHECK_EQUAL(budgets[0].maxMemBytes, 6 * test::OBJECT_SIZE + 1);
+    BOOST_CHECK_EQUAL(budgets[1].maxMemBytes, 2 * test::OBJECT_SIZE + 1);
+    BOOST_CHECK_GT(budgets[0].loadTime, 0.f);
+
+    // Without new misses the budgets are stable
+    BOOST_CHECK(!arbiter.rebalance());
+
+    // The minimum of the idle cache is kept
+    for (livre::CacheId cacheId = 9; cacheId <= 16; ++cacheId)
+        busyCache.load<test::ValidCacheObject>(cacheId);
+    BOOST_CHECK(arbiter.rebalance());
+    budgets = arbiter.getBudgets();
+    BOOST_CHECK_EQUAL(budgets[0].maxMemBytes, 7 * test::OBJECT_SIZE + 2);
+    BOOST_CHECK_EQUAL(budgets[1].maxMemBytes, test::OBJECT_SIZE);
+    BOOST_CHECK_EQUAL(budgets[0].maxMemBytes + budgets[1].maxMemBytes,
+                      arbiter.getMaximumMemory());
+
+    // A smaller budget evicts
+    busyCache.setMaximumMemory(2 * test::OBJECT_SIZE + 1);
+    BOOST_CHECK_EQUAL(busyCache.getCount(), 2);
+    BOOST_CHECK_EQUAL(busyCache.getStatistics().getMaximumMemory(),
+                      2 * test::OBJECT_SIZE + 1);
+}
+
+BOOST_AUTO_TEST_CASE(testCacheArbiterMaximumMemory)
+{
+    typedef livre::CacheT<test::ValidCacheObject> TestCache;
+    TestCache bigCache("Big Cache", 6 * test::OBJECT_SIZE);
+    TestCache smallCache("Small Cache", 2 * test::OBJECT_SIZE);
+    livre::CacheArbiter arbiter;
+    arbiter.add(bigCache, 2 * test::OBJECT_SIZE);
+    arbiter.add(smallCache, test::OBJECT_SIZE);
+    for (livre::CacheId cacheId = 1; cacheId <= 5; ++cacheId)
+        bigCache.load<test::ValidCacheObject>(cacheId);
+
+    // The shares scale with the total budget, the shrinking evicts
+    arbiter.setMaximumMemory(4 * test::OBJECT_SIZE);
+    BOOST_CHECK_EQUAL(arbiter.getMaximumMemory(), 4 * test::OBJECT_SIZE);
+    livre::CacheArbiter::Budgets budgets = arbiter.getBudgets();
+    BOOST_CHECK_EQUAL(budgets[0].maxMemBytes, 3 * test::OBJECT_SIZE);
+    BOOST_CHECK_EQUAL(budgets[1].maxMemBytes, test::OBJECT_SIZE);
+    BOOST_CHECK_LT(bigCache.getCount(), 5);
+    BOOST_CHECK_LE(bigCache.getStatistics().getUsedMemory(),
+                   3 * test::OBJECT_SIZE);
+
+    // The evictions of the shrinking are no pressure
+    BOOST_CHECK(!arbiter.rebalance());
+
+    arbiter.setMaximumMemory(8 * test::OBJECT_SIZE + 1);
+    budgets = arbiter.getBudgets();
+    BOOST_CHECK_EQUAL(budgets[0].maxMemBytes + budgets[1].maxMemBytes,
+                      8 * test::OBJECT_SIZE + 1);
+    BOOST_CHECK_GE(budgets[0].maxMemBytes, 6 * test::OBJECT_SIZE);
+}
@@ -0,0 +1,130 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE MemoryPressureMonitor
+
+#include <livre/core/util/MemoryPressureMonitor.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <fstream>
+
+namespace
+{
+const size_t MB = 1024 * 1024;
+
+// A fake cgroup v2 directory with the files read by the monitor
+class FakeCgroup
+{
+public:
+    FakeCgroup()
+        : directory(boost::filesystem::temp_directory_path() /
+                    boost::filesystem::unique_path())
+    {
+        boost::filesystem::create_directories(directory);
+        write("memory.stat", "anon 0\ninactive_file 0\nactive_file 0\n");
+    }
+
+    ~FakeCgroup() { boost::filesystem::remove_all(directory); }
+    void write(const std::string& file, const std::string& content) const
+    {
+        std::ofstream((directory / file).string()) << content;
+    }
+
+    void setUsage(const std::string& maxBytes, const size_t currentBytes,
+                  const float pressure) const
+    {
+        write("memory.max", maxBytes + "\n");
+        write("memory.current", std::to_string(currentBytes) + "\n");
+        write("memory.pressure", "some avg10=" + std::to_string(pressure) +
+                                     " avg60=0.00 avg300=0.00 total=0\n"
+                                     "full avg10=0.00 avg60=0.00 avg300=0.00 "
+                                     "total=0\n");
+    }
+
+    const boost::filesystem::path directory;
+};
+}
+
+BOOST_AUTO_TEST_CASE(testSample)
+{
+    const FakeCgroup cgroup;
+    cgroup.setUsage("max", 100 * MB, 2.5f);
+    cgroup.write("memory.stat", "anon 0\ninactive_file 20971520\n");
+
+    const livre::MemoryPressureMonitor monitor(cgroup.directory.string());
+    BOOST_CHECK_EQUAL(monitor.getCgroupDirectory(), cgroup.directory.string());
+    livre::MemoryPressureMonitor::Sample sample = monitor.sample();
+    BOOST_CHECK_EQUAL(sample.maxBytes, 0);
+    BOOST_CHECK_EQUAL(sample.currentBytes, 80 * MB);
+    BOOST_CHECK_CLOSE(sample.pressure, 2.5f, 0.01f);
+
+    cgroup.setUsage(std::to_string(1024 * MB), 100 * MB, 0.f);
+    sample = monitor.sample();
+    BOOST_CHECK_EQUAL(sample.maxBytes, 1024 * MB);
+    BOOST_CHECK_EQUAL(sample.pressure, 0.f);
+}
+
+BOOST_AUTO_TEST_CASE(testBudget)
+{
+    const FakeCgroup cgroup;
+    const livre::MemoryPressureMonitor monitor(cgroup.directory.string());
+    const std::string limit = std::to_string(1000 * MB);
+
+    // Room without pressure grows the budget up to the maximum
+    cgroup.setUsage(limit, 500 * MB, 0.f);
+    BOOST_CHECK_EQUAL(monitor.getBudget(400 * MB, 100 * MB, 800 * MB),
+                      480 * MB);
+    BOOST_CHECK_EQUAL(monitor.getBudget(780 * MB, 100 * MB, 800 * MB),
+                      800 * MB);
+
+    // Between the marks the budget stays
+    cgroup.setUsage(limit, 850 * MB, 0.f);
+    BOOST_CHECK_EQUAL(monitor.getBudget(400 * MB, 100 * MB, 800 * MB),
+                      400 * MB);
+
+    // Close to the limit the budget shrinks by the overshoot
+    cgroup.setUsage(limit, 950 * MB, 0.f);
+    BOOST_CHECK_EQUAL(monitor.getBudget(400 * MB, 100 * MB, 800 * MB),
+                      350 * MB);
+    BOOST_CHECK_EQUAL(monitor.getBudget(120 * MB, 100 * MB, 800 * MB),
+                      100 * MB);
+
+    // Pressure shrinks the budget even without a limit
+    cgroup.setUsage("max", 500 * MB, 25.f);
+    BOOST_CHECK_EQUAL(monitor.getBudget(400 * MB, 100 * MB, 800 * MB),
+                      320 * MB);
+
+    // Some pressure keeps the budget
+    cgroup.setUsage("max", 500 * MB, 5.f);
+    BOOST_CHECK_EQUAL(monitor.getBudget(400 * MB, 100 * MB, 800 * MB),
+                      400 * MB);
+
+    livre::MemoryPressureMonitor::releaseFreeMemory();
+}
+
+BOOST_AUTO_TEST_CASE(testMissingCgroup)
+{
+    // A directory without files is an unlimited cgroup without pressure
+    const livre::MemoryPressureMonitor monitor("/nonexistent/livre/cgroup");
+    const livre::MemoryPressureMonitor::Sample sample = monitor.sample();
+    BOOST_CHECK_EQUAL(sample.maxBytes, 0);
+    BOOST_CHECK_EQUAL(sample.currentBytes, 0);
+}
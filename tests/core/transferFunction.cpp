@@ -19,6 +19,7 @@
 
 #define BOOST_TEST_MODULE TransferFunction1D
 
+#include <livre/core/render/OpacityLUT.h>
 #include <livre/core/render/TransferFunction1D.h>
 
 #include <boost/numeric/conversion/cast.hpp>
@@ -70,3 +71,25 @@ BOOST_AUTO_TEST_CASE(loadWrongTransferFunctionFile)
     BOOST_CHECK_EQUAL_COLLECTIONS(defaultLUT.begin(), defaultLUT.end(),
                                   tfLUT.begin(), tfLUT.end());
 }
+
+BOOST_AUTO_TEST_CASE(opacityLUT)
+{
+    // Without a transfer function, no value is transparent
+    BOOST_CHECK(!livre::OpacityLUT().isTransparent({{0.f, 0.f}}));
+
+    const livre::OpacityLUT defaultLUT(livre::TransferFunction1D(),
+                                       livre::DT_UINT8);
+    BOOST_CHECK(defaultLUT.isTransparent({{0.f, 0.f}}));
+    BOOST_CHECK(!defaultLUT.isTransparent({{100.f, 200.f}}));
+
+    // Only a band of values is opaque
+    livre::TransferFunction1D transferFunction;
+    for (size_t i = 0; i < transferFunction.getAlpha().size(); ++i)
+        transferFunction.getAlpha()[i] = i >= 100 && i <= 110 ? 1.f : 0.f;
+    const livre::OpacityLUT bandLUT(transferFunction, livre::DT_UINT8);
+    BOOST_CHECK(bandLUT.isTransparent({{0.f, 50.f}}));
+    BOOST_CHECK(bandLUT.isTransparent({{200.f, 255.f}}));
+    BOOST_CHECK(!bandLUT.isTransparent({{90.f, 120.f}}));
+    BOOST_CHECK(!bandLUT.isTransparent({{0.f, 255.f}}));
+    BOOST_CHECK(!bandLUT.isTransparent({{105.f, 105.f}}));
+}
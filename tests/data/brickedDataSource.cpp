@@ -0,0 +1,294 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE BrickedDataSource
+#include <boost/test/unit_test.hpp>
+
+#include <livre/data/BrickedDataSource.h>
+#include <livre/data/DataSource.h>
+#include <livre/data/MemoryDataSource.h>
+#include <livre/data/MemoryUnit.h>
+#include <livre/data/ValueRange.h>
+
+#include <lunchbox/pluginRegisterer.h>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+// Explicit registration required because the folder of the data source plugin
+// is not in the LD_LIBRARY_PATH of the test executable.
+lunchbox::PluginRegisterer<livre::MemoryDataSource> memoryRegisterer;
+lunchbox::PluginRegisterer<livre::BrickedDataSource> brickedRegisterer;
+
+namespace
+{
+namespace fs = boost::filesystem;
+typedef std::map<livre::NodeId, livre::ConstMemoryUnitPtr> Bricks;
+
+struct TemporaryFile
+{
+    TemporaryFile()
+        : path(fs::temp_directory_path() /
+               fs::unique_path("livre-%%%%-%%%%.lvb"))
+    {
+    }
+    ~TemporaryFile() { fs::remove(path); }
+    std::string getURI(const std::string& query = std::string()) const
+    {
+        return "lvb://" + path.string() + query;
+    }
+    const fs::path path;
+};
+
+// Writes all bricks of two frames of the input to the output
+Bricks convert(const livre::DataSource& input, livre::DataSource& output)
+{
+    livre::VolumeInformation info = input.getVolumeInfo();
+    info.frameRange = livre::Vector2ui(0, 2);
+    info.description = "converted";
+    output.setVolumeInfo(info);
+
+    Bricks bricks;
+    for (uint32_t frame = 0; frame < 2; ++frame)
+        for (uint32_t level = 0; level < info.rootNode.getDepth(); ++level)
+        {
+            const livre::Vector3ui blocks = info.rootNode.getBlockSize(level);
+            for (uint32_t z = 0; z < blocks.z(); ++z)
+                for (uint32_t y = 0; y < blocks.y(); ++y)
+                    for (uint32_t x = 0; x < blocks.x(); ++x)
+                    {
+                        const livre::NodeId nodeId(level,
+                                                   livre::Vector3ui(x, y, z),
+                                                   frame);
+                        const livre::ConstMemoryUnitPtr data =
+                            input.getData(nodeId);
+                        output.setData(nodeId, *data);
+                        bricks[nodeId] = data;
+                    }
+        }
+    output.finish();
+    return bricks;
+}
+
+void checkBricks(const std::string& uri, const livre::DataSource& input,
+                 const Bricks& bricks)
+{
+    const livre::DataSource source((servus::URI(uri)));
+    const livre::VolumeInformation& info = source.getVolumeInfo();
+    const livre::VolumeInformation& inputInfo = input.getVolumeInfo();
+    BOOST_CHECK_EQUAL(info.voxels, inputInfo.voxels);
+    BOOST_CHECK_EQUAL(info.overlap, inputInfo.overlap);
+    BOOST_CHECK_EQUAL(info.maximumBlockSize, inputInfo.maximumBlockSize);
+    BOOST_CHECK_EQUAL(info.dataType, inputInfo.dataType);
+    BOOST_CHECK_EQUAL(info.rootNode.getDepth(), inputInfo.rootNode.getDepth());
+    BOOST_CHECK_EQUAL(info.rootNode.getBlockSize(),
+                      inputInfo.rootNode.getBlockSize());
+    BOOST_CHECK_EQUAL(info.frameRange, livre::Vector2ui(0, 2));
+    BOOST_CHECK_EQUAL(info.description, "converted");
+
+    for (const auto& brick : bricks)
+    {
+        const livre::ConstMemoryUnitPtr data = source.getData(brick.first);
+        BOOST_REQUIRE(data);
+        BOOST_REQUIRE_EQUAL(data->getAllocSize(),
+                            brick.second->getAllocSize());
+        BOOST_CHECK(::memcmp(data->getData<uint8_t>(),
+                             brick.second->getData<uint8_t>(),
+                             data->getAllocSize()) == 0);
+    }
+
+    // Frames outside of the stored range have no data
+    BOOST_CHECK(!source.getData(livre::NodeId(0, livre::Vector3ui(0), 2)));
+}
+}
+
+BOOST_AUTO_TEST_CASE(roundTrip)
+{
+    const livre::DataSource input(
+        servus::URI("mem://?sparsity=0.5&datatype=uint16#64,64,64,32"));
+
+    for (const std::string& query : {std::string(), std::string("?compress=1")})
+    {
+        const TemporaryFile file;
+        Bricks bricks;
+        {
+            livre::DataSource output(servus::URI(file.getURI(query)),
+                                     livre::MODE_WRITE);
+            bricks = convert(input, output);
+        }
+        BOOST_CHECK_EQUAL(bricks.size(), 2 * (1 + 8));
+        checkBricks(file.getURI(), input, bricks);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(compression)
+{
+    const livre::DataSource input(servus::URI("mem://#64,64,64,32"));
+    const TemporaryFile raw;
+    const TemporaryFile compressed;
+    {
+        livre::DataSource output(servus::URI(raw.getURI()), livre::MODE_WRITE);
+        convert(input, output);
+    }
+    {
+        livre::DataSource output(servus::URI(compressed.getURI("?compress=1")),
+                                 livre::MODE_WRITE);
+        convert(input, output);
+    }
+    // Constant bricks compress well
+    BOOST_CHECK_LT(fs::file_size(compressed.path), fs::file_size(raw.path));
+}
+
+BOOST_AUTO_TEST_CASE(valueRanges)
+{
+    const livre::DataSource input(servus::URI(
+        "mem://?pattern=blobs&sparsity=0.02&datatype=uint16#64,64,64,16"));
+    const TemporaryFile file;
+    Bricks bricks;
+    {
+        livre::DataSource output(servus::URI(file.getURI()),
+                                 livre::MODE_WRITE);
+        bricks = convert(input, output);
+
+        // The ranges are known once the file is complete
+        livre::Range range;
+        BOOST_CHECK(!output.getValueRange(
+            output.getNode(livre::NodeId(0, livre::Vector3ui(0), 0)), range));
+    }
+
+    // The range of a node covers the bricks of its subtree
+    const livre::DataSource source((servus::URI(file.getURI())));
+    size_t nEmpty = 0;
+    for (const auto& brick : bricks)
+    {
+        livre::Range range;
+        BOOST_REQUIRE(
+            source.getValueRange(source.getNode(brick.first), range));
+        for (const livre::NodeId& nodeId : brick.first.getParents())
+        {
+            livre::Range ancestor;
+            BOOST_REQUIRE(
+                source.getValueRange(source.getNode(nodeId), ancestor));
+            BOOST_CHECK_LE(ancestor[0], range[0]);
+            BOOST_CHECK_GE(ancestor[1], range[1]);
+        }
+
+        const uint16_t* values = brick.second->getData<uint16_t>();
+        const size_t nValues = brick.second->getAllocSize() / 2;
+        const auto minMax = std::minmax_element(values, values + nValues);
+        BOOST_CHECK_LE(range[0], *minMax.first);
+        BOOST_CHECK_GE(range[1], *minMax.second);
+        if (range[1] == 0.f)
+            ++nEmpty;
+    }
+    BOOST_CHECK_GT(nEmpty, 0);
+    BOOST_CHECK_LT(nEmpty, bricks.size());
+}
+
+BOOST_AUTO_TEST_CASE(largeIntegerValueRanges)
+{
+    // Labels above 2^24 have no exact float, the range must still contain
+    // and separate them
+    const uint32_t labels[] = {16777216, 16777217};
+    const livre::Range range =
+        livre::computeValueRange(livre::DT_UINT32,
+                                 reinterpret_cast<const uint8_t*>(labels),
+                                 sizeof(labels));
+    BOOST_CHECK_LE(double(range[0]), 16777216.);
+    BOOST_CHECK_GE(double(range[1]), 16777217.);
+    BOOST_CHECK_LT(range[0], range[1]);
+
+    const int32_t negative[] = {-16777217, -16777216};
+    const livre::Range negativeRange =
+        livre::computeValueRange(livre::DT_INT32,
+                                 reinterpret_cast<const uint8_t*>(negative),
+                                 sizeof(negative));
+    BOOST_CHECK_LE(double(negativeRange[0]), -16777217.);
+    BOOST_CHECK_GE(double(negativeRange[1]), -16777216.);
+    BOOST_CHECK_LT(negativeRange[0], negativeRange[1]);
+}
+
+BOOST_AUTO_TEST_CASE(invalidFiles)
+{
+    const TemporaryFile file;
+    BOOST_CHECK_THROW(livre::DataSource(servus::URI(file.getURI())),
+                      std::runtime_error);
+
+    {
+        std::ofstream stream(file.path.string(), std::ios::binary);
+        stream << "not a Livre volume, but long enough to hold a header "
+               << std::string(256, ' ');
+    }
+    BOOST_CHECK_THROW(livre::DataSource(servus::URI(file.getURI())),
+                      std::runtime_error);
+
+    // Bricks are written after the volume information
+    {
+        const livre::DataSource input(servus::URI("mem://#64,64,64,32"));
+        livre::DataSource output(servus::URI(file.getURI()),
+                                 livre::MODE_WRITE);
+        BOOST_CHECK_THROW(output.setData(livre::NodeId(0, livre::Vector3ui(0),
+                                                       0),
+                                         *input.getData(livre::NodeId(
+                                             0, livre::Vector3ui(0), 0))),
+                          std::runtime_error);
+
+        // Unbounded frame ranges cannot be stored
+        BOOST_CHECK_THROW(output.setVolumeInfo(input.getVolumeInfo()),
+                          std::runtime_error);
+    }
+
+    // Read-only data sources cannot be written
+    livre::DataSource input(servus::URI("mem://#64,64,64,32"));
+    BOOST_CHECK_THROW(input.setVolumeInfo(input.getVolumeInfo()),
+                      std::runtime_error);
+    BOOST_CHECK_THROW(input.finish(), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(finish)
+{
+    const livre::DataSource input(servus::URI("mem://#64,64,64,32"));
+    livre::VolumeInformation info = input.getVolumeInfo();
+    info.frameRange = livre::Vector2ui(0, 1);
+    const livre::NodeId nodeId(0, livre::Vector3ui(0), 0);
+
+    // A finished file cannot be written anymore
+    const TemporaryFile file;
+    livre::DataSource output(servus::URI(file.getURI()), livre::MODE_WRITE);
+    BOOST_CHECK_THROW(output.finish(), std::runtime_error);
+    output.setVolumeInfo(info);
+    output.setData(nodeId, *input.getData(nodeId));
+    output.finish();
+    BOOST_CHECK_THROW(output.finish(), std::runtime_error);
+    BOOST_CHECK_THROW(output.setData(nodeId, *input.getData(nodeId)),
+                      std::runtime_error);
+    BOOST_CHECK_THROW(output.setVolumeInfo(info), std::runtime_error);
+    BOOST_CHECK(livre::DataSource(servus::URI(file.getURI())).getData(nodeId));
+
+#ifdef __linux__
+    // Write errors are reported by finish()
+    livre::DataSource full(servus::URI("lvb:///dev/full"), livre::MODE_WRITE);
+    full.setVolumeInfo(info);
+    BOOST_CHECK_THROW(full.finish(), std::runtime_error);
+#endif
+}
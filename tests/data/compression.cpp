@@ -0,0 +1,101 @@
+/* Copyright (c) 2017, EPFL/Blue Brain Project
+ *                     bbp-open-source@googlegroups.com
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE Compression
+#include <boost/test/unit_test.hpp>
+
+#include <livre/data/Compression.h>
+
+#include <cstdlib>
+
+namespace
+{
+std::vector<uint8_t> compressAndDecompress(const std::vector<uint8_t>& data,
+                                           const size_t elementSize)
+{
+    const std::vector<uint8_t> compressed =
+        livre::compress(data.data(), data.size(), elementSize);
+    std::vector<uint8_t> result(data.size());
+    BOOST_CHECK(livre::decompress(compressed.data(), compressed.size(),
+                                  result.data(), result.size()));
+    return result;
+}
+}
+
+BOOST_AUTO_TEST_CASE(roundTrip)
+{
+    std::vector<uint8_t> data(65536 * 3);
+    // Smooth 16 bit ramp with noise in the low bytes, runs and random tail
+    for (size_t i = 0; i < data.size() / 2; i += 2)
+    {
+        const uint16_t value = uint16_t(i / 64 * 256 + std::rand() % 4);
+        data[i] = uint8_t(value & 0xff);
+        data[i + 1] = uint8_t(value >> 8);
+    }
+    for (size_t i = data.size() / 2; i < data.size(); ++i)
+        data[i] = i < data.size() * 3 / 4 ? 42 : uint8_t(std::rand());
+
+    for (size_t elementSize : {1, 2, 4, 3})
+        BOOST_CHECK(compressAndDecompress(data, elementSize) == data);
+
+    for (size_t size : {0, 1, 4, 5, 17, 300})
+    {
+        const std::vector<uint8_t> small(size, 7);
+        BOOST_CHECK(compressAndDecompress(small, 1) == small);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ratio)
+{
+    std::vector<uint8_t> data(65536);
+    for (size_t i = 0; i < data.size(); i += 2)
+    {
+        data[i] = uint8_t(std::rand() % 4);
+        data[i + 1] = uint8_t(i >> 12);
+    }
+
+    const size_t plain = livre::compress(data.data(), data.size()).size();
+    const size_t shuffled =
+        livre::compress(data.data(), data.size(), 2).size();
+    BOOST_CHECK_LT(plain, data.size());
+    BOOST_CHECK_LT(shuffled, plain);
+
+    const std::vector<uint8_t> zeros(65536, 0);
+    BOOST_CHECK_LT(livre::compress(zeros.data(), zeros.size()).size(), 512);
+}
+
+BOOST_AUTO_TEST_CASE(invalidData)
+{
+    const std::vector<uint8_t> data(1024, 1);
+    std::vector<uint8_t> compressed =
+        livre::compress(data.data(), data.size());
+    std::vector<uint8_t> result(data.size());
+
+    // Wrong size, truncated input and corrupted offset are rejected
+    BOOST_CHECK(!livre::decompress(compressed.data(), compressed.size(),
+                                   result.data(), result.size() - 1));
+    BOOST_CHECK(!livre::decompress(compressed.data(), compressed.size() - 1,
+                                   result.data(), result.size()));
+    BOOST_CHECK(!livre::decompress(compressed.data(), 0, result.data(),
+                                   result.size()));
+    compressed[3] = 0xff;
+    compressed[4] = 0xff;
+    BOOST_CHECK(!livre::decompress(compressed.data(), compressed.size(),
+                                   result.data(), result.size()));
+}
@@ -29,6 +29,12 @@
 
 #include <servus/uri.h>
 
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <vector>
+
 namespace
 {
 const uint32_t BLOCK_SIZE = 32;
@@ -62,6 +68,26 @@ void _testDataSource(const std::string& uriStr)
         lodNode.getBlockSize() + livre::Vector3ui(info.overlap) * 2;
     BOOST_CHECK(blockSize == info.maximumBlockSize);
 }
+
+std::vector<uint16_t> _getBrick(const std::string& uriStr)
+{
+    const livre::DataSource source((servus::URI(uriStr)));
+    const livre::VolumeInformation& info = source.getVolumeInfo();
+    const livre::NodeId nodeId =
+        livre::NodeId(0, livre::Vector3f(0, 0, 0), 0).getChildren().front();
+    const livre::Vector3ui size =
+        source.getNode(nodeId).getBlockSize() + info.overlap * 2;
+
+    const livre::ConstMemoryUnitPtr data = source.getData(nodeId);
+    const uint16_t* voxels = data->getData<uint16_t>();
+    return std::vector<uint16_t>(voxels, voxels + size.product());
+}
+
+float _getOccupancy(const std::vector<uint16_t>& brick)
+{
+    return float(brick.size() - std::count(brick.begin(), brick.end(), 0)) /
+           float(brick.size());
+}
 }
 
 BOOST_AUTO_TEST_CASE(memoryDataSource)
@@ -72,3 +98,73 @@ BOOST_AUTO_TEST_CASE(memoryDataSource)
 
     _testDataSource(volumeName.str());
 }
+
+BOOST_AUTO_TEST_CASE(memoryDataSourcePatterns)
+{
+    for (const std::string pattern :
+         {"constant", "noise", "gradient", "spheres", "blobs"})
+    {
+        const std::string uri =
+            "mem://?datatype=uint16&pattern=" + pattern + "#128,128,128,32";
+        const std::vector<uint16_t> brick = _getBrick(uri);
+        BOOST_CHECK(brick == _getBrick(uri));
+        BOOST_CHECK_GT(_getOccupancy(brick), 0.f);
+    }
+
+    const std::string noise = "mem://?datatype=uint16&pattern=noise";
+    BOOST_CHECK(_getBrick(noise + "&seed=1#128,128,128,32") ==
+                _getBrick(noise + "&seed=1#128,128,128,32"));
+    BOOST_CHECK(_getBrick(noise + "&seed=1#128,128,128,32") !=
+                _getBrick(noise + "&seed=2#128,128,128,32"));
+
+    const float occupancy =
+        _getOccupancy(_getBrick(noise + "&sparsity=0.25#128,128,128,32"));
+    BOOST_CHECK_CLOSE(occupancy, 0.25f, 5.f);
+
+    BOOST_CHECK_THROW(_getBrick("mem://?pattern=foo#128,128,128,32"),
+                      std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(getDataAsync)
+{
+    livre::DataSource source(
+        servus::URI("mem://?datatype=uint16&pattern=noise#128,128,128,32"));
+    const livre::VolumeInformation& info = source.getVolumeInfo();
+
+    livre::NodeIds nodeIds =
+        livre::NodeId(0, livre::Vector3f(0, 0, 0), 0).getChildren();
+    nodeIds.push_back(livre::NodeId()); // reported empty
+
+    std::mutex mutex;
+    std::map<livre::NodeId, livre::MemoryUnitPtr> results;
+    size_t calls = 0;
+    source
+        .getDataAsync(nodeIds,
+                      [&](const livre::NodeId& nodeId,
+                          livre::MemoryUnitPtr data) {
+                          std::lock_guard<std::mutex> lock(mutex);
+                          results[nodeId] = data;
+                          ++calls;
+                      })
+        .get();
+
+    BOOST_CHECK_EQUAL(calls, nodeIds.size());
+    BOOST_CHECK_EQUAL(results.size(), nodeIds.size());
+    BOOST_CHECK(!results[livre::NodeId()]);
+
+    for (const livre::NodeId& nodeId : nodeIds)
+    {
+        if (!nodeId.isValid())
+            continue;
+
+        const livre::MemoryUnitPtr data = results[nodeId];
+        BOOST_REQUIRE(data);
+        const livre::Vector3ui size =
+            source.getNode(nodeId).getBlockSize() + info.overlap * 2;
+        const livre::ConstMemoryUnitPtr expected = source.getData(nodeId);
+        BOOST_CHECK_EQUAL(::memcmp(data->getData<uint8_t>(),
+                                   expected->getData<uint8_t>(),
+                                   size.product() * sizeof(uint16_t)),
+                          0);
+    }
+}
@@ -0,0 +1,192 @@
+/* Copyright (c) 2017, EPFL/Blue Brain Project
+ *                     bbp-open-source@googlegroups.com
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE Downsample
+#include <boost/test/unit_test.hpp>
+
+#include <livre/data/Downsample.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+const livre::DownsampleFilter allFilters[] = {livre::DF_BOX, livre::DF_MAX,
+                                              livre::DF_MODE};
+
+// Straightforward reduction of the 2x2x2 voxels of the input
+template <class T>
+T reduce(const livre::DownsampleFilter filter, const std::vector<T>& in,
+         const livre::Vector3ui& inSize, const int64_t x, const int64_t y,
+         const int64_t z)
+{
+    T values[8];
+    for (size_t i = 0; i < 8; ++i)
+    {
+        const int64_t inX = std::min(2 * x + int64_t(i & 1),
+                                     int64_t(inSize.x() - 1));
+        const int64_t inY = std::min(2 * y + int64_t((i >> 1) & 1),
+                                     int64_t(inSize.y() - 1));
+        const int64_t inZ = std::min(2 * z + int64_t(i >> 2),
+                                     int64_t(inSize.z() - 1));
+        values[i] = in[(inZ * inSize.y() + inY) * inSize.x() + inX];
+    }
+
+    switch (filter)
+    {
+    case livre::DF_BOX:
+    {
+        double sum = 0;
+        for (const T value : values)
+            sum += value;
+        return std::is_floating_point<T>::value ? T(sum / 8)
+                                                : T(std::trunc(sum / 8));
+    }
+    case livre::DF_MAX:
+        return *std::max_element(values, values + 8);
+    case livre::DF_MODE:
+    {
+        size_t best = 0;
+        for (size_t i = 1; i < 8; ++i)
+            if (std::count(values, values + 8, values[i]) >
+                std::count(values, values + 8, values[best]))
+            {
+                best = i;
+            }
+        return values[best];
+    }
+    }
+    return 0;
+}
+
+template <class T>
+std::vector<T> createVolume(const livre::Vector3ui& size, const int range)
+{
+    std::vector<T> volume(size.product());
+    for (T& value : volume)
+        value = T(std::rand() % range);
+    return volume;
+}
+
+template <class T>
+void checkDownsample(const livre::DataType dataType,
+                     const livre::Vector3ui& inSize,
+                     const livre::Vector3ui& outSize,
+                     const livre::Vector3i& origin, const int range)
+{
+    const std::vector<T> in = createVolume<T>(inSize, range);
+    const livre::Vector3ui size = livre::getDownsampledSize(inSize);
+
+    for (const livre::DownsampleFilter filter : allFilters)
+    {
+        std::vector<T> out(outSize.product());
+        livre::downsample(dataType, filter,
+                          reinterpret_cast<const uint8_t*>(in.data()), inSize,
+                          reinterpret_cast<uint8_t*>(out.data()), outSize,
+                          origin);
+
+        size_t errors = 0;
+        for (int64_t z = 0; z < outSize.z(); ++z)
+            for (int64_t y = 0; y < outSize.y(); ++y)
+                for (int64_t x = 0; x < outSize.x(); ++x)
+                {
+                    const int64_t cx = origin.x() + x;
+                    const int64_t cy = origin.y() + y;
+                    const int64_t cz = origin.z() + z;
+                    const bool inside = cx >= 0 && cy >= 0 && cz >= 0 &&
+                                        cx < size.x() && cy < size.y() &&
+                                        cz < size.z();
+                    const T expected =
+                        inside ? reduce(filter, in, inSize, cx, cy, cz) : 0;
+                    const T value =
+                        out[(z * outSize.y() + y) * outSize.x() + x];
+                    if (std::abs(double(value) - double(expected)) >
+                        1e-5 * std::abs(double(expected)))
+                    {
+                        ++errors;
+                    }
+                }
+        BOOST_CHECK_MESSAGE(errors == 0, errors << " wrong voxels for type "
+                                                << dataType << " filter "
+                                                << filter << " input "
+                                                << inSize);
+    }
+}
+
+template <class T>
+void checkType(const livre::DataType dataType, const int range)
+{
+    // Vector and remaining voxels of even and odd sized rows
+    for (const uint32_t width : {1u, 2u, 7u, 64u, 67u, 130u})
+    {
+        const livre::Vector3ui inSize(width, 5, 4);
+        checkDownsample<T>(dataType, inSize,
+                           livre::getDownsampledSize(inSize),
+                           livre::Vector3i(0), range);
+    }
+
+    // Bricks with overlap in and outside of the volume
+    const livre::Vector3ui inSize(75, 33, 20);
+    checkDownsample<T>(dataType, inSize, livre::Vector3ui(24, 12, 8),
+                       livre::Vector3i(-2, -2, -2), range);
+    checkDownsample<T>(dataType, inSize, livre::Vector3ui(24, 12, 8),
+                       livre::Vector3i(20, 10, 6), range);
+    checkDownsample<T>(dataType, inSize, livre::Vector3ui(4),
+                       livre::Vector3i(50, 0, 0), range);
+}
+}
+
+BOOST_AUTO_TEST_CASE(dataTypes)
+{
+    checkType<uint8_t>(livre::DT_UINT8, 256);
+    checkType<uint16_t>(livre::DT_UINT16, 65536);
+    checkType<uint32_t>(livre::DT_UINT32, RAND_MAX);
+    checkType<int8_t>(livre::DT_INT8, 128);
+    checkType<int16_t>(livre::DT_INT16, 32768);
+    checkType<int32_t>(livre::DT_INT32, RAND_MAX);
+    checkType<float>(livre::DT_FLOAT, 1000);
+
+    // Few values, so the mode filter has to pick among repeated ones
+    checkType<uint8_t>(livre::DT_UINT8, 3);
+    checkType<int16_t>(livre::DT_INT16, 2);
+}
+
+BOOST_AUTO_TEST_CASE(filters)
+{
+    const livre::Vector3ui inSize(2);
+    const uint8_t in[] = {1, 1, 2, 2, 9, 3, 3, 3};
+    uint8_t out = 0;
+
+    livre::downsample(livre::DT_UINT8, livre::DF_BOX, in, inSize, &out,
+                      livre::Vector3ui(1));
+    BOOST_CHECK_EQUAL(out, 3);
+    livre::downsample(livre::DT_UINT8, livre::DF_MAX, in, inSize, &out,
+                      livre::Vector3ui(1));
+    BOOST_CHECK_EQUAL(out, 9);
+    livre::downsample(livre::DT_UINT8, livre::DF_MODE, in, inSize, &out,
+                      livre::Vector3ui(1));
+    BOOST_CHECK_EQUAL(out, 3);
+
+    BOOST_CHECK_THROW(livre::downsample(livre::DT_UNDEFINED, livre::DF_BOX,
+                                        in, inSize, &out, livre::Vector3ui(1)),
+                      std::runtime_error);
+}
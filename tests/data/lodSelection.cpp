@@ -21,24 +21,96 @@
 
 #include <livre/data/DFSTraversal.h>
 #include <livre/data/DataSource.h>
+#include <livre/data/DataSourcePlugin.h>
+#include <livre/data/DataSourceVisitor.h>
 #include <livre/data/Frustum.h>
 #include <livre/data/MemoryDataSource.h>
 #include <livre/data/SelectVisibles.h>
 
+#include <lunchbox/clock.h>
 #include <lunchbox/pluginRegisterer.h>
 
 #include <boost/test/unit_test.hpp>
 
+typedef std::vector<livre::Identifier> Identifiers;
+
+namespace
+{
+// The blobs of a memory data source, whose value ranges are unknown until
+// they are ready, like the ones computed in the background
+class LateRangesDataSource : public livre::DataSourcePlugin
+{
+public:
+    explicit LateRangesDataSource(const livre::DataSourcePluginData&)
+        : _source(lunchbox::URI(
+              "mem://?pattern=blobs&sparsity=0.1#4096,4096,4096,64"))
+    {
+        _volumeInfo = _source.getVolumeInfo();
+    }
+
+    static bool handles(const livre::DataSourcePluginData& initData)
+    {
+        return initData.getURI().getScheme() == "late";
+    }
+
+    static std::string getDescription() { return "late://"; }
+
+    livre::MemoryUnitPtr getData(const livre::LODNode&) final
+    {
+        return livre::MemoryUnitPtr();
+    }
+
+    bool getValueRange(const livre::LODNode& node,
+                       livre::Range& range) const final
+    {
+        return rangesReady && _source.getValueRange(node, range);
+    }
+
+    static bool rangesReady;
+
+private:
+    const livre::DataSource _source;
+};
+
+bool LateRangesDataSource::rangesReady = false;
+
+class CountVisitor : public livre::DataSourceVisitor
+{
+public:
+    explicit CountVisitor(const livre::DataSource& dataSource)
+        : livre::DataSourceVisitor(dataSource)
+    {
+    }
+
+    bool visit(const livre::LODNode&) final
+    {
+        ++count;
+        return true;
+    }
+
+    std::unique_ptr<livre::NodeVisitor> fork() const final
+    {
+        return std::unique_ptr<livre::NodeVisitor>(
+            new CountVisitor(getDataSource()));
+    }
+
+    bool canFork() const final { return true; }
+
+    void join(livre::NodeVisitor& visitor) final
+    {
+        count += static_cast<const CountVisitor&>(visitor).count;
+    }
+
+    size_t count = 0;
+};
+}
+
 // Explicit registration required because the folder of the data source plugin
 // is not in the LD_LIBRARY_PATH of the test executable.
 lunchbox::PluginRegisterer<livre::MemoryDataSource> registerer;
+lunchbox::PluginRegisterer<LateRangesDataSource> lateRegisterer;
 
-typedef std::vector<livre::Identifier> Identifiers;
-
-Identifiers getVisibles(const livre::DataSource& dataSource,
-                        const uint32_t windowHeight,
-                        const float screenSpaceError, const uint32_t minLOD,
-                        const uint32_t maxLOD)
+livre::Frustum getFrustum(const float angle = 0.f)
 {
     const float projArray[] = {
         2.0, 0,           0,  0, 0, 2.0,          0, 0, 0,
@@ -46,15 +118,30 @@ Identifiers getVisibles(const livre::DataSource& dataSource,
 
     const livre::Matrix4f projMat(projArray, projArray + 16);
 
-    const float mvArray[] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, -1.0, 1};
+    // rotated by angle around the y axis
+    const float c = std::cos(angle);
+    const float s = std::sin(angle);
+    const float mvArray[] = {c, 0, -s, 0, 0, 1, 0, 0,
+                             s, 0, c,  0, 0, 0, -1.0, 1};
 
     const livre::Matrix4f mvMat(mvArray, mvArray + 16);
-    const livre::Frustum frustum(mvMat, projMat);
+    return livre::Frustum(mvMat, projMat);
+}
+
+Identifiers getVisibles(const livre::DataSource& dataSource,
+                        const uint32_t windowHeight,
+                        const float screenSpaceError, const uint32_t minLOD,
+                        const uint32_t maxLOD,
+                        const livre::TransparencyFunc& isTransparent =
+                            livre::TransparencyFunc())
+{
+    const livre::Frustum frustum = getFrustum();
 
     livre::ClipPlanes planes;
     livre::SelectVisibles selectVisibles(dataSource, frustum, windowHeight,
                                          screenSpaceError, minLOD, maxLOD,
-                                         {{0.0f, 1.0f}}, planes);
+                                         {{0.0f, 1.0f}}, planes,
+                                         isTransparent);
 
     livre::DFSTraversal traverser;
     traverser.traverse(dataSource.getVolumeInfo().rootNode, selectVisibles, 0);
@@ -206,3 +293,179 @@ BOOST_AUTO_TEST_CASE(testLODSelection)
             BOOST_CHECK_EQUAL(livre::NodeId(visible).getLevel(), maxMinLevel);
     }
 }
+
+BOOST_AUTO_TEST_CASE(emptySpaceCulling)
+{
+    const livre::DataSource dense(
+        lunchbox::URI("mem://?pattern=blobs&sparsity=1#4096,4096,4096,256"));
+    const Identifiers& all = getVisibles(dense, 256, 1.0, 0, 100);
+    BOOST_CHECK_EQUAL(all.size(), 36);
+
+    // The subtrees outside of the blobs are skipped
+    const livre::DataSource sparse(
+        lunchbox::URI("mem://?pattern=blobs&sparsity=0.02#4096,4096,4096,256"));
+    const Identifiers& visibles = getVisibles(sparse, 256, 1.0, 0, 100);
+    BOOST_CHECK(!visibles.empty());
+    BOOST_CHECK_LT(visibles.size(), all.size());
+    BOOST_CHECK(std::includes(all.begin(), all.end(), visibles.begin(),
+                              visibles.end()));
+
+    const livre::DataSource empty(
+        lunchbox::URI("mem://?pattern=blobs&sparsity=0#4096,4096,4096,256"));
+    BOOST_CHECK(getVisibles(empty, 256, 1.0, 0, 100).empty());
+
+    // Opaque uniform subtrees are not refined
+    const auto opaque = [](const livre::Range&) { return false; };
+    BOOST_CHECK(getVisibles(empty, 256, 1.0, 0, 100, opaque) ==
+                Identifiers{0});
+
+    const auto transparent = [](const livre::Range&) { return true; };
+    BOOST_CHECK(getVisibles(dense, 256, 1.0, 0, 100, transparent).empty());
+}
+
+BOOST_AUTO_TEST_CASE(traversalPerf)
+{
+    // 128^3 blocks at the finest level, 8 levels
+    const livre::DataSource dataSource(
+        lunchbox::URI("mem://#8192,8192,8192,64"));
+    const livre::RootNode& rootNode = dataSource.getVolumeInfo().rootNode;
+    BOOST_REQUIRE_EQUAL(rootNode.getDepth(), 8);
+
+    const size_t nodes = ((size_t(1) << (3 * 8)) - 1) / 7;
+    livre::DFSTraversal traverser;
+    lunchbox::Clock clock;
+    {
+        CountVisitor visitor(dataSource);
+        traverser.traverse(rootNode, visitor, 0);
+        const float time = clock.resetTimef();
+        BOOST_CHECK_EQUAL(visitor.count, nodes);
+        std::cout << "Traversal: " << nodes / time << " nodes/ms (" << nodes
+                  << " nodes, " << time << " ms)" << std::endl;
+    }
+    {
+        CountVisitor visitor(dataSource);
+        traverser.traverseParallel(rootNode, visitor, 0);
+        const float time = clock.resetTimef();
+        BOOST_CHECK_EQUAL(visitor.count, nodes);
+        std::cout << "Parallel traversal: " << nodes / time << " nodes/ms ("
+                  << nodes << " nodes, " << time << " ms)" << std::endl;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(parallelTraversal)
+{
+    const livre::DataSource dataSource(
+        lunchbox::URI("mem://?pattern=blobs&sparsity=0.1#4096,4096,4096,64"));
+    const livre::RootNode& rootNode = dataSource.getVolumeInfo().rootNode;
+    const livre::ClipPlanes planes;
+
+    // The parallel traversal selects the same nodes in the same order, also
+    // for the sort-last ranges
+    for (const livre::Range& range : {livre::Range{{0.f, 1.f}},
+                                      livre::Range{{0.25f, 0.75f}}})
+    {
+        livre::SelectVisibles serial(dataSource, getFrustum(), 256, 1.0, 0,
+                                     100, range, planes);
+        livre::SelectVisibles parallel(dataSource, getFrustum(), 256, 1.0, 0,
+                                       100, range, planes);
+
+        livre::DFSTraversal traverser;
+        traverser.traverse(rootNode, serial, 0);
+        traverser.traverseParallel(rootNode, parallel, 0);
+
+        const livre::NodeIds& expected = serial.getVisibles();
+        const livre::NodeIds& visibles = parallel.getVisibles();
+        BOOST_CHECK(!expected.empty());
+        BOOST_CHECK(visibles == expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(incrementalSelection)
+{
+    const livre::DataSource dataSource(
+        lunchbox::URI("mem://?pattern=blobs&sparsity=0.1#4096,4096,4096,64"));
+    const livre::RootNode& rootNode = dataSource.getVolumeInfo().rootNode;
+    const livre::ClipPlanes planes;
+    const livre::Range range = {{0.f, 1.f}};
+
+    const auto select = [&](livre::VisibleCut& cut, const float angle,
+                            const float screenSpaceError,
+                            const livre::TransparencyFunc& isTransparent,
+                            size_t& nEvaluated) {
+        livre::SelectVisibles full(dataSource, getFrustum(angle), 256,
+                                   screenSpaceError, 0, 100, range, planes,
+                                   isTransparent);
+        livre::DFSTraversal traverser;
+        traverser.traverse(rootNode, full, 0);
+
+        livre::SelectVisibles incremental(dataSource, getFrustum(angle), 256,
+                                          screenSpaceError, 0, 100, range,
+                                          planes, isTransparent);
+        nEvaluated = incremental.select(cut, 0);
+        BOOST_CHECK(incremental.getVisibles() == full.getVisibles());
+    };
+
+    // Small camera motions only evaluate the nodes close to a decision
+    livre::VisibleCut cut;
+    size_t nNodes = 0;
+    for (size_t i = 0; i < 10; ++i)
+    {
+        size_t nEvaluated = 0;
+        select(cut, 0.002f * i, 1.0f, livre::TransparencyFunc(), nEvaluated);
+        BOOST_CHECK_GT(nEvaluated, 0);
+        if (i == 0)
+            nNodes = nEvaluated;
+        else
+            BOOST_CHECK_LT(nEvaluated, nNodes);
+    }
+
+    // Nothing to evaluate for an unchanged frame
+    size_t nEvaluated = 0;
+    select(cut, 0.002f * 9, 1.0f, livre::TransparencyFunc(), nEvaluated);
+    BOOST_CHECK_EQUAL(nEvaluated, 0);
+
+    // Changed parameters and transfer functions are still honored
+    select(cut, 0.002f * 9, 2.0f, livre::TransparencyFunc(), nEvaluated);
+    // only the empty space is opaque
+    const auto transparent = [](const livre::Range& values) {
+        return values[1] > 0.f;
+    };
+    select(cut, 0.002f * 9, 2.0f, transparent, nEvaluated);
+    select(cut, 0.002f * 10, 2.0f, transparent, nEvaluated);
+    select(cut, 0.002f * 10, 2.0f, livre::TransparencyFunc(), nEvaluated);
+
+    cut.clear();
+    select(cut, 0.002f * 10, 2.0f, livre::TransparencyFunc(), nEvaluated);
+    BOOST_CHECK_GT(nEvaluated, 0);
+}
+
+BOOST_AUTO_TEST_CASE(lateValueRanges)
+{
+    const livre::DataSource dataSource((lunchbox::URI("late://")));
+    const livre::RootNode& rootNode = dataSource.getVolumeInfo().rootNode;
+    const livre::ClipPlanes planes;
+    const livre::Range range = {{0.f, 1.f}};
+
+    const auto select = [&](livre::VisibleCut& cut) -> size_t {
+        livre::SelectVisibles full(dataSource, getFrustum(), 256, 1.0f, 0,
+                                   100, range, planes);
+        livre::DFSTraversal traverser;
+        traverser.traverse(rootNode, full, 0);
+
+        livre::SelectVisibles incremental(dataSource, getFrustum(), 256, 1.0f,
+                                          0, 100, range, planes);
+        const size_t nEvaluated = incremental.select(cut, 0);
+        BOOST_CHECK(incremental.getVisibles() == full.getVisibles());
+        return nEvaluated;
+    };
+
+    // The nodes selected without values are evaluated again once the values
+    // are known, and the empty space is skipped from then on
+    livre::VisibleCut cut;
+    BOOST_CHECK_GT(select(cut), 0);
+    BOOST_CHECK_EQUAL(select(cut), 0);
+
+    LateRangesDataSource::rangesReady = true;
+    BOOST_CHECK_GT(select(cut), 0);
+    BOOST_CHECK_EQUAL(select(cut), 0);
+}
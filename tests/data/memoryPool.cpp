@@ -0,0 +1,207 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE MemoryPool
+#include <boost/test/unit_test.hpp>
+
+#include <livre/data/MemoryPool.h>
+#include <livre/data/MemoryUnit.h>
+
+#include <boost/thread/thread.hpp>
+
+#include <cstring>
+#include <set>
+
+namespace
+{
+const size_t brickSize = 32 * 32 * 32 * 2;
+const size_t slabSize = 16 * 1024 * 1024;
+}
+
+BOOST_AUTO_TEST_CASE(reuse)
+{
+    livre::MemoryPool pool;
+    uint8_t* first = pool.allocate(brickSize);
+    BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(first) % 64, 0);
+    ::memset(first, 0xff, brickSize);
+
+    livre::MemoryPool::Statistics statistics = pool.getStatistics();
+    BOOST_CHECK_EQUAL(statistics.slabs, 1);
+    BOOST_CHECK_EQUAL(statistics.reservedBytes, brickSize);
+    BOOST_CHECK_EQUAL(statistics.usedBytes, brickSize);
+    BOOST_CHECK_EQUAL(statistics.allocations, 1);
+    BOOST_CHECK_EQUAL(statistics.reuses, 0);
+
+    // A released slot is the next one of its size
+    pool.deallocate(first, brickSize);
+    BOOST_CHECK_EQUAL(pool.allocate(brickSize), first);
+    statistics = pool.getStatistics();
+    BOOST_CHECK_EQUAL(statistics.reuses, 1);
+    BOOST_CHECK_EQUAL(statistics.usedBytes, brickSize);
+
+    // All slots are distinct, the next slab is allocated on demand with
+    // twice as many slots as the previous one
+    std::set<uint8_t*> buffers = {first};
+    BOOST_CHECK(buffers.insert(pool.allocate(brickSize)).second);
+    statistics = pool.getStatistics();
+    BOOST_CHECK_EQUAL(statistics.slabs, 2);
+    BOOST_CHECK_EQUAL(statistics.reservedBytes, 3 * brickSize);
+
+    // The slabs do not grow beyond the slab size
+    for (size_t i = 0; i < 4 * slabSize / brickSize; ++i)
+        BOOST_CHECK(buffers.insert(pool.allocate(brickSize)).second);
+    statistics = pool.getStatistics();
+    BOOST_CHECK_EQUAL(statistics.usedBytes, buffers.size() * brickSize);
+    BOOST_CHECK_LT(statistics.reservedBytes - statistics.usedBytes, slabSize);
+
+    for (uint8_t* buffer : buffers)
+        pool.deallocate(buffer, brickSize);
+    BOOST_CHECK_EQUAL(pool.getStatistics().usedBytes, 0);
+}
+
+BOOST_AUTO_TEST_CASE(sizes)
+{
+    livre::MemoryPool pool;
+    uint8_t* large = pool.allocate(3 * slabSize / 2);
+    ::memset(large, 0xff, 3 * slabSize / 2);
+
+    // A rarely used size only reserves the pages of its buffer
+    uint8_t* edge = pool.allocate(brickSize + 100);
+    ::memset(edge, 0xff, brickSize + 100);
+    BOOST_CHECK_NE(edge, large);
+
+    const livre::MemoryPool::Statistics statistics = pool.getStatistics();
+    BOOST_CHECK_EQUAL(statistics.slabs, 2);
+    BOOST_CHECK_EQUAL(statistics.usedBytes,
+                      3 * slabSize / 2 + brickSize + 128);
+    BOOST_CHECK_EQUAL(statistics.reservedBytes,
+                      3 * slabSize / 2 + brickSize + 4096);
+    pool.deallocate(edge, brickSize + 100);
+    pool.deallocate(large, 3 * slabSize / 2);
+}
+
+BOOST_AUTO_TEST_CASE(smallBuffers)
+{
+    // Buffers smaller than a page are allocated on the heap
+    livre::MemoryPool pool;
+    uint8_t* small = pool.allocate(1);
+    uint8_t* tiny = pool.allocate(0);
+    BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(small) % 64, 0);
+    BOOST_CHECK_NE(small, tiny);
+    *small = 42;
+
+    const livre::MemoryPool::Statistics statistics = pool.getStatistics();
+    BOOST_CHECK_EQUAL(statistics.slabs, 0);
+    BOOST_CHECK_EQUAL(statistics.usedBytes, 0);
+    pool.deallocate(small, 1);
+    pool.deallocate(tiny, 0);
+}
+
+BOOST_AUTO_TEST_CASE(trim)
+{
+    livre::MemoryPool pool;
+    uint8_t* used = pool.allocate(brickSize);
+    uint8_t* unused = pool.allocate(slabSize);
+    pool.deallocate(unused, slabSize);
+    BOOST_CHECK_EQUAL(pool.getStatistics().slabs, 2);
+
+    // Only the slab without buffers in use is freed
+    BOOST_CHECK_EQUAL(pool.trim(), slabSize);
+    BOOST_CHECK_EQUAL(pool.getStatistics().slabs, 1);
+    BOOST_CHECK_EQUAL(pool.trim(), 0);
+
+    // Trimmed slots are not reused
+    uint8_t* buffer = pool.allocate(slabSize);
+    ::memset(buffer, 0, slabSize);
+    BOOST_CHECK_EQUAL(pool.getStatistics().slabs, 2);
+    pool.deallocate(buffer, slabSize);
+    pool.deallocate(used, brickSize);
+}
+
+BOOST_AUTO_TEST_CASE(hugePages)
+{
+    livre::MemoryPool pool(true);
+    uint8_t* buffer = pool.allocate(brickSize);
+    BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(buffer) % (2 << 20), 0);
+    ::memset(buffer, 0xff, brickSize);
+
+    const livre::MemoryPool::Statistics statistics = pool.getStatistics();
+    BOOST_CHECK_EQUAL(statistics.hugePageBytes, statistics.reservedBytes);
+    pool.deallocate(buffer, brickSize);
+
+    pool.setHugePages(false);
+    buffer = pool.allocate(slabSize);
+    BOOST_CHECK_LT(pool.getStatistics().hugePageBytes,
+                   pool.getStatistics().reservedBytes);
+    pool.deallocate(buffer, slabSize);
+}
+
+BOOST_AUTO_TEST_CASE(memoryUnit)
+{
+    livre::MemoryPool pool;
+    const std::vector<uint8_t> data(brickSize, 42);
+    {
+        const livre::PooledMemoryUnit unit(data.data(), data.size(), pool);
+        BOOST_CHECK_EQUAL(unit.getAllocSize(), brickSize);
+        BOOST_CHECK_EQUAL_COLLECTIONS(unit.getData<uint8_t>(),
+                                      unit.getData<uint8_t>() + brickSize,
+                                      data.begin(), data.end());
+        BOOST_CHECK_EQUAL(pool.getStatistics().usedBytes, brickSize);
+        BOOST_CHECK(!unit.isMapped());
+    }
+    BOOST_CHECK_EQUAL(pool.getStatistics().usedBytes, 0);
+
+    const livre::ConstMemoryUnit reference(data.data(), data.size());
+    const livre::MemoryUnit& unit = reference;
+    BOOST_CHECK(unit.isMapped());
+    unit.prefetch();
+    BOOST_CHECK_EQUAL(unit.getData<uint8_t>(), data.data());
+}
+
+BOOST_AUTO_TEST_CASE(vectorMemoryUnit)
+{
+    std::vector<uint8_t> data(brickSize, 42);
+    const uint8_t* ptr = data.data();
+    const livre::VectorMemoryUnit unit(std::move(data));
+    BOOST_CHECK_EQUAL(unit.getData<uint8_t>(), ptr);
+    BOOST_CHECK_EQUAL(unit.getAllocSize(), brickSize);
+    BOOST_CHECK(!unit.isMapped());
+}
+
+BOOST_AUTO_TEST_CASE(concurrentAccess)
+{
+    livre::MemoryPool pool;
+    boost::thread_group threads;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        threads.create_thread([&pool, i] {
+            for (size_t j = 0; j < 1000; ++j)
+            {
+                livre::PooledMemoryUnit unit(brickSize, pool);
+                unit.getData<uint8_t>()[j % brickSize] = uint8_t(i);
+            }
+        });
+    }
+    threads.join_all();
+
+    const livre::MemoryPool::Statistics statistics = pool.getStatistics();
+    BOOST_CHECK_EQUAL(statistics.usedBytes, 0);
+    BOOST_CHECK_EQUAL(statistics.allocations, 4000);
+    BOOST_CHECK_LE(statistics.slabs, 3); // 1 + 2 + 4 slots for 4 threads
+}
@@ -29,9 +29,16 @@ const uint32_t VOXEL_SIZE_X = 41;
 const uint32_t VOXEL_SIZE_Y = 41;
 const uint32_t VOXEL_SIZE_Z = 41;
 
+#include <livre/data/MemoryUnit.h>
 #include <livre/data/RawDataSource.h>
 #include <lunchbox/pluginRegisterer.h>
 
+#include <boost/filesystem.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <thread>
+
 // Explicit registration required because the folder of the data source plugin
 // is not
 // in the LD_LIBRARY_PATH of the test executable.
@@ -81,3 +88,146 @@ BOOST_AUTO_TEST_CASE(RawDataSource)
     const lunchbox::URI uri(volumeName.str());
     createAndCheckDataSource(uri);
 }
+
+namespace
+{
+const livre::Vector3ui BRICKED_VOXELS(96, 64, 40);
+
+uint8_t getVoxel(const uint32_t x, const uint32_t y, const uint32_t z)
+{
+    return (x + 3 * y + 7 * z) % 251;
+}
+
+uint8_t getBrickVoxel(const livre::ConstMemoryUnitPtr& data,
+                      const livre::Vector3ui& size, const uint32_t x,
+                      const uint32_t y, const uint32_t z)
+{
+    return data->getData<uint8_t>()[(z * size.y() + y) * size.x() + x];
+}
+
+size_t countFiles(const boost::filesystem::path& directory)
+{
+    return std::distance(boost::filesystem::directory_iterator(directory),
+                         boost::filesystem::directory_iterator());
+}
+}
+
+BOOST_AUTO_TEST_CASE(BrickedRawDataSource)
+{
+    namespace fs = boost::filesystem;
+    const fs::path directory =
+        fs::temp_directory_path() / fs::unique_path("livre-%%%%-%%%%");
+    fs::create_directories(directory);
+    const fs::path filename = directory / "volume.raw";
+    {
+        std::ofstream file(filename.string(), std::ios::binary);
+        for (uint32_t z = 0; z < BRICKED_VOXELS.z(); ++z)
+            for (uint32_t y = 0; y < BRICKED_VOXELS.y(); ++y)
+                for (uint32_t x = 0; x < BRICKED_VOXELS.x(); ++x)
+                    file.put(char(getVoxel(x, y, z)));
+    }
+
+    // The levels are stored next to the volume by default
+    std::stringstream volumeName;
+    volumeName << "raw://" << filename.string() << "?brick=32&overlap=2#"
+               << BRICKED_VOXELS.x() << "," << BRICKED_VOXELS.y() << ","
+               << BRICKED_VOXELS.z();
+    const lunchbox::URI uri(volumeName.str());
+    const livre::Vector3ui brickSize(36);
+    {
+        const livre::DataSource source(uri);
+        const livre::VolumeInformation& info = source.getVolumeInfo();
+        BOOST_CHECK_EQUAL(info.voxels, BRICKED_VOXELS);
+        BOOST_CHECK_EQUAL(info.overlap, livre::Vector3ui(2));
+        BOOST_CHECK_EQUAL(info.maximumBlockSize, brickSize);
+        BOOST_CHECK_EQUAL(info.rootNode.getDepth(), 2);
+        BOOST_CHECK_EQUAL(info.rootNode.getBlockSize(),
+                          livre::Vector3ui(2, 1, 1));
+
+        // The finest bricks are cut from the file, outside voxels are 0
+        const livre::NodeId finestId(1, livre::Vector3ui(1, 0, 0), 0);
+        const livre::ConstMemoryUnitPtr finest = source.getData(finestId);
+        BOOST_REQUIRE(finest);
+        BOOST_CHECK_EQUAL(finest->getAllocSize(), brickSize.product());
+        BOOST_CHECK_EQUAL(getBrickVoxel(finest, brickSize, 2, 2, 2),
+                          getVoxel(32, 0, 0));
+        BOOST_CHECK_EQUAL(getBrickVoxel(finest, brickSize, 35, 10, 20),
+                          getVoxel(65, 8, 18));
+        BOOST_CHECK_EQUAL(getBrickVoxel(finest, brickSize, 2, 0, 2), 0);
+
+        // The coarser levels average 2x2x2 voxels
+        const livre::NodeId rootId(0, livre::Vector3ui(0), 0);
+        const livre::ConstMemoryUnitPtr root = source.getData(rootId);
+        BOOST_REQUIRE(root);
+        uint32_t sum = 0;
+        for (uint32_t i = 0; i < 8; ++i)
+            sum += getVoxel(20 + (i & 1), 10 + ((i >> 1) & 1), 4 + (i >> 2));
+        BOOST_CHECK_EQUAL(getBrickVoxel(root, brickSize, 12, 7, 4), sum / 8);
+    }
+
+    // The downsampled level is stored once and reused
+    BOOST_CHECK_EQUAL(countFiles(directory), 2);
+    {
+        const livre::DataSource source(uri);
+        const livre::NodeId rootId(0, livre::Vector3ui(0), 0);
+        BOOST_CHECK(source.getData(rootId));
+    }
+    BOOST_CHECK_EQUAL(countFiles(directory), 2);
+
+    fs::remove_all(directory);
+}
+
+BOOST_AUTO_TEST_CASE(RawValueRanges)
+{
+    namespace fs = boost::filesystem;
+    const fs::path directory =
+        fs::temp_directory_path() / fs::unique_path("livre-%%%%-%%%%");
+    fs::create_directories(directory);
+    const fs::path filename = directory / "volume.raw";
+    {
+        // Only the first 32 voxels in x are not empty
+        std::ofstream file(filename.string(), std::ios::binary);
+        for (uint32_t z = 0; z < BRICKED_VOXELS.z(); ++z)
+            for (uint32_t y = 0; y < BRICKED_VOXELS.y(); ++y)
+                for (uint32_t x = 0; x < BRICKED_VOXELS.x(); ++x)
+                    file.put(char(x < 32 ? getVoxel(x, y, z) : 0));
+    }
+
+    std::stringstream volumeName;
+    volumeName << "raw://" << filename.string()
+               << "?brick=32&overlap=2&lod-dir=" << directory.string() << "#"
+               << BRICKED_VOXELS.x() << "," << BRICKED_VOXELS.y() << ","
+               << BRICKED_VOXELS.z();
+    {
+        const livre::DataSource source((lunchbox::URI(volumeName.str())));
+        const livre::LODNode& root =
+            source.getNode(livre::NodeId(0, livre::Vector3ui(0), 0));
+
+        // The ranges are computed in the background
+        livre::Range range;
+        for (size_t i = 0; i < 1000 && !source.getValueRange(root, range); ++i)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        BOOST_REQUIRE(source.getValueRange(root, range));
+        BOOST_CHECK_EQUAL(range[0], 0.f);
+        BOOST_CHECK_EQUAL(range[1], 250.f);
+
+        // The bricks and their overlap beyond x = 32 are empty
+        const livre::NodeId emptyIds[] = {
+            livre::NodeId(1, livre::Vector3ui(2, 1, 1), 0),
+            livre::NodeId(1, livre::Vector3ui(3, 0, 0), 0)};
+        for (const livre::NodeId& nodeId : emptyIds)
+        {
+            BOOST_REQUIRE(
+                source.getValueRange(source.getNode(nodeId), range));
+            BOOST_CHECK_EQUAL(range[1], 0.f);
+        }
+
+        const livre::NodeId borderId(1, livre::Vector3ui(1, 0, 0), 0);
+        BOOST_REQUIRE(source.getValueRange(source.getNode(borderId), range));
+        BOOST_CHECK_GT(range[1], 0.f);
+    }
+
+    // The ranges are stored next to the volume
+    BOOST_CHECK_EQUAL(countFiles(directory), 2);
+    fs::remove_all(directory);
+}
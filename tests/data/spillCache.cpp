@@ -0,0 +1,155 @@
+/* Copyright (c) 2017, EPFL/Blue Brain Project
+ *                     bbp-open-source@googlegroups.com
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE SpillCache
+#include <boost/test/unit_test.hpp>
+
+#include <livre/data/Compression.h>
+#include <livre/data/MemoryUnit.h>
+#include <livre/data/NodeId.h>
+#include <livre/data/SpillCache.h>
+#include <livre/data/VolumeInformation.h>
+
+#include <servus/uri.h>
+
+#include <boost/filesystem.hpp>
+
+namespace
+{
+const size_t BRICK_SIZE = 4096;
+
+livre::ConstMemoryUnitPtr createBrick(const uint8_t value)
+{
+    return livre::ConstMemoryUnitPtr(new livre::AllocMemoryUnit(
+        std::vector<uint8_t>(BRICK_SIZE, value)));
+}
+
+struct SpillDirectory
+{
+    SpillDirectory()
+        : path(boost::filesystem::temp_directory_path() /
+               boost::filesystem::unique_path())
+    {
+    }
+
+    ~SpillDirectory() { boost::filesystem::remove_all(path); }
+    const boost::filesystem::path path;
+};
+}
+
+BOOST_AUTO_TEST_CASE(storeAndLoad)
+{
+    const SpillDirectory directory;
+    const servus::URI uri("mem://#64,64,64,16");
+    const livre::VolumeInformation info;
+    const livre::NodeId nodeId(42);
+
+    livre::SpillCache cache(directory.path.string(), 3 * BRICK_SIZE, uri,
+                            info);
+    BOOST_CHECK(!cache.load(nodeId));
+    BOOST_CHECK_EQUAL(cache.getMisses(), 1);
+
+    BOOST_CHECK(cache.store(nodeId, createBrick(7)));
+    cache.flush();
+    BOOST_CHECK_EQUAL(cache.getCount(), 1);
+    BOOST_CHECK_EQUAL(cache.getUsedMemory(), BRICK_SIZE);
+
+    const livre::ConstMemoryUnitPtr data = cache.load(nodeId);
+    BOOST_REQUIRE(data);
+    BOOST_CHECK_EQUAL(data->getAllocSize(), BRICK_SIZE);
+    BOOST_CHECK_EQUAL(data->getData<uint8_t>()[BRICK_SIZE - 1], 7);
+    BOOST_CHECK_EQUAL(cache.getHits(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(storeCompressed)
+{
+    const SpillDirectory directory;
+    const servus::URI uri("mem://#64,64,64,16");
+    const livre::VolumeInformation info;
+
+    livre::SpillCache cache(directory.path.string(), 3 * BRICK_SIZE, uri,
+                            info);
+    const livre::ConstMemoryUnitPtr brick = createBrick(7);
+    const livre::ConstMemoryUnitPtr compressed(new livre::AllocMemoryUnit(
+        livre::compress(brick->getData<uint8_t>(), BRICK_SIZE)));
+    BOOST_REQUIRE_LT(compressed->getAllocSize(), BRICK_SIZE);
+
+    // The brick is stored decompressed
+    cache.store(livre::NodeId(1), compressed, BRICK_SIZE);
+    cache.flush();
+    const livre::ConstMemoryUnitPtr data = cache.load(livre::NodeId(1));
+    BOOST_REQUIRE(data);
+    BOOST_CHECK_EQUAL(data->getAllocSize(), BRICK_SIZE);
+    BOOST_CHECK_EQUAL(data->getData<uint8_t>()[BRICK_SIZE - 1], 7);
+
+    // Corrupted data is not stored
+    cache.store(livre::NodeId(2), compressed, 2 * BRICK_SIZE);
+    cache.flush();
+    BOOST_CHECK_EQUAL(cache.getCount(), 1);
+    BOOST_CHECK(!cache.load(livre::NodeId(2)));
+}
+
+BOOST_AUTO_TEST_CASE(eviction)
+{
+    const SpillDirectory directory;
+    const servus::URI uri("mem://#64,64,64,16");
+    const livre::VolumeInformation info;
+
+    livre::SpillCache cache(directory.path.string(), 3 * BRICK_SIZE, uri,
+                            info);
+    for (uint8_t i = 0; i < 3; ++i)
+        cache.store(livre::NodeId(i), createBrick(i));
+    cache.flush();
+
+    // A load makes 0 the most recently used, so 1 is removed for 3
+    BOOST_CHECK(cache.load(livre::NodeId(0)));
+    cache.store(livre::NodeId(3), createBrick(3));
+    cache.flush();
+    BOOST_CHECK_EQUAL(cache.getCount(), 3);
+    BOOST_CHECK(cache.getUsedMemory() <= cache.getMaximumMemory());
+    BOOST_CHECK(cache.load(livre::NodeId(0)));
+    BOOST_CHECK(!cache.load(livre::NodeId(1)));
+    BOOST_CHECK(cache.load(livre::NodeId(3)));
+}
+
+BOOST_AUTO_TEST_CASE(restart)
+{
+    const SpillDirectory directory;
+    const livre::VolumeInformation info;
+    const livre::NodeId nodeId(42);
+    {
+        livre::SpillCache cache(directory.path.string(), 3 * BRICK_SIZE,
+                                servus::URI("mem://#64,64,64,16"), info);
+        cache.store(nodeId, createBrick(1));
+    }
+    {
+        // Same volume, the brick is still there
+        livre::SpillCache cache(directory.path.string(), 3 * BRICK_SIZE,
+                                servus::URI("mem://#64,64,64,16"), info);
+        BOOST_CHECK_EQUAL(cache.getCount(), 1);
+        BOOST_CHECK(cache.load(nodeId));
+    }
+    {
+        // Another volume invalidates the directory
+        livre::SpillCache cache(directory.path.string(), 3 * BRICK_SIZE,
+                                servus::URI("mem://#128,128,128,16"), info);
+        BOOST_CHECK_EQUAL(cache.getCount(), 0);
+        BOOST_CHECK(!cache.load(nodeId));
+    }
+}
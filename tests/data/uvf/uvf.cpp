@@ -25,6 +25,9 @@
 
 #include <livre/data/DataSource.h>
 #include <livre/data/LODNode.h>
+#include <livre/data/MemoryUnit.h>
+
+#include <cstring>
 
 const uint32_t BLOCK_SIZE = 28;
 const uint32_t OVERLAP_SIZE = 2;
@@ -70,6 +73,28 @@ BOOST_AUTO_TEST_CASE(UVFDataSource)
         lodNode.getBlockSize() + livre::Vector3ui(info.overlap) * 2;
     BOOST_CHECK(blockSize == info.maximumBlockSize);
 }
+
+BOOST_AUTO_TEST_CASE(UVFZeroCopy)
+{
+    livre::DataSource copied(lunchbox::URI("uvf://" UVF_DATA_FILE));
+    livre::DataSource mapped(
+        lunchbox::URI("uvf://" UVF_DATA_FILE "?zerocopy=1"));
+    const livre::VolumeInformation& info = copied.getVolumeInfo();
+
+    const livre::NodeId nodeId =
+        livre::NodeId(0, livre::Vector3f(0, 0, 0), 0).getChildren().front();
+    const size_t size =
+        (copied.getNode(nodeId).getBlockSize() + info.overlap * 2)
+            .product() *
+        info.getBytesPerVoxel();
+
+    const livre::ConstMemoryUnitPtr copy = copied.getData(nodeId);
+    const livre::ConstMemoryUnitPtr zeroCopy = mapped.getData(nodeId);
+    BOOST_REQUIRE(copy && zeroCopy);
+    BOOST_CHECK_EQUAL(::memcmp(copy->getData<uint8_t>(),
+                               zeroCopy->getData<uint8_t>(), size),
+                      0);
+}
 #else
 BOOST_AUTO_TEST_CASE(UVFDataSource)
 {
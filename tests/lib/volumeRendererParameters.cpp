@@ -20,6 +20,7 @@
 #define BOOST_TEST_MODULE VolumeRendererParameters
 #include <boost/test/unit_test.hpp>
 
+#include <livre/core/cache/CachePolicy.h>
 #include <livre/lib/configuration/VolumeRendererParameters.h>
 
 BOOST_AUTO_TEST_CASE(defaultValues)
@@ -31,6 +32,16 @@ BOOST_AUTO_TEST_CASE(defaultValues)
     BOOST_CHECK(!params.getSynchronousMode());
     BOOST_CHECK_EQUAL(params.getSamplesPerRay(), 0);
     BOOST_CHECK(!params.getShowAxes());
+    BOOST_CHECK_EQUAL(params.getDataCachePolicy(), livre::CP_LRU);
+    BOOST_CHECK_EQUAL(params.getTextureCachePolicy(), livre::CP_LRU);
+    BOOST_CHECK_EQUAL(params.getHistogramCachePolicy(), livre::CP_LRU);
+    BOOST_CHECK(params.getDataSpillDirectoryString().empty());
+    BOOST_CHECK_EQUAL(params.getDataSpillMemory(), 16384u);
+    BOOST_CHECK(!params.getDataCacheCompression());
+    BOOST_CHECK(params.getDataCacheManifestString().empty());
+    BOOST_CHECK(params.getMemoryCgroupString().empty());
+    BOOST_CHECK(!params.getDataHugePages());
+    BOOST_CHECK(!params.getIncrementalVisibles());
 
 #ifdef __i386__
     BOOST_CHECK_EQUAL(params.getScreenSpaceError(), 8.0f);
@@ -74,7 +85,22 @@ BOOST_AUTO_TEST_CASE(initFromArgv)
                           "--max-lod",
                           "6",
                           "--samples-per-ray",
-                          "42"};
+                          "42",
+                          "--data-cache-policy",
+                          "cost",
+                          "--texture-cache-policy",
+                          "arc",
+                          "--data-spill-dir",
+                          "/tmp/livre",
+                          "--data-spill-mem",
+                          "1024",
+                          "--data-cache-compression",
+                          "--data-cache-manifest",
+                          "/tmp/livre.manifest",
+                          "--memory-cgroup",
+                          "auto",
+                          "--data-huge-pages",
+                          "--incremental-visibles"};
     const int argc = sizeof(argv) / sizeof(char*);
 
     livre::VolumeRendererParameters params;
@@ -87,4 +113,15 @@ BOOST_AUTO_TEST_CASE(initFromArgv)
     BOOST_CHECK_EQUAL(params.getScreenSpaceError(), 1.4f);
     BOOST_CHECK_EQUAL(params.getMaxGpuCacheMemory(), 12345u);
     BOOST_CHECK_EQUAL(params.getMaxCpuCacheMemory(), 54321u);
+    BOOST_CHECK_EQUAL(params.getDataCachePolicy(), livre::CP_COST);
+    BOOST_CHECK_EQUAL(params.getTextureCachePolicy(), livre::CP_ARC);
+    BOOST_CHECK_EQUAL(params.getHistogramCachePolicy(), livre::CP_LRU);
+    BOOST_CHECK_EQUAL(params.getDataSpillDirectoryString(), "/tmp/livre");
+    BOOST_CHECK_EQUAL(params.getDataSpillMemory(), 1024u);
+    BOOST_CHECK(params.getDataCacheCompression());
+    BOOST_CHECK_EQUAL(params.getDataCacheManifestString(),
+                      "/tmp/livre.manifest");
+    BOOST_CHECK_EQUAL(params.getMemoryCgroupString(), "auto");
+    BOOST_CHECK(params.getDataHugePages());
+    BOOST_CHECK(params.getIncrementalVisibles());
 }
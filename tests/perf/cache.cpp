@@ -0,0 +1,138 @@
+/* Copyright (c) 2011-2017, EPFL/Blue Brain Project
+ *                          Ahmet Bilgili <ahmet.bilgili@epfl.ch>
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE CachePerf
+
+#include <boost/test/unit_test.hpp>
+
+#include "../core/cache/ValidCacheObject.h"
+
+#include <livre/core/cache/Cache.h>
+#include <livre/core/cache/CachePolicy.h>
+#include <livre/core/cache/CacheStatistics.h>
+
+#include <boost/thread/thread.hpp>
+#include <lunchbox/clock.h>
+
+namespace
+{
+const size_t cacheSizes[] = {10000, 100000, 1000000};
+
+void printRate(const std::string& name, const livre::CachePolicyType policy,
+               const size_t count, const size_t ops, const float timeMs)
+{
+    std::cout << name << " " << livre::getCachePolicyName(policy) << " "
+              << count << " entries: " << ops / timeMs << " ops/ms (" << timeMs
+              << " ms)" << std::endl;
+}
+
+void benchmark(const livre::CachePolicyType policy)
+{
+    for (const size_t count : cacheSizes)
+    {
+        livre::CacheT<test::ValidCacheObject> cache("Perf Cache",
+                                                    count * test::OBJECT_SIZE +
+                                                        1,
+                                                    policy);
+        lunchbox::Clock clock;
+        for (size_t i = 0; i < count; ++i)
+            cache.load<test::ValidCacheObject>(i);
+        printRate("Insert", policy, count, count, clock.resetTimef());
+        BOOST_CHECK_EQUAL(cache.getCount(), count);
+
+        // Touch everything in reverse order
+        for (size_t i = count; i > 0; --i)
+            BOOST_CHECK(cache.get(i - 1));
+        printRate("Hit   ", policy, count, count, clock.resetTimef());
+
+        // Every insert evicts one object
+        for (size_t i = count; i < 2 * count; ++i)
+            cache.load<test::ValidCacheObject>(i);
+        printRate("Evict ", policy, count, count, clock.resetTimef());
+        BOOST_CHECK_EQUAL(cache.getCount(), count);
+    }
+}
+
+const size_t hotSetSize = 4096;
+const size_t lookupsPerThread = 1000000;
+
+void lookup(const livre::Cache& cache, const size_t seed)
+{
+    // Linear congruential ids, so the threads do not share an access pattern
+    size_t id = seed;
+    for (size_t i = 0; i < lookupsPerThread; ++i)
+    {
+        id = id * 6364136223846793005ull + 1442695040888963407ull;
+        if (!cache.get((id >> 33) % hotSetSize))
+            BOOST_FAIL("Object not in cache");
+    }
+}
+}
+
+BOOST_AUTO_TEST_CASE(lruPolicy)
+{
+    benchmark(livre::CP_LRU);
+
+    // Getting 0 after 1 makes 1 the least recently used object, which is
+    // evicted by the load of 2
+    livre::CacheT<test::ValidCacheObject> cache("Perf Cache",
+                                                2 * test::OBJECT_SIZE + 1);
+    cache.load<test::ValidCacheObject>(0);
+    cache.load<test::ValidCacheObject>(1);
+    BOOST_CHECK(cache.get(1));
+    BOOST_CHECK(cache.get(0));
+    cache.load<test::ValidCacheObject>(2);
+    BOOST_CHECK(!cache.get(1));
+}
+
+BOOST_AUTO_TEST_CASE(arcPolicy)
+{
+    benchmark(livre::CP_ARC);
+}
+
+BOOST_AUTO_TEST_CASE(costPolicy)
+{
+    benchmark(livre::CP_COST);
+}
+
+BOOST_AUTO_TEST_CASE(contention)
+{
+    livre::CacheT<test::ValidCacheObject> cache("Perf Cache",
+                                                hotSetSize * test::OBJECT_SIZE +
+                                                    1);
+    for (size_t i = 0; i < hotSetSize; ++i)
+        cache.load<test::ValidCacheObject>(i);
+
+    const size_t maxThreads =
+        std::max(boost::thread::hardware_concurrency(), 1u);
+    for (size_t nThreads = 1; nThreads <= maxThreads; nThreads *= 2)
+    {
+        lunchbox::Clock clock;
+        boost::thread_group threads;
+        for (size_t i = 0; i < nThreads; ++i)
+            threads.create_thread(std::bind(lookup, std::cref(cache), i));
+        threads.join_all();
+
+        const float timeMs = clock.getTimef();
+        std::cout << "Lookup " << nThreads << " threads: "
+                  << nThreads * lookupsPerThread / timeMs << " ops/ms ("
+                  << timeMs << " ms)" << std::endl;
+    }
+    BOOST_CHECK_EQUAL(cache.getCount(), hotSetSize);
+}
@@ -0,0 +1,85 @@
+/* Copyright (c) 2017, EPFL/Blue Brain Project
+ *                     bbp-open-source@googlegroups.com
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE DownsamplePerf
+
+#include <boost/test/unit_test.hpp>
+
+#include <livre/data/Downsample.h>
+
+#include <lunchbox/clock.h>
+
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+const livre::Vector3ui volumeSize(512, 512, 128);
+const size_t repetitions = 5;
+
+const char* getFilterName(const livre::DownsampleFilter filter)
+{
+    switch (filter)
+    {
+    case livre::DF_BOX:
+        return "box ";
+    case livre::DF_MAX:
+        return "max ";
+    case livre::DF_MODE:
+        return "mode";
+    }
+    return "";
+}
+
+void benchmark(const livre::DataType dataType, const char* typeName,
+               const size_t bytesPerVoxel)
+{
+    const size_t inBytes = volumeSize.product() * bytesPerVoxel;
+    std::vector<uint8_t> in(inBytes);
+    for (uint8_t& value : in)
+        value = uint8_t(std::rand() % 4);
+
+    const livre::Vector3ui outSize = livre::getDownsampledSize(volumeSize);
+    std::vector<uint8_t> out(outSize.product() * bytesPerVoxel);
+
+    for (const livre::DownsampleFilter filter :
+         {livre::DF_BOX, livre::DF_MAX, livre::DF_MODE})
+    {
+        lunchbox::Clock clock;
+        for (size_t i = 0; i < repetitions; ++i)
+            livre::downsample(dataType, filter, in.data(), volumeSize,
+                              out.data(), outSize);
+        const float time = clock.getTimef() / repetitions;
+        std::cout << typeName << " " << getFilterName(filter) << ": "
+                  << inBytes / time / 1e6f << " GB/s (" << time << " ms)"
+                  << std::endl;
+    }
+}
+}
+
+BOOST_AUTO_TEST_CASE(downsample)
+{
+    benchmark(livre::DT_UINT8, "uint8 ", 1);
+    benchmark(livre::DT_UINT16, "uint16", 2);
+    benchmark(livre::DT_UINT32, "uint32", 4);
+    benchmark(livre::DT_INT8, "int8  ", 1);
+    benchmark(livre::DT_INT16, "int16 ", 2);
+    benchmark(livre::DT_INT32, "int32 ", 4);
+    benchmark(livre::DT_FLOAT, "float ", 4);
+}
@@ -0,0 +1,145 @@
+/* Copyright (c) 2017, EPFL/Blue Brain Project
+ *                     bbp-open-source@googlegroups.com
+ *
+ * This file is part of Livre <https://github.com/BlueBrain/Livre>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3.0 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define BOOST_TEST_MODULE UVFPerf
+
+#include <boost/test/unit_test.hpp>
+
+#ifdef LIVRE_USE_TUVOK
+
+#include <livre/data/DataSource.h>
+#include <livre/data/LODNode.h>
+#include <livre/data/MemoryUnit.h>
+#include <livre/uvf/UVFDataSource.h>
+
+#include <lunchbox/clock.h>
+#include <lunchbox/pluginRegisterer.h>
+
+#include <atomic>
+#include <map>
+#include <vector>
+
+// Explicit registration required because the folder of the data source plugin
+// is not in the LD_LIBRARY_PATH of the test executable.
+lunchbox::PluginRegisterer<livre::UVFDataSource> registerer;
+
+namespace
+{
+const size_t repetitions = 5;
+
+// The volume given on the command line, or the test volume
+std::string getFilename()
+{
+    const auto& suite = boost::unit_test::framework::master_test_suite();
+    return suite.argc > 1 ? suite.argv[1] : UVF_DATA_FILE;
+}
+
+livre::NodeIds getNodeIds(const livre::DataSource& source)
+{
+    const livre::RootNode& rootNode = source.getVolumeInfo().rootNode;
+    livre::NodeIds nodeIds;
+    for (uint32_t level = 0; level < rootNode.getDepth(); ++level)
+    {
+        const livre::Vector3ui blocks = rootNode.getBlockSize(level);
+        for (uint32_t z = 0; z < blocks.z(); ++z)
+            for (uint32_t y = 0; y < blocks.y(); ++y)
+                for (uint32_t x = 0; x < blocks.x(); ++x)
+                {
+                    const livre::NodeId nodeId(level,
+                                               livre::Vector3ui(x, y, z));
+                    if (source.getNode(nodeId).isValid())
+                        nodeIds.push_back(nodeId);
+                }
+    }
+    return nodeIds;
+}
+
+// Reads all bytes of a brick, as the texture upload does
+uint64_t consume(const livre::MemoryUnit& data, const size_t size)
+{
+    const uint8_t* ptr = data.getData<uint8_t>();
+    uint64_t sum = 0;
+    for (size_t i = 0; i < size; ++i)
+        sum += ptr[i];
+    return sum;
+}
+
+uint64_t benchmark(const std::string& name, const std::string& query)
+{
+    const std::string uri = "uvf://" + getFilename() + query;
+    livre::DataSource source((servus::URI(uri)));
+    const livre::VolumeInformation& info = source.getVolumeInfo();
+    const livre::NodeIds nodeIds = getNodeIds(source);
+
+    std::vector<size_t> sizes;
+    size_t bytes = 0;
+    for (const livre::NodeId& nodeId : nodeIds)
+    {
+        const livre::Vector3ui size =
+            source.getNode(nodeId).getBlockSize() + info.overlap * 2;
+        sizes.push_back(size.product() * info.compCount *
+                        info.getBytesPerVoxel());
+        bytes += sizes.back();
+    }
+
+    uint64_t checksum = 0;
+    lunchbox::Clock clock;
+    for (size_t i = 0; i < repetitions; ++i)
+    {
+        checksum = 0;
+        for (size_t j = 0; j < nodeIds.size(); ++j)
+            checksum += consume(*source.getData(nodeIds[j]), sizes[j]);
+    }
+    float time = clock.resetTimef() / repetitions;
+    std::cout << name << " sync:  " << bytes / time / 1000.f << " MB/s ("
+              << time << " ms)" << std::endl;
+
+    std::map<livre::NodeId, size_t> indices;
+    for (size_t j = 0; j < nodeIds.size(); ++j)
+        indices[nodeIds[j]] = j;
+
+    clock.reset();
+    for (size_t i = 0; i < repetitions; ++i)
+    {
+        std::atomic<uint64_t> sum(0);
+        const auto callback = [&](const livre::NodeId& nodeId,
+                                  livre::MemoryUnitPtr data) {
+            sum += consume(*data, sizes[indices.at(nodeId)]);
+        };
+        source.getDataAsync(nodeIds, callback).get();
+        BOOST_CHECK_EQUAL(sum, checksum);
+    }
+    time = clock.resetTimef() / repetitions;
+    std::cout << name << " async: " << bytes / time / 1000.f << " MB/s ("
+              << time << " ms)" << std::endl;
+    return checksum;
+}
+}
+
+BOOST_AUTO_TEST_CASE(zeroCopy)
+{
+    std::cout << getFilename() << std::endl;
+    const uint64_t copied = benchmark("copy     ", "");
+    BOOST_CHECK_EQUAL(benchmark("zero copy", "?zerocopy=1"), copied);
+}
+#else
+BOOST_AUTO_TEST_CASE(zeroCopy)
+{
+}
+#endif // LIVRE_USE_TUVOK